@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+
 #include <cubeb/cubeb.h>
 
 #include "AudioCommon/CubebStream.h"
@@ -10,16 +13,30 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 
 // ~10 ms - needs to be at least 240 for surround
 constexpr u32 BUFFER_SAMPLES = 512;
+// Limits for the low latency mode
+constexpr u32 LOW_LATENCY_MIN_SAMPLES = 128;
+constexpr u32 LOW_LATENCY_MAX_SAMPLES = 4096;
+// Recreating the stream is audible, so it is not done more often than this
+constexpr u64 RESTART_PERIOD_US = 1000000;
+constexpr auto CONTROL_PERIOD = std::chrono::milliseconds(100);
 
 long CubebStream::DataCallback(cubeb_stream* stream, void* user_data, const void* /*input_buffer*/,
                                void* output_buffer, long num_frames)
 {
   auto* self = static_cast<CubebStream*>(user_data);
 
+  if (self->m_latency_controller)
+  {
+    self->m_latency_controller->OnCallback(static_cast<u32>(num_frames),
+                                           self->m_mixer->GetStatistics().underruns);
+    self->m_mixer->SetLowWatermark(self->m_latency_controller->GetLowWatermarkMs());
+  }
+
   if (self->m_stereo)
     self->m_mixer->Mix(static_cast<short*>(output_buffer), num_frames);
   else
@@ -40,33 +57,61 @@ bool CubebStream::Start()
 
   m_stereo = !SConfig::GetInstance().bDPL2Decoder;
 
-  cubeb_stream_params params;
-  params.rate = m_mixer->GetSampleRate();
+  m_params.rate = m_mixer->GetSampleRate();
   if (m_stereo)
   {
-    params.channels = 2;
-    params.format = CUBEB_SAMPLE_S16NE;
-    params.layout = CUBEB_LAYOUT_STEREO;
+    m_params.channels = 2;
+    m_params.format = CUBEB_SAMPLE_S16NE;
+    m_params.layout = CUBEB_LAYOUT_STEREO;
   }
   else
   {
-    params.channels = 6;
-    params.format = CUBEB_SAMPLE_FLOAT32NE;
-    params.layout = CUBEB_LAYOUT_3F2_LFE;
+    m_params.channels = 6;
+    m_params.format = CUBEB_SAMPLE_FLOAT32NE;
+    m_params.layout = CUBEB_LAYOUT_3F2_LFE;
   }
 
   u32 minimum_latency = 0;
-  if (cubeb_get_min_latency(m_ctx.get(), params, &minimum_latency) != CUBEB_OK)
+  if (cubeb_get_min_latency(m_ctx.get(), m_params, &minimum_latency) != CUBEB_OK)
     ERROR_LOG(AUDIO, "Error getting minimum latency");
   INFO_LOG(AUDIO, "Minimum latency: %i frames", minimum_latency);
 
+  u32 buffer_frames = std::max(BUFFER_SAMPLES, minimum_latency);
+  if (SConfig::GetInstance().m_audio_low_latency)
+  {
+    // Surround needs at least 240 samples per callback.
+    const u32 min_frames =
+        std::max({LOW_LATENCY_MIN_SAMPLES, minimum_latency, m_stereo ? 0u : 256u});
+    m_latency_controller = std::make_unique<AudioCommon::LatencyController>(
+        m_params.rate, min_frames, LOW_LATENCY_MAX_SAMPLES,
+        SConfig::GetInstance().iTimingVariance);
+    buffer_frames = m_latency_controller->GetTargetFrames();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_stream_mutex);
+    if (!CreateStream(buffer_frames))
+      return false;
+  }
+
+  m_run_control_thread.Set();
+  m_control_thread = std::thread(&CubebStream::ControlThread, this);
+  return true;
+}
+
+bool CubebStream::CreateStream(u32 buffer_frames)
+{
   if (cubeb_stream_init(m_ctx.get(), &m_stream, "Dolphin Audio Output", nullptr, nullptr, nullptr,
-                        &params, std::max(BUFFER_SAMPLES, minimum_latency), DataCallback,
-                        StateCallback, this) != CUBEB_OK)
+                        &m_params, buffer_frames, DataCallback, StateCallback,
+                        this) != CUBEB_OK)
   {
     ERROR_LOG(AUDIO, "Error initializing cubeb stream");
+    m_stream = nullptr;
     return false;
   }
+  m_buffer_frames = buffer_frames;
+  m_last_restart_us = Common::Timer::GetTimeUs();
+  cubeb_stream_set_volume(m_stream, m_volume / 100.0f);
 
   if (cubeb_stream_start(m_stream) != CUBEB_OK)
   {
@@ -76,17 +121,78 @@ bool CubebStream::Start()
   return true;
 }
 
-void CubebStream::Stop()
+void CubebStream::DestroyStream()
 {
+  if (!m_stream)
+    return;
+
   if (cubeb_stream_stop(m_stream) != CUBEB_OK)
   {
     ERROR_LOG(AUDIO, "Error stopping cubeb stream");
   }
   cubeb_stream_destroy(m_stream);
+  m_stream = nullptr;
+}
+
+void CubebStream::Stop()
+{
+  if (m_control_thread.joinable())
+  {
+    m_run_control_thread.Clear();
+    m_control_event.Set();
+    m_control_thread.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_stream_mutex);
+    DestroyStream();
+  }
+  m_latency_controller.reset();
+  m_mixer->SetLowWatermark(0);
+  m_mixer->SetBackendLatency(0);
   m_ctx.reset();
 }
 
+// Recreating the stream blocks until the backend has stopped and restarted its output, which
+// would stall the emulation if it was done from the thread pushing the samples.
+void CubebStream::ControlThread()
+{
+  Common::SetCurrentThreadName("Cubeb control");
+
+  while (m_run_control_thread.IsSet())
+  {
+    m_control_event.WaitFor(CONTROL_PERIOD);
+
+    std::lock_guard<std::mutex> lk(m_stream_mutex);
+    if (!m_stream || !m_run_control_thread.IsSet())
+      continue;
+
+    u32 latency_frames;
+    if (cubeb_stream_get_latency(m_stream, &latency_frames) == CUBEB_OK)
+    {
+      m_mixer->SetBackendLatency(
+          static_cast<u32>(static_cast<u64>(latency_frames) * 1000000 / m_params.rate));
+    }
+
+    if (!m_latency_controller)
+      continue;
+
+    const u32 buffer_frames = m_latency_controller->GetTargetFrames();
+    if (buffer_frames != m_buffer_frames &&
+        Common::Timer::GetTimeUs() - m_last_restart_us >= RESTART_PERIOD_US)
+    {
+      INFO_LOG(AUDIO, "Recreating cubeb stream with %u frames", buffer_frames);
+      DestroyStream();
+      m_latency_controller->OnRestart();
+      CreateStream(buffer_frames);
+    }
+  }
+}
+
 void CubebStream::SetVolume(int volume)
 {
-  cubeb_stream_set_volume(m_stream, volume / 100.0f);
+  std::lock_guard<std::mutex> lk(m_stream_mutex);
+  m_volume = volume;
+  if (m_stream)
+    cubeb_stream_set_volume(m_stream, volume / 100.0f);
 }
@@ -6,9 +6,14 @@
 
 #include <cstddef>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "AudioCommon/LatencyController.h"
 #include "AudioCommon/SoundStream.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
 
 #include <cubeb/cubeb.h>
 
@@ -20,9 +25,29 @@ public:
   void SetVolume(int) override;
 
 private:
+  // Both need m_stream_mutex to be held.
+  bool CreateStream(u32 buffer_frames);
+  void DestroyStream();
+
+  // Queries the backend latency and recreates the stream when the latency controller asks for a
+  // different size.
+  void ControlThread();
+
   bool m_stereo = false;
   std::shared_ptr<cubeb> m_ctx;
+  // The control thread recreates the stream, while SetVolume() is called from the UI thread.
+  std::mutex m_stream_mutex;
   cubeb_stream* m_stream = nullptr;
+  cubeb_stream_params m_params;
+  int m_volume = 100;
+
+  // Only used in the low latency mode. A cubeb stream can't be resized, so it is recreated.
+  std::unique_ptr<AudioCommon::LatencyController> m_latency_controller;
+  u32 m_buffer_frames = 0;
+  u64 m_last_restart_us = 0;
+  std::thread m_control_thread;
+  Common::Flag m_run_control_thread;
+  Common::Event m_control_event;
 
   std::vector<short> m_short_buffer;
   std::vector<float> m_floatstereo_buffer;
@@ -0,0 +1,118 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+
+#include "AudioCommon/LatencyController.h"
+#include "Common/Logging/Log.h"
+#include "Common/Timer.h"
+
+namespace AudioCommon
+{
+// Shrinking only happens after this long without any underrun or growth.
+constexpr u64 STABLE_PERIOD_US = 5000000;
+// Growing because of jitter happens at most this often.
+constexpr u64 JITTER_GROW_PERIOD_US = 1000000;
+constexpr u32 MIN_WATERMARK_MS = 5;
+constexpr u32 WATERMARK_STEP_MS = 5;
+
+LatencyController::LatencyController(u32 sample_rate, u32 min_frames, u32 max_frames,
+                                     u32 max_watermark_ms)
+    : m_sample_rate(sample_rate), m_min_frames(min_frames),
+      m_max_frames(std::max(min_frames, max_frames)),
+      m_max_watermark_ms(std::max(MIN_WATERMARK_MS, max_watermark_ms)),
+      m_target_frames(min_frames),
+      m_low_watermark_ms(std::max(MIN_WATERMARK_MS, std::min(max_watermark_ms, 20u)))
+{
+}
+
+u64 LatencyController::FramesToUs(u32 frames) const
+{
+  return static_cast<u64>(frames) * 1000000 / m_sample_rate;
+}
+
+void LatencyController::Grow(u64 now)
+{
+  const u32 target = m_target_frames.load();
+  const u32 new_target = std::min(m_max_frames, target + target / 2);
+  if (new_target != target)
+  {
+    m_target_frames.store(new_target);
+    INFO_LOG(AUDIO, "Audio buffer grown to %u frames", new_target);
+  }
+  m_last_change_us = now;
+}
+
+void LatencyController::GrowAfterUnderrun(u64 now)
+{
+  m_underrun_frames = std::max(m_underrun_frames, m_target_frames.load());
+  Grow(now);
+}
+
+void LatencyController::OnUnderrun()
+{
+  m_underrun_pending = true;
+}
+
+void LatencyController::OnCallback(u32 num_frames, u64 mixer_underruns)
+{
+  const u64 now = Common::Timer::GetTimeUs();
+  const u64 buffer_us = FramesToUs(m_target_frames.load());
+
+  if (m_last_callback_us != 0)
+  {
+    const u64 interval = now - m_last_callback_us;
+    const u64 expected = FramesToUs(num_frames);
+    const float deviation = std::abs(static_cast<float>(interval) - static_cast<float>(expected));
+    m_jitter_us = m_jitter_us * 0.95f + deviation * 0.05f;
+
+    // If the callback came later than the whole buffer lasts, the device has run dry.
+    if (interval > expected + buffer_us)
+      m_underrun_pending = true;
+  }
+  else
+  {
+    m_last_change_us = now;
+  }
+  m_last_callback_us = now;
+
+  if (m_underrun_pending)
+  {
+    m_underrun_pending = false;
+    GrowAfterUnderrun(now);
+  }
+  else if (m_jitter_us > buffer_us / 2 && now - m_last_change_us >= JITTER_GROW_PERIOD_US)
+  {
+    Grow(now);
+  }
+
+  // The emulated DSP not keeping up is handled by keeping more samples in the mixer instead.
+  if (mixer_underruns != m_last_mixer_underruns)
+  {
+    m_last_mixer_underruns = mixer_underruns;
+    const u32 watermark_ms = m_low_watermark_ms.load();
+    m_underrun_watermark_ms = std::max(m_underrun_watermark_ms, watermark_ms);
+    m_low_watermark_ms.store(std::min(m_max_watermark_ms, watermark_ms + WATERMARK_STEP_MS));
+    m_last_change_us = now;
+  }
+
+  if (now - m_last_change_us >= STABLE_PERIOD_US)
+  {
+    if (m_jitter_us < buffer_us / 4)
+    {
+      const u32 target = m_target_frames.load();
+      const u32 min_frames = std::max(m_min_frames, m_underrun_frames + 1);
+      if (target > min_frames)
+        m_target_frames.store(std::max(min_frames, target - target / 8));
+    }
+    const u32 watermark_ms = m_low_watermark_ms.load();
+    const u32 min_watermark_ms = std::max(MIN_WATERMARK_MS, m_underrun_watermark_ms + 1);
+    if (watermark_ms > min_watermark_ms)
+      m_low_watermark_ms.store(watermark_ms - 1);
+    m_last_change_us = now;
+  }
+}
+
+}  // AudioCommon
@@ -0,0 +1,56 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+
+namespace AudioCommon
+{
+// Sizes a backend's buffer and the mixer's low watermark at runtime for the low latency mode.
+// Underruns grow them right away. Once the output has gone a while without underruns and with
+// little callback jitter, they are shrunk again, but never back to a size that already ran dry.
+class LatencyController
+{
+public:
+  LatencyController(u32 sample_rate, u32 min_frames, u32 max_frames, u32 max_watermark_ms);
+
+  // Called from the audio thread each time the backend asks for samples.
+  void OnCallback(u32 num_frames, u64 mixer_underruns);
+  // Called from the audio thread when the backend reports that its buffer ran dry.
+  void OnUnderrun();
+  // Called while no callbacks happen, when the backend has stopped its output to resize it.
+  void OnRestart() { m_last_callback_us = 0; }
+
+  // The buffer size the backend should use, in frames.
+  u32 GetTargetFrames() const { return m_target_frames.load(); }
+  u32 GetLowWatermarkMs() const { return m_low_watermark_ms.load(); }
+
+private:
+  void Grow(u64 now);
+  void GrowAfterUnderrun(u64 now);
+  u64 FramesToUs(u32 frames) const;
+
+  u32 m_sample_rate;
+  u32 m_min_frames;
+  u32 m_max_frames;
+  u32 m_max_watermark_ms;
+
+  std::atomic<u32> m_target_frames;
+  std::atomic<u32> m_low_watermark_ms;
+
+  u64 m_last_callback_us = 0;
+  u64 m_last_change_us = 0;
+  u64 m_last_mixer_underruns = 0;
+  // The largest sizes that ran dry so far. Shrinking stops above them.
+  u32 m_underrun_frames = 0;
+  u32 m_underrun_watermark_ms = 0;
+  bool m_underrun_pending = false;
+  // Moving average of how far the callback interval is off from the duration it asked for.
+  float m_jitter_us = 0.0f;
+};
+
+}  // AudioCommon
@@ -4,15 +4,19 @@
 
 #include "AudioCommon/Mixer.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 
 #include "AudioCommon/DPL2Decoder.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "VideoCommon/VR.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -27,12 +31,244 @@ CMixer::~CMixer()
 {
 }
 
+// A FIFO counts as fed while samples were pushed this recently. DMA pushes come every few ms.
+constexpr u64 PUSH_TIMEOUT_US = 100000;
+
+// The windowed sinc resampler looks at SINC_TAPS input samples around each output sample, the
+// first SINC_TAPS / 2 - 1 of them before the read index.
+constexpr u32 SINC_TAPS = 16;
+constexpr u32 SINC_HISTORY = SINC_TAPS / 2 - 1;
+constexpr u32 SINC_PHASES = 256;
+// When downsampling, the cutoff follows the output's Nyquist frequency in this many steps, each
+// with its own table.
+constexpr u32 SINC_CUTOFF_STEPS = 32;
+
+// Blackman windowed sinc, one set of taps per fractional position. Each tap is stored twice, for
+// the left and right channel. cutoff is relative to the input's Nyquist frequency.
+static std::vector<float> BuildSincTable(double cutoff)
+{
+  constexpr double PI = 3.14159265358979323846;
+
+  std::vector<float> t(SINC_PHASES * SINC_TAPS * 2);
+  for (u32 phase = 0; phase < SINC_PHASES; ++phase)
+  {
+    std::array<double, SINC_TAPS> taps;
+    double sum = 0.0;
+    for (u32 i = 0; i < SINC_TAPS; ++i)
+    {
+      const double x =
+          static_cast<double>(i) - SINC_HISTORY - static_cast<double>(phase) / SINC_PHASES;
+      const double sinc = x == 0.0 ? 1.0 : std::sin(PI * cutoff * x) / (PI * cutoff * x);
+      const double w = 2.0 * PI * (x + SINC_TAPS / 2) / SINC_TAPS;
+      taps[i] = sinc * (0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w));
+      sum += taps[i];
+    }
+
+    // Normalize so that a constant signal keeps its level at every phase.
+    for (u32 i = 0; i < SINC_TAPS; ++i)
+    {
+      t[(phase * SINC_TAPS + i) * 2] = static_cast<float>(taps[i] / sum);
+      t[(phase * SINC_TAPS + i) * 2 + 1] = static_cast<float>(taps[i] / sum);
+    }
+  }
+  return t;
+}
+
+const std::vector<float>& CMixer::MixerFifo::GetSincTable(u32 ratio)
+{
+  // A slightly lower cutoff than the Nyquist frequency keeps the transition band from folding
+  // back. When the input rate is higher than the output rate, that is the output's frequency.
+  constexpr double CUTOFF = 0.95;
+  u32 step = SINC_CUTOFF_STEPS;
+  if (ratio > 0x10000)
+    step = std::max<u32>(1, static_cast<u32>(u64{SINC_CUTOFF_STEPS} * 0x10000 / ratio));
+
+  if (m_sinc_tables.empty())
+    m_sinc_tables.resize(SINC_CUTOFF_STEPS + 1);
+  std::vector<float>& table = m_sinc_tables[step];
+  if (table.empty())
+    table = BuildSincTable(CUTOFF * step / SINC_CUTOFF_STEPS);
+  return table;
+}
+
+// Byteswaps count big endian samples from src to dst.
+static void CopySwapped(short* dst, const short* src, size_t count)
+{
+  size_t i = 0;
+#ifdef _M_X86
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+#endif
+  for (; i < count; ++i)
+    dst[i] = Common::swap16(src[i]);
+}
+
+unsigned int CMixer::MixerFifo::ResampleLinear(short* samples, unsigned int num_samples,
+                                               u32& index_r, u32 index_w, u32 ratio, s32 lvolume,
+                                               s32 rvolume)
+{
+  unsigned int currentSample = 0;
+  u32 indexR = index_r;
+
+#ifdef _M_X86
+  // Two output frames at a time, one 32-bit lane per channel in L, R, L, R order.
+  // ((l1 << 16) + (l2 - l1) * frac) >> 16 is computed exactly with pmaddwd by splitting frac into
+  // frac / 2, which fits a signed 16-bit weight, and its lowest bit.
+  const __m128i volume = _mm_set_epi32(rvolume, lvolume, rvolume, lvolume);
+  const __m128i difference = _mm_set1_epi32(0xffff0001);
+  const __m128i high_half = _mm_set1_epi32(0xffff0000);
+  const __m128i min_sample = _mm_set1_epi16(-32767);
+  while (currentSample + 4 <= num_samples * 2 && ((index_w - indexR) & INDEX_MASK) > 2)
+  {
+    const u32 frac0 = m_frac;
+    const u32 indexR0 = indexR;
+    u32 frac1 = frac0 + ratio;
+    const u32 indexR1 = indexR0 + 2 * (u16)(frac1 >> 16);
+    frac1 &= 0xffff;
+    if (((index_w - indexR1) & INDEX_MASK) <= 2)
+      break;
+
+    u32 cur0, next0, cur1, next1;
+    std::memcpy(&cur0, &m_buffer[indexR0 & INDEX_MASK], sizeof(u32));
+    std::memcpy(&next0, &m_buffer[(indexR0 + 2) & INDEX_MASK], sizeof(u32));
+    std::memcpy(&cur1, &m_buffer[indexR1 & INDEX_MASK], sizeof(u32));
+    std::memcpy(&next1, &m_buffer[(indexR1 + 2) & INDEX_MASK], sizeof(u32));
+
+    // (next, current) pairs for each lane, the current sample in the high half.
+    const __m128i pairs =
+        _mm_unpacklo_epi16(_mm_set_epi32(0, 0, next1, next0), _mm_set_epi32(0, 0, cur1, cur0));
+    const u32 weight0 = (frac0 >> 1) | ((0u - (frac0 >> 1)) << 16);
+    const u32 weight1 = (frac1 >> 1) | ((0u - (frac1 >> 1)) << 16);
+    const __m128i half_products =
+        _mm_madd_epi16(pairs, _mm_set_epi32(weight1, weight1, weight0, weight0));
+    const __m128i odd = _mm_set_epi32(0u - (frac1 & 1), 0u - (frac1 & 1), 0u - (frac0 & 1),
+                                      0u - (frac0 & 1));
+    __m128i sum = _mm_and_si128(pairs, high_half);
+    sum = _mm_add_epi32(sum, _mm_add_epi32(half_products, half_products));
+    sum = _mm_add_epi32(sum, _mm_and_si128(_mm_madd_epi16(pairs, difference), odd));
+    const __m128i interpolated = _mm_srai_epi32(sum, 16);
+
+    // The output is in R, L order.
+    __m128i scaled = _mm_srai_epi32(_mm_madd_epi16(interpolated, volume), 8);
+    scaled = _mm_shuffle_epi32(scaled, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i out = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&samples[currentSample]));
+    out = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(out, out), 16), scaled);
+    out = _mm_max_epi16(_mm_packs_epi32(out, out), min_sample);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&samples[currentSample]), out);
+
+    frac1 += ratio;
+    indexR = indexR1 + 2 * (u16)(frac1 >> 16);
+    m_frac = frac1 & 0xffff;
+    currentSample += 4;
+  }
+#endif
+
+  for (; currentSample < num_samples * 2 && ((index_w - indexR) & INDEX_MASK) > 2;
+       currentSample += 2)
+  {
+    u32 indexR2 = indexR + 2;  // next sample
+
+    s16 l1 = m_buffer[indexR & INDEX_MASK];   // current
+    s16 l2 = m_buffer[indexR2 & INDEX_MASK];  // next
+    int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac) >> 16;
+    sampleL = (sampleL * lvolume) >> 8;
+    sampleL += samples[currentSample + 1];
+    samples[currentSample + 1] = MathUtil::Clamp(sampleL, -32767, 32767);
+
+    s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK];   // current
+    s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK];  // next
+    int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac) >> 16;
+    sampleR = (sampleR * rvolume) >> 8;
+    sampleR += samples[currentSample];
+    samples[currentSample] = MathUtil::Clamp(sampleR, -32767, 32767);
+
+    m_frac += ratio;
+    indexR += 2 * (u16)(m_frac >> 16);
+    m_frac &= 0xffff;
+  }
+
+  index_r = indexR;
+  return currentSample;
+}
+
+unsigned int CMixer::MixerFifo::ResampleSinc(short* samples, unsigned int num_samples,
+                                             u32& index_r, u32 index_w, u32 ratio, s32 lvolume,
+                                             s32 rvolume)
+{
+  const std::vector<float>& table = GetSincTable(ratio);
+  unsigned int currentSample = 0;
+  u32 indexR = index_r;
+
+  // The taps after the read index have to be in the FIFO already.
+  for (; currentSample < num_samples * 2 &&
+         ((index_w - indexR) & INDEX_MASK) > 2 * (SINC_TAPS - SINC_HISTORY);
+       currentSample += 2)
+  {
+    const float* coefs = &table[(m_frac >> 8) * SINC_TAPS * 2];
+    const u32 first = (indexR - 2 * SINC_HISTORY) & INDEX_MASK;
+
+    // Copy the taps out if they wrap around the end of the buffer.
+    alignas(16) std::array<short, SINC_TAPS * 2> wrapped;
+    const short* taps = &m_buffer[first];
+    if (first + SINC_TAPS * 2 > m_buffer.size())
+    {
+      for (u32 i = 0; i < SINC_TAPS * 2; ++i)
+        wrapped[i] = m_buffer[(first + i) & INDEX_MASK];
+      taps = wrapped.data();
+    }
+
+    float left, right;
+#ifdef _M_X86
+    __m128 acc = _mm_setzero_ps();
+    for (u32 i = 0; i < SINC_TAPS * 2; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps + i));
+      const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+      const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+      acc = _mm_add_ps(acc, _mm_mul_ps(lo, _mm_loadu_ps(coefs + i)));
+      acc = _mm_add_ps(acc, _mm_mul_ps(hi, _mm_loadu_ps(coefs + i + 4)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    left = _mm_cvtss_f32(acc);
+    right = _mm_cvtss_f32(_mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+#else
+    left = 0.0f;
+    right = 0.0f;
+    for (u32 i = 0; i < SINC_TAPS * 2; i += 2)
+    {
+      left += taps[i] * coefs[i];
+      right += taps[i + 1] * coefs[i + 1];
+    }
+#endif
+
+    // The filter overshoots on steep edges.
+    int sampleL = static_cast<int>(std::lround(MathUtil::Clamp(left, -32768.0f, 32767.0f)));
+    sampleL = (sampleL * lvolume) >> 8;
+    sampleL += samples[currentSample + 1];
+    samples[currentSample + 1] = MathUtil::Clamp(sampleL, -32767, 32767);
+
+    int sampleR = static_cast<int>(std::lround(MathUtil::Clamp(right, -32768.0f, 32767.0f)));
+    sampleR = (sampleR * rvolume) >> 8;
+    sampleR += samples[currentSample];
+    samples[currentSample] = MathUtil::Clamp(sampleR, -32767, 32767);
+
+    m_frac += ratio;
+    indexR += 2 * (u16)(m_frac >> 16);
+    m_frac &= 0xffff;
+  }
+
+  index_r = indexR;
+  return currentSample;
+}
+
 // Executed from sound stream thread
 unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
                                     bool consider_framelimit)
 {
-  unsigned int currentSample = 0;
-
   // Cache access in non-volatile variable
   // This is the only function changing the read value, so it's safe to
   // cache it locally although it's written here.
@@ -53,7 +289,10 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
   {
     float numLeft = static_cast<float>(((indexW - indexR) & INDEX_MASK) / 2);
 
-    u32 low_waterwark = m_input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
+    u32 low_watermark_ms = m_mixer->m_low_watermark_ms.load();
+    if (low_watermark_ms == 0)
+      low_watermark_ms = SConfig::GetInstance().iTimingVariance;
+    u32 low_waterwark = m_input_sample_rate * low_watermark_ms / 1000;
     low_waterwark = std::min(low_waterwark, MAX_SAMPLES / 2);
 
     m_numLeftI = (numLeft + m_numLeftI * (CONTROL_AVG - 1)) / CONTROL_AVG;
@@ -83,37 +322,24 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
   s32 lvolume = m_LVolume.load();
   s32 rvolume = m_RVolume.load();
 
-  // TODO: consider a higher-quality resampling algorithm.
-  for (; currentSample < numSamples * 2 && ((indexW - indexR) & INDEX_MASK) > 2; currentSample += 2)
-  {
-    u32 indexR2 = indexR + 2;  // next sample
-
-    s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]);   // current
-    s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]);  // next
-    int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac) >> 16;
-    sampleL = (sampleL * lvolume) >> 8;
-    sampleL += samples[currentSample + 1];
-    samples[currentSample + 1] = MathUtil::Clamp(sampleL, -32767, 32767);
-
-    s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]);   // current
-    s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]);  // next
-    int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac) >> 16;
-    sampleR = (sampleR * rvolume) >> 8;
-    sampleR += samples[currentSample];
-    samples[currentSample] = MathUtil::Clamp(sampleR, -32767, 32767);
-
-    m_frac += ratio;
-    indexR += 2 * (u16)(m_frac >> 16);
-    m_frac &= 0xffff;
-  }
+  unsigned int currentSample;
+  if (SConfig::GetInstance().m_audio_resampler == RESAMPLER_SINC)
+    currentSample = ResampleSinc(samples, numSamples, indexR, indexW, ratio, lvolume, rvolume);
+  else
+    currentSample = ResampleLinear(samples, numSamples, indexR, indexW, ratio, lvolume, rvolume);
 
   // Actual number of samples written to the buffer without padding.
   unsigned int actual_sample_count = currentSample / 2;
+  if (actual_sample_count < numSamples && Core::GetState() == Core::State::Running &&
+      Common::Timer::GetTimeUs() - m_last_push_us.load() < PUSH_TIMEOUT_US)
+  {
+    m_underruns.fetch_add(1);
+  }
 
   // Padding
   short s[2];
-  s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-  s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
+  s[0] = m_buffer[(indexR - 1) & INDEX_MASK];
+  s[1] = m_buffer[(indexR - 2) & INDEX_MASK];
   s[0] = (s[0] * rvolume) >> 8;
   s[1] = (s[1] * lvolume) >> 8;
   for (; currentSample < numSamples * 2; currentSample += 2)
@@ -136,6 +362,8 @@ unsigned int CMixer::Mix(short* samples, unsigned int num_samples)
   if (!samples)
     return 0;
 
+  const u64 start_time = Common::Timer::GetTimeUs();
+
   memset(samples, 0, num_samples * 2 * sizeof(short));
 
   if (SConfig::GetInstance().m_audio_stretch)
@@ -165,9 +393,27 @@ unsigned int CMixer::Mix(short* samples, unsigned int num_samples)
     m_is_stretching = false;
   }
 
+  m_mix_time_us.fetch_add(Common::Timer::GetTimeUs() - start_time);
   return num_samples;
 }
 
+CMixer::Statistics CMixer::GetStatistics() const
+{
+  const u32 fifo_latency_us =
+      static_cast<u32>(static_cast<u64>(m_dma_mixer.AvailableSamples()) * 1000000 / m_sampleRate);
+  return {m_mix_time_us.load(), m_dma_mixer.GetUnderruns(),
+          fifo_latency_us + m_backend_latency_us.load()};
+}
+
+CMixer::Statistics CMixer::GetStatisticsDelta()
+{
+  const Statistics stats = GetStatistics();
+  const Statistics delta = {stats.mix_time_us - m_last_statistics.mix_time_us,
+                            stats.underruns - m_last_statistics.underruns, stats.latency_us};
+  m_last_statistics = stats;
+  return delta;
+}
+
 unsigned int CMixer::MixSurround(float* samples, unsigned int num_samples)
 {
   if (!num_samples)
@@ -197,25 +443,21 @@ void CMixer::MixerFifo::PushSamples(const short* samples, unsigned int num_sampl
   u32 indexW = m_indexW.load();
 
   // Check if we have enough free space
-  // indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-  if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
+  // indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW.
+  // The sinc resampler still reads a few samples before indexR, those must not be overwritten.
+  if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >=
+      (MAX_SAMPLES - SINC_HISTORY) * 2)
     return;
 
   // AyuanX: Actual re-sampling work has been moved to sound thread
   // to alleviate the workload on main thread
-  // and we simply store raw data here to make fast mem copy
-  int over_bytes = num_samples * 4 - (MAX_SAMPLES * 2 - (indexW & INDEX_MASK)) * sizeof(short);
-  if (over_bytes > 0)
-  {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4 - over_bytes);
-    memcpy(&m_buffer[0], samples + (num_samples * 4 - over_bytes) / sizeof(short), over_bytes);
-  }
-  else
-  {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
-  }
+  // and we simply store raw data here, byteswapped to host order
+  const u32 first = std::min(num_samples * 2, MAX_SAMPLES * 2 - (indexW & INDEX_MASK));
+  CopySwapped(&m_buffer[indexW & INDEX_MASK], samples, first);
+  CopySwapped(&m_buffer[0], samples + first, num_samples * 2 - first);
 
   m_indexW.fetch_add(num_samples * 2);
+  m_last_push_us.store(Common::Timer::GetTimeUs());
 }
 
 void CMixer::PushSamples(const short* samples, unsigned int num_samples)
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <atomic>
+#include <vector>
 
 #include "AudioCommon/AudioStretcher.h"
 #include "AudioCommon/WaveFile.h"
@@ -14,6 +15,20 @@
 class CMixer final
 {
 public:
+  // Selected by SConfig::m_audio_resampler.
+  enum Resampler
+  {
+    RESAMPLER_LINEAR,
+    RESAMPLER_SINC,
+  };
+
+  struct Statistics
+  {
+    u64 mix_time_us;  // Time spent in Mix() by the audio thread
+    u64 underruns;    // Mix() calls which ran out of DMA samples while the DMA was running
+    u32 latency_us;   // DMA samples waiting in the mixer plus the backend's latency
+  };
+
   explicit CMixer(unsigned int BackendSampleRate);
   ~CMixer();
 
@@ -40,6 +55,15 @@ public:
 
   float GetCurrentSpeed() const { return m_speed.load(); }
   void UpdateSpeed(float val) { m_speed.store(val); }
+  Statistics GetStatistics() const;
+  // Like GetStatistics(), but with the mix time and underruns since the previous call.
+  Statistics GetStatisticsDelta();
+
+  // Called from the backends.
+  // Overrides the iTimingVariance low watermark of the FIFOs, 0 restores it.
+  void SetLowWatermark(u32 ms) { m_low_watermark_ms.store(ms); }
+  void SetBackendLatency(u32 us) { m_backend_latency_us.store(us); }
+
 private:
 #if defined(_MSC_VER) && _MSC_VER <= 1800
 #define MAX_SAMPLES ((u32)(1024 * 4))  // 128 ms
@@ -68,18 +92,35 @@ private:
     unsigned int GetInputSampleRate() const;
     void SetVolume(unsigned int lvolume, unsigned int rvolume);
     unsigned int AvailableSamples() const;
+    u64 GetUnderruns() const { return m_underruns.load(); }
 
   private:
+    // Both resample from m_buffer starting at index_r, add the result to samples and return the
+    // number of shorts written.
+    unsigned int ResampleLinear(short* samples, unsigned int num_samples, u32& index_r,
+                                u32 index_w, u32 ratio, s32 lvolume, s32 rvolume);
+    unsigned int ResampleSinc(short* samples, unsigned int num_samples, u32& index_r, u32 index_w,
+                              u32 ratio, s32 lvolume, s32 rvolume);
+    // Built on first use for each cutoff, on the audio thread.
+    const std::vector<float>& GetSincTable(u32 ratio);
+
     CMixer* m_mixer;
     unsigned m_input_sample_rate;
+    // Samples are stored in host byte order.
     std::array<short, MAX_SAMPLES * 2> m_buffer{};
-    std::atomic<u32> m_indexW{0};
-    std::atomic<u32> m_indexR{0};
+    // The write index is only written by the emulation thread and the read index only by the
+    // audio thread, so each gets its own cache line.
+    alignas(64) std::atomic<u32> m_indexW{0};
+    alignas(64) std::atomic<u32> m_indexR{0};
     // Volume ranges from 0-256
-    std::atomic<s32> m_LVolume{256};
+    alignas(64) std::atomic<s32> m_LVolume{256};
     std::atomic<s32> m_RVolume{256};
+    std::atomic<u64> m_underruns{0};
+    // Underruns only count while samples are being pushed, not while paused or without audio.
+    std::atomic<u64> m_last_push_us{0};
     float m_numLeftI = 0.0f;
     u32 m_frac = 0;
+    std::vector<std::vector<float>> m_sinc_tables;
   };
 
   MixerFifo m_dma_mixer{this, 32000};
@@ -100,4 +141,9 @@ private:
 
   // Current rate of emulation (1.0 = 100% speed)
   std::atomic<float> m_speed{0.0f};
+
+  std::atomic<u64> m_mix_time_us{0};
+  std::atomic<u32> m_low_watermark_ms{0};
+  std::atomic<u32> m_backend_latency_us{0};
+  Statistics m_last_statistics{};
 };
@@ -13,6 +13,9 @@
 namespace
 {
 const size_t BUFFER_SAMPLES = 512;  // ~10 ms - needs to be at least 240 for surround
+// Limits for the low latency mode
+const u32 LOW_LATENCY_MIN_SAMPLES = 128;
+const u32 LOW_LATENCY_MAX_SAMPLES = 4096;
 }
 
 PulseAudio::PulseAudio() : m_thread(), m_run_thread()
@@ -26,6 +29,14 @@ bool PulseAudio::Start()
 
   NOTICE_LOG(AUDIO, "PulseAudio backend using %d channels", m_channels);
 
+  if (SConfig::GetInstance().m_audio_low_latency)
+  {
+    // Surround needs at least 240 samples per callback.
+    m_latency_controller = std::make_unique<AudioCommon::LatencyController>(
+        m_mixer->GetSampleRate(), m_stereo ? LOW_LATENCY_MIN_SAMPLES : 256,
+        LOW_LATENCY_MAX_SAMPLES, SConfig::GetInstance().iTimingVariance);
+  }
+
   m_run_thread.Set();
   m_thread = std::thread(&PulseAudio::SoundLoop, this);
 
@@ -36,6 +47,10 @@ void PulseAudio::Stop()
 {
   m_run_thread.Clear();
   m_thread.join();
+
+  m_latency_controller.reset();
+  m_mixer->SetLowWatermark(0);
+  m_mixer->SetBackendLatency(0);
 }
 
 void PulseAudio::Update()
@@ -124,6 +139,8 @@ bool PulseAudio::PulseInit()
   m_pa_ba.tlength =
       BUFFER_SAMPLES * m_channels *
       m_bytespersample;  // designed latency, only change this flag for low latency output
+  if (m_latency_controller)
+    m_pa_ba.tlength = m_latency_controller->GetTargetFrames() * m_channels * m_bytespersample;
   pa_stream_flags flags = pa_stream_flags(PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_ADJUST_LATENCY |
                                           PA_STREAM_AUTO_TIMING_UPDATE);
   m_pa_error = pa_stream_connect_playback(m_pa_s, nullptr, &m_pa_ba, flags, nullptr, nullptr);
@@ -163,6 +180,13 @@ void PulseAudio::StateCallback(pa_context* c)
 // on underflow, increase pulseaudio latency in ~10ms steps
 void PulseAudio::UnderflowCallback(pa_stream* s)
 {
+  // The low latency mode resizes the buffer in WriteCallback instead.
+  if (m_latency_controller)
+  {
+    m_latency_controller->OnUnderrun();
+    return;
+  }
+
   m_pa_ba.tlength += BUFFER_SAMPLES * m_channels * m_bytespersample;
   pa_operation* op = pa_stream_set_buffer_attr(s, &m_pa_ba, nullptr, nullptr);
   pa_operation_unref(op);
@@ -176,6 +200,26 @@ void PulseAudio::WriteCallback(pa_stream* s, size_t length)
   int frames = (length / bytes_per_frame);
   size_t trunc_length = frames * bytes_per_frame;
 
+  if (m_latency_controller)
+  {
+    m_latency_controller->OnCallback(frames, m_mixer->GetStatistics().underruns);
+    m_mixer->SetLowWatermark(m_latency_controller->GetLowWatermarkMs());
+
+    const u32 tlength = m_latency_controller->GetTargetFrames() * bytes_per_frame;
+    if (tlength != m_pa_ba.tlength)
+    {
+      m_pa_ba.tlength = tlength;
+      pa_operation* op = pa_stream_set_buffer_attr(s, &m_pa_ba, nullptr, nullptr);
+      pa_operation_unref(op);
+      INFO_LOG(AUDIO, "pulseaudio latency changed to %d bytes", m_pa_ba.tlength);
+    }
+  }
+
+  pa_usec_t latency;
+  int negative;
+  if (pa_stream_get_latency(s, &latency, &negative) >= 0)
+    m_mixer->SetBackendLatency(negative ? 0 : static_cast<u32>(latency));
+
   // fetch dst buffer directly from pulseaudio, so no memcpy is needed
   void* buffer;
   m_pa_error = pa_stream_begin_write(s, &buffer, &trunc_length);
@@ -8,6 +8,9 @@
 #include <pulse/pulseaudio.h>
 #endif
 
+#include <memory>
+
+#include "AudioCommon/LatencyController.h"
 #include "AudioCommon/SoundStream.h"
 #include "Common/CommonTypes.h"
 #include "Common/Flag.h"
@@ -53,5 +56,8 @@ private:
   pa_context* m_pa_ctx;
   pa_stream* m_pa_s;
   pa_buffer_attr m_pa_ba;
+
+  // Only used in the low latency mode.
+  std::unique_ptr<AudioCommon::LatencyController> m_latency_controller;
 #endif
 };
@@ -2,9 +2,19 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
+#include <cstring>
 #include <mbedtls/aes.h>
+#include <mbedtls/aesni.h>
 
 #include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
+
+// mbedtls only stores its key schedule in the AES-NI layout when it was built with the inline
+// assembly version, so the fast path below has to follow the exact same condition.
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+#define USE_AESNI_DECRYPT
+#endif
 
 namespace Common
 {
@@ -35,5 +45,77 @@ std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size)
 {
   return DecryptEncrypt(key, iv, src, size, Mode::Encrypt);
 }
+
+#ifdef USE_AESNI_DECRYPT
+FUNCTION_TARGET_AES
+static void DecryptCBC_AESNI(const mbedtls_aes_context* ctx, const u8* iv, const u8* src, u8* dst,
+                             size_t size)
+{
+  // Enough independent blocks to hide the latency of aesdec.
+  constexpr size_t PARALLEL_BLOCKS = 8;
+
+  const __m128i* round_keys = reinterpret_cast<const __m128i*>(ctx->rk);
+  const int rounds = ctx->nr;
+  const __m128i* in = reinterpret_cast<const __m128i*>(src);
+  __m128i* out = reinterpret_cast<__m128i*>(dst);
+  const size_t num_blocks = size / 16;
+
+  __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+  size_t i = 0;
+  for (; i + PARALLEL_BLOCKS <= num_blocks; i += PARALLEL_BLOCKS)
+  {
+    __m128i cipher[PARALLEL_BLOCKS];
+    __m128i state[PARALLEL_BLOCKS];
+
+    const __m128i first_key = _mm_loadu_si128(&round_keys[0]);
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+    {
+      cipher[j] = _mm_loadu_si128(&in[i + j]);
+      state[j] = _mm_xor_si128(cipher[j], first_key);
+    }
+    for (int round = 1; round < rounds; ++round)
+    {
+      const __m128i key = _mm_loadu_si128(&round_keys[round]);
+      for (__m128i& block : state)
+        block = _mm_aesdec_si128(block, key);
+    }
+    const __m128i last_key = _mm_loadu_si128(&round_keys[rounds]);
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+    {
+      const __m128i plain = _mm_aesdeclast_si128(state[j], last_key);
+      _mm_storeu_si128(&out[i + j], _mm_xor_si128(plain, j == 0 ? previous : cipher[j - 1]));
+    }
+    previous = cipher[PARALLEL_BLOCKS - 1];
+  }
+
+  for (; i < num_blocks; ++i)
+  {
+    const __m128i cipher = _mm_loadu_si128(&in[i]);
+    __m128i state = _mm_xor_si128(cipher, _mm_loadu_si128(&round_keys[0]));
+    for (int round = 1; round < rounds; ++round)
+      state = _mm_aesdec_si128(state, _mm_loadu_si128(&round_keys[round]));
+    state = _mm_aesdeclast_si128(state, _mm_loadu_si128(&round_keys[rounds]));
+    _mm_storeu_si128(&out[i], _mm_xor_si128(state, previous));
+    previous = cipher;
+  }
+}
+#endif
+
+void DecryptCBC(const mbedtls_aes_context* ctx, const u8* iv, const u8* src, u8* dst, size_t size)
+{
+#ifdef USE_AESNI_DECRYPT
+  static const bool has_aesni = mbedtls_aesni_has_support(MBEDTLS_AESNI_AES) != 0;
+  if (has_aesni)
+  {
+    DecryptCBC_AESNI(ctx, iv, src, dst, size);
+    return;
+  }
+#endif
+
+  std::array<u8, 16> iv_copy;
+  std::memcpy(iv_copy.data(), iv, iv_copy.size());
+  mbedtls_aes_crypt_cbc(const_cast<mbedtls_aes_context*>(ctx), MBEDTLS_AES_DECRYPT, size,
+                        iv_copy.data(), src, dst);
+}
 }  // namespace AES
 }  // namespace Common
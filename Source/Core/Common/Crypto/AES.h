@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <mbedtls/aes.h>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -23,5 +24,10 @@ std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size
 // Convenience functions
 std::vector<u8> Decrypt(const u8* key, u8* iv, const u8* src, size_t size);
 std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size);
+
+// CBC-decrypts size bytes (a multiple of 16) using a context set up with mbedtls_aes_setkey_dec.
+// Unlike mbedtls_aes_crypt_cbc, iv is left untouched and src may equal dst. Blocks are decrypted
+// several at a time with AES-NI when mbedtls uses it, as CBC decryption has no serial dependency.
+void DecryptCBC(const mbedtls_aes_context* ctx, const u8* iv, const u8* src, u8* dst, size_t size);
 }  // namespace AES
 }  // namespace Common
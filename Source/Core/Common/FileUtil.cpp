@@ -31,6 +31,7 @@
 #include <errno.h>
 #include <libgen.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -429,6 +430,22 @@ u64 GetSize(FILE* f)
   return size;
 }
 
+// Returns the last modification time of filename in seconds since the epoch
+u64 GetModificationTime(const std::string& filename)
+{
+  struct stat64 buf;
+#ifdef _WIN32
+  if (_tstat64(UTF8ToTStr(filename).c_str(), &buf) == 0)
+#else
+  if (stat64(filename.c_str(), &buf) == 0)
+#endif
+    return static_cast<u64>(buf.st_mtime);
+
+  WARN_LOG(COMMON, "GetModificationTime: stat failed %s: %s", filename.c_str(),
+           GetLastErrorMsg().c_str());
+  return 0;
+}
+
 // creates an empty file filename, returns true on success
 bool CreateEmptyFile(const std::string& filename)
 {
@@ -1020,4 +1037,76 @@ bool IOFile::Resize(u64 size)
   return m_good;
 }
 
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+  Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && size.QuadPart != 0)
+  {
+    // The mapping keeps the file open on its own.
+    m_mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+    {
+      m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+      m_size = size.QuadPart;
+    }
+  }
+  CloseHandle(file);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat64 file_info;
+  if (fstat64(fd, &file_info) == 0 && file_info.st_size != 0)
+  {
+    // The mapping keeps the file open on its own.
+    void* data = mmap(nullptr, file_info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      m_data = static_cast<const u8*>(data);
+      m_size = file_info.st_size;
+    }
+  }
+  close(fd);
+#endif
+
+  if (!m_data)
+  {
+    ERROR_LOG(COMMON, "MappedFile: failed to map %s: %s", filename.c_str(),
+              GetLastErrorMsg().c_str());
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  m_mapping = nullptr;
+#else
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
 }  // namespace
@@ -94,6 +94,9 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 on failure
+u64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -240,6 +243,27 @@ private:
   bool m_good;
 };
 
+// A read-only memory mapping of a whole file.
+class MappedFile : public NonCopyable
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return m_data != nullptr; }
+  const u8* GetData() const { return m_data; }
+  u64 GetSize() const { return m_size; }
+private:
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+#ifdef _WIN32
+  void* m_mapping = nullptr;
+#endif
+};
+
 }  // namespace
 
 // To deal with Windows being dumb at unicode:
@@ -612,6 +612,185 @@ u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+// Striped hash, built like the long input loop of xxHash3: the data is consumed in 64 byte
+// stripes by 8 independent 64-bit lanes, which each mix in a key with a 32x32->64 multiply. The
+// lanes map directly onto SSE2 and AVX2 registers, and all versions give the same result.
+static const u32 STRIPE_SIZE = 64;
+// The lanes get scrambled after this many stripes, so that the low bits keep mixing.
+static const u32 STRIPES_PER_SCRAMBLE = 16;
+static const u32 STRIPE_PRIME32 = 0x9E3779B1;
+
+alignas(32) static const u64 s_stripe_keys[8] = {
+    0xbe4ba423396cfeb8, 0x1cad21f72c81017c, 0xdb979083e96dd4de, 0x1f67b3b7a4a44072,
+    0x78e5c0cc4ee679cb, 0x2172ffcc7dd05a82, 0x8e2443f7744608b8, 0x4c263a81e69035e0};
+alignas(32) static const u64 s_scramble_keys[8] = {
+    0xcb00c391bb52283c, 0xa32e531b8b65d088, 0x4ef90da297486471, 0xd8acdea946ef1938,
+    0x3f349ce33f76faa8, 0x1d4f0bc7c7bbdcf9, 0x3159b4cd4be0518a, 0x647378d9c97e9fc8};
+
+static void AccumulateStripes_Generic(u64* acc, const u8* data, u32 stripes, u32 step)
+{
+  u32 count = 0;
+  for (u32 stripe = 0; stripe < stripes; stripe += step)
+  {
+    for (int i = 0; i < 8; i++)
+    {
+      u64 value;
+      memcpy(&value, data + stripe * STRIPE_SIZE + i * 8, sizeof(value));
+      const u64 keyed = value ^ s_stripe_keys[i];
+      acc[i ^ 1] += value;
+      acc[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+    }
+
+    if (++count % STRIPES_PER_SCRAMBLE == 0)
+    {
+      for (int i = 0; i < 8; i++)
+      {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= s_scramble_keys[i];
+        acc[i] *= STRIPE_PRIME32;
+      }
+    }
+  }
+}
+
+#if defined(_M_X86)
+
+static void AccumulateStripes_SSE2(u64* acc_out, const u8* data, u32 stripes, u32 step)
+{
+  const __m128i prime = _mm_set1_epi32(STRIPE_PRIME32);
+  __m128i acc[4];
+  for (int i = 0; i < 4; i++)
+    acc[i] = _mm_load_si128((const __m128i*)acc_out + i);
+
+  u32 count = 0;
+  for (u32 stripe = 0; stripe < stripes; stripe += step)
+  {
+    const __m128i* values = (const __m128i*)(data + stripe * STRIPE_SIZE);
+    for (int i = 0; i < 4; i++)
+    {
+      const __m128i value = _mm_loadu_si128(values + i);
+      const __m128i keyed =
+          _mm_xor_si128(value, _mm_load_si128((const __m128i*)s_stripe_keys + i));
+      const __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+      acc[i] = _mm_add_epi64(acc[i], _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc[i] = _mm_add_epi64(acc[i], product);
+    }
+
+    if (++count % STRIPES_PER_SCRAMBLE == 0)
+    {
+      for (int i = 0; i < 4; i++)
+      {
+        __m128i a = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+        a = _mm_xor_si128(a, _mm_load_si128((const __m128i*)s_scramble_keys + i));
+        const __m128i lo = _mm_mul_epu32(a, prime);
+        const __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+        acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+      }
+    }
+  }
+
+  for (int i = 0; i < 4; i++)
+    _mm_store_si128((__m128i*)acc_out + i, acc[i]);
+}
+
+FUNCTION_TARGET_AVX2
+static void AccumulateStripes_AVX2(u64* acc_out, const u8* data, u32 stripes, u32 step)
+{
+  const __m256i prime = _mm256_set1_epi32(STRIPE_PRIME32);
+  __m256i acc[2];
+  for (int i = 0; i < 2; i++)
+    acc[i] = _mm256_load_si256((const __m256i*)acc_out + i);
+
+  u32 count = 0;
+  for (u32 stripe = 0; stripe < stripes; stripe += step)
+  {
+    const __m256i* values = (const __m256i*)(data + stripe * STRIPE_SIZE);
+    for (int i = 0; i < 2; i++)
+    {
+      const __m256i value = _mm256_loadu_si256(values + i);
+      const __m256i keyed =
+          _mm256_xor_si256(value, _mm256_load_si256((const __m256i*)s_stripe_keys + i));
+      const __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+      acc[i] = _mm256_add_epi64(acc[i], _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc[i] = _mm256_add_epi64(acc[i], product);
+    }
+
+    if (++count % STRIPES_PER_SCRAMBLE == 0)
+    {
+      for (int i = 0; i < 2; i++)
+      {
+        __m256i a = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+        a = _mm256_xor_si256(a, _mm256_load_si256((const __m256i*)s_scramble_keys + i));
+        const __m256i lo = _mm256_mul_epu32(a, prime);
+        const __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+        acc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+      }
+    }
+  }
+
+  for (int i = 0; i < 2; i++)
+    _mm256_store_si256((__m256i*)acc_out + i, acc[i]);
+}
+
+#endif
+
+static u64 StripeAvalanche(u64 h)
+{
+  h ^= h >> 37;
+  h *= 0x165667919e3779f9;
+  h ^= h >> 32;
+  return h;
+}
+
+using AccumulateStripesFunction = void (*)(u64* acc, const u8* data, u32 stripes, u32 step);
+
+static u64 GetStripedHash(const u8* src, u32 len, u32 samples, AccumulateStripesFunction accumulate)
+{
+  alignas(32) u64 acc[8] = {STRIPE_PRIME32,      0x9e3779b185ebca87, 0xc2b2ae3d27d4eb4f,
+                            0x165667b19e3779f9, 0x85ebca77c2b2ae63, 0x27d4eb2f165667c5,
+                            0xff51afd7ed558ccd, 0xc4ceb9fe1a85ec53};
+
+  // Like for the other hashes, samples counts 8 byte reads.
+  const u32 stripes = len / STRIPE_SIZE;
+  const u32 sampled_stripes = samples / (STRIPE_SIZE / 8);
+  u32 step = 1;
+  if (samples != 0 && sampled_stripes < stripes)
+    step = stripes / std::max(sampled_stripes, 1u);
+  accumulate(acc, src, stripes, step);
+
+  if (len % STRIPE_SIZE != 0)
+  {
+    u8 last_stripe[STRIPE_SIZE] = {};
+    memcpy(last_stripe, src + stripes * STRIPE_SIZE, len % STRIPE_SIZE);
+    accumulate(acc, last_stripe, 1, 1);
+  }
+
+  u64 h = len * 0x9e3779b185ebca87;
+  for (int i = 0; i < 8; i++)
+  {
+    h ^= StripeAvalanche(acc[i] ^ s_stripe_keys[i]);
+    h = _rotl64(h, 27) * 0x9e3779b185ebca87 + 0x85ebca77c2b2ae63;
+  }
+  return StripeAvalanche(h);
+}
+
+static u64 GetStripedHash_Generic(const u8* src, u32 len, u32 samples)
+{
+  return GetStripedHash(src, len, samples, AccumulateStripes_Generic);
+}
+
+#if defined(_M_X86)
+static u64 GetStripedHash_SSE2(const u8* src, u32 len, u32 samples)
+{
+  return GetStripedHash(src, len, samples, AccumulateStripes_SSE2);
+}
+
+static u64 GetStripedHash_AVX2(const u8* src, u32 len, u32 samples)
+{
+  return GetStripedHash(src, len, samples, AccumulateStripes_AVX2);
+}
+#endif
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
   return ptrHashFunction(src, len, samples);
@@ -620,20 +799,58 @@ u64 GetHash64(const u8* src, u32 len, u32 samples)
 // sets the hash function used for the texture cache
 void SetHash64Function()
 {
-#if defined(_M_X86_64) || defined(_M_X86)
-  if (cpu_info.bSSE4_2)  // sse crc32 version
-  {
-    ptrHashFunction = &GetCRC32;
-  }
-  else
-#elif defined(_M_ARM_64)
-  if (cpu_info.bCRC32)
+  // The striped hash only catches up with the CRC32 instructions once it can use AVX2, but it
+  // mixes all of the data instead of folding a few CRCs together.
+#if defined(_M_X86)
+  if (cpu_info.bAVX2)
   {
-    ptrHashFunction = &GetCRC32;
+    SetHash64Function(HashFunction::Striped);
+    return;
   }
-  else
 #endif
+  if (!SetHash64Function(HashFunction::CRC32))
+    SetHash64Function(HashFunction::Striped);
+}
+
+bool SetHash64Function(HashFunction function)
+{
+  switch (function)
   {
+  case HashFunction::MurmurHash3:
     ptrHashFunction = &GetMurmurHash3;
+    return true;
+
+  case HashFunction::CRC32:
+#if defined(_M_X86_64) || defined(_M_X86)
+    if (cpu_info.bSSE4_2)  // sse crc32 version
+    {
+      ptrHashFunction = &GetCRC32;
+      return true;
+    }
+#elif defined(_M_ARM_64)
+    if (cpu_info.bCRC32)
+    {
+      ptrHashFunction = &GetCRC32;
+      return true;
+    }
+#endif
+    return false;
+
+  case HashFunction::Striped:
+#if defined(_M_X86)
+    if (cpu_info.bAVX2)
+      ptrHashFunction = &GetStripedHash_AVX2;
+    else
+      ptrHashFunction = &GetStripedHash_SSE2;
+#else
+    ptrHashFunction = &GetStripedHash_Generic;
+#endif
+    return true;
+
+  case HashFunction::StripedGeneric:
+    ptrHashFunction = &GetStripedHash_Generic;
+    return true;
   }
+
+  return false;
 }
@@ -12,5 +12,21 @@ u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
 u64 GetHashHiresTexture(const u8* src, u32 len, u32 samples = 0);
+
+enum class HashFunction
+{
+  MurmurHash3,
+  // Needs SSE4.2 or the ARMv8 CRC32 extension.
+  CRC32,
+  // xxHash3-style hash over 64 byte stripes, using SSE2 or AVX2 where available.
+  Striped,
+  // The plain C version of Striped, for checking the SIMD versions against.
+  StripedGeneric,
+};
+
+// Hash used by the texture cache. samples limits how many 8 byte words get read, 0 reads all.
 u64 GetHash64(const u8* src, u32 len, u32 samples);
+// Picks the fastest hash function available on this CPU.
 void SetHash64Function();
+// Returns false if the CPU doesn't support the given function, keeping the previous one.
+bool SetHash64Function(HashFunction function);
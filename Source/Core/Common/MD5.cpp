@@ -2,44 +2,179 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <condition_variable>
 #include <fstream>
 #include <functional>
 #include <mbedtls/md5.h>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/MathUtil.h"
 #include "Common/MD5.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "DiscIO/Blob.h"
 
 namespace MD5
 {
-std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report_progress)
+static constexpr size_t CHUNK_SIZE = 8 * 1024 * 1024;
+static constexpr size_t MAX_READERS = 4;
+
+// The cached sum is only valid for a file with the same size and modification time.
+static std::string GetCacheFilename(const std::string& file_path)
 {
-  std::string output_string;
-  std::vector<u8> data(8 * 1024 * 1024);
-  u64 read_offset = 0;
-  mbedtls_md5_context ctx;
+  std::string path, name, extension;
+  SplitPath(file_path, &path, &name, &extension);
 
-  std::unique_ptr<DiscIO::IBlobReader> file(DiscIO::CreateBlobReader(file_path));
-  u64 game_size = file->GetDataSize();
+  if (name.empty())
+    return name;
 
-  mbedtls_md5_starts(&ctx);
+  return File::GetUserPath(D_CACHE_IDX) +
+         StringFromFormat("%s%s_%x_%" PRIx64 "_%" PRIx64 ".md5", name.c_str(), extension.c_str(),
+                          HashFletcher(reinterpret_cast<const u8*>(path.c_str()), path.size()),
+                          File::GetSize(file_path), File::GetModificationTime(file_path));
+}
 
-  while (read_offset < game_size)
+// Reading a compressed image is usually slower than hashing it, so several threads read ahead,
+// each with its own blob reader, while the calling thread hashes the chunks in order.
+static bool HashChunks(const std::string& file_path, u64 game_size, mbedtls_md5_context* ctx,
+                       const std::function<bool(int)>& report_progress)
+{
+  struct Slot
   {
-    size_t read_size = std::min(static_cast<u64>(data.size()), game_size - read_offset);
-    if (!file->Read(read_offset, read_size, data.data()))
-      return output_string;
+    std::vector<u8> data;
+    size_t size = 0;
+    bool ready = false;
+    bool ok = false;
+  };
+
+  const u64 num_chunks = (game_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  const size_t num_readers = static_cast<size_t>(std::min<u64>(
+      num_chunks, MathUtil::Clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_READERS)));
+
+  std::vector<Slot> slots(num_readers);
+  std::mutex mutex;
+  std::condition_variable slot_changed;
+  bool abort = false;
+
+  // Reader i fills slot i with chunks i, i + num_readers, ...
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < num_readers; ++i)
+  {
+    readers.emplace_back([&, i] {
+      Common::SetCurrentThreadName("MD5 reader");
 
-    mbedtls_md5_update(&ctx, data.data(), read_size);
-    read_offset += read_size;
+      std::unique_ptr<DiscIO::IBlobReader> reader(DiscIO::CreateBlobReader(file_path));
+      Slot& slot = slots[i];
+      slot.data.resize(CHUNK_SIZE);
 
+      for (u64 chunk = i; chunk < num_chunks; chunk += num_readers)
+      {
+        {
+          std::unique_lock<std::mutex> lk(mutex);
+          slot_changed.wait(lk, [&] { return !slot.ready || abort; });
+          if (abort)
+            return;
+        }
+
+        const u64 offset = chunk * CHUNK_SIZE;
+        const size_t size = static_cast<size_t>(std::min<u64>(CHUNK_SIZE, game_size - offset));
+        const bool ok = reader && reader->Read(offset, size, slot.data.data());
+
+        {
+          std::lock_guard<std::mutex> lk(mutex);
+          slot.size = size;
+          slot.ok = ok;
+          slot.ready = true;
+        }
+        slot_changed.notify_all();
+
+        if (!ok)
+          return;
+      }
+    });
+  }
+
+  bool success = true;
+  for (u64 chunk = 0; chunk < num_chunks; ++chunk)
+  {
+    Slot& slot = slots[chunk % num_readers];
+    {
+      std::unique_lock<std::mutex> lk(mutex);
+      slot_changed.wait(lk, [&] { return slot.ready; });
+    }
+
+    if (!slot.ok)
+    {
+      success = false;
+      break;
+    }
+
+    mbedtls_md5_update(ctx, slot.data.data(), slot.size);
+
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      slot.ready = false;
+    }
+    slot_changed.notify_all();
+
+    const u64 read_offset = std::min<u64>((chunk + 1) * CHUNK_SIZE, game_size);
     int progress =
         static_cast<int>(static_cast<float>(read_offset) / static_cast<float>(game_size) * 100);
     if (!report_progress(progress))
+    {
+      success = false;
+      break;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    abort = true;
+  }
+  slot_changed.notify_all();
+
+  for (std::thread& reader : readers)
+    reader.join();
+
+  return success;
+}
+
+std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report_progress)
+{
+  std::string output_string;
+
+  const std::string cache_filename = GetCacheFilename(file_path);
+  if (!cache_filename.empty() && File::ReadFileToString(cache_filename, output_string) &&
+      output_string.size() == 32)
+  {
+    report_progress(100);
+    return output_string;
+  }
+  output_string.clear();
+
+  u64 game_size;
+  {
+    std::unique_ptr<DiscIO::IBlobReader> file(DiscIO::CreateBlobReader(file_path));
+    if (!file)
       return output_string;
+    game_size = file->GetDataSize();
   }
 
+  mbedtls_md5_context ctx;
+  mbedtls_md5_starts(&ctx);
+
+  if (!HashChunks(file_path, game_size, &ctx, report_progress))
+    return output_string;
+
   std::array<u8, 16> output;
   mbedtls_md5_finish(&ctx, output.data());
 
@@ -47,6 +182,13 @@ std::string MD5Sum(const std::string& file_path, std::function<bool(int)> report
   for (u8 n : output)
     output_string += StringFromFormat("%02x", n);
 
+  if (!cache_filename.empty())
+  {
+    if (!File::IsDirectory(File::GetUserPath(D_CACHE_IDX)))
+      File::CreateDir(File::GetUserPath(D_CACHE_IDX));
+    File::WriteStringToFile(output_string, cache_filename);
+  }
+
   return output_string;
 }
-}
\ No newline at end of file
+}
@@ -19,5 +19,6 @@ void WriteProtectMemory(void* ptr, size_t size, bool executable = false);
 void UnWriteProtectMemory(void* ptr, size_t size, bool allowExecute = false);
 std::string MemUsage();
 size_t MemPhysical();
+size_t GetPageSize();
 
 }  // namespace Common
@@ -0,0 +1,127 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "Common/Thread.h"
+
+namespace Common
+{
+WorkerPool::WorkerPool(const std::string& name, size_t num_threads) : m_name(name)
+{
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  m_threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i)
+    m_threads.emplace_back(&WorkerPool::ThreadLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_shutdown = true;
+  }
+  m_work_available.notify_all();
+
+  for (std::thread& thread : m_threads)
+    thread.join();
+}
+
+void WorkerPool::Push(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_jobs.push_back(std::move(job));
+  }
+  m_work_available.notify_one();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+  if (count == 0)
+    return;
+
+  if (count == 1 || m_threads.size() <= 1)
+  {
+    for (size_t i = 0; i < count; ++i)
+      func(i);
+    return;
+  }
+
+  // Helpers may only get scheduled after all indices have been handed out, so the shared state
+  // has to outlive this call.
+  struct State
+  {
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> remaining;
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+  auto state = std::make_shared<State>();
+  state->remaining = count;
+
+  const auto work = [state, count, &func] {
+    size_t index;
+    while ((index = state->next_index++) < count)
+    {
+      func(index);
+      if (--state->remaining == 0)
+      {
+        std::lock_guard<std::mutex> lk(state->mutex);
+        state->done.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = std::min(count - 1, m_threads.size());
+  for (size_t i = 0; i < helpers; ++i)
+  {
+    // Late helpers find no index left and return without touching func.
+    Push(work);
+  }
+
+  work();
+
+  std::unique_lock<std::mutex> lk(state->mutex);
+  state->done.wait(lk, [&state] { return state->remaining == 0; });
+}
+
+void WorkerPool::WaitForIdle()
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_idle.wait(lk, [this] { return m_jobs.empty() && m_running_jobs == 0; });
+}
+
+void WorkerPool::ThreadLoop()
+{
+  SetCurrentThreadName(m_name.c_str());
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (true)
+  {
+    m_work_available.wait(lk, [this] { return m_shutdown || !m_jobs.empty(); });
+    if (m_jobs.empty())
+      return;
+
+    std::function<void()> job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    ++m_running_jobs;
+
+    lk.unlock();
+    job();
+    lk.lock();
+
+    if (--m_running_jobs == 0 && m_jobs.empty())
+      m_idle.notify_all();
+  }
+}
+
+}  // namespace Common
@@ -0,0 +1,53 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common
+{
+// A fixed set of worker threads which run queued jobs in FIFO order.
+// Jobs must not block waiting for other jobs queued after them on the same pool.
+class WorkerPool
+{
+public:
+  // A thread count of 0 uses one thread per hardware thread.
+  explicit WorkerPool(const std::string& name, size_t num_threads = 0);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t GetThreadCount() const { return m_threads.size(); }
+  void Push(std::function<void()> job);
+
+  // Calls func(i) for every i in [0, count) and returns once all calls have finished.
+  // The calling thread takes part in the work, so this is safe to use from a job as well.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+  // Blocks until the queue is empty and no job is running.
+  void WaitForIdle();
+
+private:
+  void ThreadLoop();
+
+  std::string m_name;
+  std::vector<std::thread> m_threads;
+  std::deque<std::function<void()>> m_jobs;
+  std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_idle;
+  size_t m_running_jobs = 0;
+  bool m_shutdown = false;
+};
+
+}  // namespace Common
@@ -495,6 +495,9 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", iCPUCore);
   core->Set("Fastmem", bFastmem);
+  core->Set("PersistentJITCache", bJITPersistentCache);
+  core->Set("JITTier2Threshold", iJITTier2Threshold);
+  core->Set("JITBackgroundCompile", bJITBackgroundCompile);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SkipIdle", bSkipIdle);
@@ -509,12 +512,17 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("DVDRoot", m_strDVDRoot);
   core->Set("Apploader", m_strApploader);
   core->Set("EnableCheats", bEnableCheats);
+  core->Set("DeltaSaveStates", bDeltaSaveStates);
+  core->Set("RewindBufferSize", iRewindBufferSize);
+  core->Set("RewindInterval", iRewindInterval);
   core->Set("SelectedLanguage", SelectedLanguage);
   core->Set("OverrideGCLang", bOverrideGCLanguage);
   core->Set("DPL2Decoder", bDPL2Decoder);
   core->Set("Latency", iLatency);
   core->Set("AudioStretch", m_audio_stretch);
   core->Set("AudioStretchMaxLatency", m_audio_stretch_max_latency);
+  core->Set("AudioResampler", m_audio_resampler);
+  core->Set("AudioLowLatency", m_audio_low_latency);
   core->Set("MemcardAPath", m_strMemoryCardA);
   core->Set("MemcardBPath", m_strMemoryCardB);
   core->Set("AgpCartAPath", m_strGbaCartA);
@@ -564,6 +572,7 @@ void SConfig::SaveDSPSettings(IniFile& ini)
   IniFile::Section* dsp = ini.GetOrCreateSection("DSP");
 
   dsp->Set("EnableJIT", m_DSPEnableJIT);
+  dsp->Set("HLEThread", m_DSPHLEThread);
   dsp->Set("DumpAudio", m_DumpAudio);
   dsp->Set("DumpAudioSilent", m_DumpAudioSilent);
   dsp->Set("DumpUCode", m_DumpUCode);
@@ -894,6 +903,9 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("PersistentJITCache", &bJITPersistentCache, false);
+  core->Get("JITTier2Threshold", &iJITTier2Threshold, 0);
+  core->Get("JITBackgroundCompile", &bJITBackgroundCompile, false);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
@@ -903,12 +915,17 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("DVDRoot", &m_strDVDRoot);
   core->Get("Apploader", &m_strApploader);
   core->Get("EnableCheats", &bEnableCheats, false);
+  core->Get("DeltaSaveStates", &bDeltaSaveStates, false);
+  core->Get("RewindBufferSize", &iRewindBufferSize, 0);
+  core->Get("RewindInterval", &iRewindInterval, 10);
   core->Get("SelectedLanguage", &SelectedLanguage, 0);
   core->Get("OverrideGCLang", &bOverrideGCLanguage, false);
   core->Get("DPL2Decoder", &bDPL2Decoder, false);
   core->Get("Latency", &iLatency, 5);
   core->Get("AudioStretch", &m_audio_stretch, false);
   core->Get("AudioStretchMaxLatency", &m_audio_stretch_max_latency, 80);
+  core->Get("AudioResampler", &m_audio_resampler, 0);
+  core->Get("AudioLowLatency", &m_audio_low_latency, false);
   core->Get("MemcardAPath", &m_strMemoryCardA);
   core->Get("MemcardBPath", &m_strMemoryCardB);
   core->Get("AgpCartAPath", &m_strGbaCartA);
@@ -976,6 +993,7 @@ void SConfig::LoadDSPSettings(IniFile& ini)
   IniFile::Section* dsp = ini.GetOrCreateSection("DSP");
 
   dsp->Get("EnableJIT", &m_DSPEnableJIT, true);
+  dsp->Get("HLEThread", &m_DSPHLEThread, false);
   dsp->Get("DumpAudio", &m_DumpAudio, false);
   dsp->Get("DumpAudioSilent", &m_DumpAudioSilent, false);
   dsp->Get("DumpUCode", &m_DumpUCode, false);
@@ -1169,6 +1187,8 @@ void SConfig::LoadDefaults()
   iLatency = 14;
   m_audio_stretch = false;
   m_audio_stretch_max_latency = 80;
+  m_audio_resampler = 0;
+  m_audio_low_latency = false;
 
   iPosX = INT_MIN;
   iPosY = INT_MIN;
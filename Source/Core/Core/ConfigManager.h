@@ -82,6 +82,9 @@ struct SConfig : NonCopyable
   int iCPUCore;  // Uses the values of PowerPC::CPUCore
 
   bool bJITNoBlockCache = false;
+  bool bJITPersistentCache = false;
+  int iJITTier2Threshold = 0;
+  bool bJITBackgroundCompile = false;
   bool bJITNoBlockLinking = false;
   bool bJITOff = false;
   bool bJITLoadStoreOff = false;
@@ -110,6 +113,12 @@ struct SConfig : NonCopyable
   bool bHLE_BS2 = true;
   bool bEnableCheats = false;
   bool bEnableMemcardSdWriting = true;
+  // Savestates only store what changed since the last full savestate of this session.
+  bool bDeltaSaveStates = false;
+  // Memory for rewinding the emulation, in MiB. 0 disables it.
+  int iRewindBufferSize = 0;
+  // How many frames apart the rewind states are captured, and so how far each step goes back.
+  int iRewindInterval = 10;
   bool bCopyWiiSaveNetplay = true;
   float fAudioSlowDown;
 
@@ -117,6 +126,8 @@ struct SConfig : NonCopyable
   int iLatency = 14;
   bool m_audio_stretch = false;
   int m_audio_stretch_max_latency = 80;
+  int m_audio_resampler = 0;  // CMixer::Resampler
+  bool m_audio_low_latency = false;
 
   bool bRunCompareServer = false;
   bool bRunCompareClient = false;
@@ -346,6 +357,7 @@ struct SConfig : NonCopyable
 
   // DSP settings
   bool m_DSPEnableJIT;
+  bool m_DSPHLEThread;
   bool m_DSPCaptureLog;
   bool m_DumpAudio;
   bool m_DumpAudioSilent;
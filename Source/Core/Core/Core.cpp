@@ -60,6 +60,7 @@
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 #include "Core/WiiRoot.h"
 
@@ -165,6 +166,8 @@ void FrameUpdateOnCPUThread()
 {
   if (NetPlay::IsNetPlayRunning())
     NetPlayClient::SendTimeBase();
+
+  Rewind::FrameUpdate();
 }
 
 // Display messages and return values
@@ -1114,6 +1117,17 @@ void UpdateTitle()
           _CoreParameter.bSkipIdle ? "~" : "", (int)(diff), (int)(diff - idleDiff),
           (int)(idleDiff), SystemTimers::GetTicksPerSecond() / 1000000,
           _CoreParameter.bSkipIdle ? "~" : "", TicksPercentage);
+
+      if (g_sound_stream)
+      {
+        // The mixer keeps the previous values, so they start over with each new mixer.
+        const CMixer::Statistics audio_stats = g_sound_stream->GetMixer()->GetStatisticsDelta();
+
+        SFPS += StringFromFormat(" | Audio: %.1f%% [Underruns: %u, Latency: %u ms]",
+                                 audio_stats.mix_time_us / (ElapseTime * 10.0f),
+                                 static_cast<u32>(audio_stats.underruns),
+                                 audio_stats.latency_us / 1000);
+      }
     }
   }
 
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -26,10 +27,14 @@
 
 namespace CoreTiming
 {
+static constexpr u32 INVALID_NODE = std::numeric_limits<u32>::max();
+
 struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+  // Head of the list of this type's pending events in the event queue.
+  u32 first_pending = INVALID_NODE;
 };
 
 struct Event
@@ -41,25 +46,266 @@ struct Event
 };
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-static bool operator>(const Event& left, const Event& right)
-{
-  return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-}
 static bool operator<(const Event& left, const Event& right)
 {
   return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+// A pairing heap of events, ordered by (time, fifo_order). As that order is total, events always
+// come out in the same order no matter how the heap happens to be shaped.
+//
+// Scheduling is O(1). Removing an event type is O(1) per pending event, as events are only
+// flagged and left in the heap until they reach the top (or outnumber the live events, in which
+// case the heap gets rebuilt). Popping the next event is O(log n) amortized.
+class EventQueue
+{
+public:
+  bool Empty() const { return m_num_live == 0; }
+  void Push(const Event& event);
+  // The queue must not be empty.
+  const Event& Top();
+  Event Pop();
+  void Remove(EventType* type);
+  void Clear();
+  std::vector<Event> GetSortedEvents() const;
+
+private:
+  struct Node
+  {
+    Event event;
+    u32 child;
+    u32 sibling;
+    // Links in the list of pending events of the same type.
+    u32 type_prev;
+    u32 type_next;
+    bool removed;
+  };
+
+  u32 Meld(u32 a, u32 b);
+  u32 MergePairs(u32 first);
+  void PopRoot();
+  void DropRemovedTop();
+  void Rebuild();
+  template <typename Func>
+  void ForEachNode(Func func) const;
+
+  std::vector<Node> m_nodes;
+  std::vector<u32> m_free_nodes;
+  std::vector<u32> m_scratch;
+  u32 m_root = INVALID_NODE;
+  size_t m_num_live = 0;
+  size_t m_num_removed = 0;
+};
+
+void EventQueue::Push(const Event& event)
+{
+  u32 index;
+  if (m_free_nodes.empty())
+  {
+    index = static_cast<u32>(m_nodes.size());
+    m_nodes.emplace_back();
+  }
+  else
+  {
+    index = m_free_nodes.back();
+    m_free_nodes.pop_back();
+  }
+
+  Node& node = m_nodes[index];
+  node.event = event;
+  node.child = INVALID_NODE;
+  node.sibling = INVALID_NODE;
+  node.removed = false;
+
+  node.type_prev = INVALID_NODE;
+  node.type_next = event.type->first_pending;
+  if (node.type_next != INVALID_NODE)
+    m_nodes[node.type_next].type_prev = index;
+  event.type->first_pending = index;
+
+  m_root = Meld(m_root, index);
+  ++m_num_live;
+}
+
+const Event& EventQueue::Top()
+{
+  DropRemovedTop();
+  return m_nodes[m_root].event;
+}
+
+Event EventQueue::Pop()
+{
+  DropRemovedTop();
+
+  const Node& node = m_nodes[m_root];
+  if (node.type_prev != INVALID_NODE)
+    m_nodes[node.type_prev].type_next = node.type_next;
+  else
+    node.event.type->first_pending = node.type_next;
+  if (node.type_next != INVALID_NODE)
+    m_nodes[node.type_next].type_prev = node.type_prev;
+
+  const Event event = node.event;
+  PopRoot();
+  --m_num_live;
+  return event;
+}
+
+void EventQueue::Remove(EventType* type)
+{
+  u32 index = type->first_pending;
+  while (index != INVALID_NODE)
+  {
+    Node& node = m_nodes[index];
+    node.removed = true;
+    index = node.type_next;
+    --m_num_live;
+    ++m_num_removed;
+  }
+  type->first_pending = INVALID_NODE;
+
+  if (m_num_removed > 32 && m_num_removed > m_num_live)
+    Rebuild();
+}
+
+void EventQueue::Clear()
+{
+  ForEachNode([](const Node& node) {
+    if (!node.removed)
+      node.event.type->first_pending = INVALID_NODE;
+  });
+
+  m_nodes.clear();
+  m_free_nodes.clear();
+  m_root = INVALID_NODE;
+  m_num_live = 0;
+  m_num_removed = 0;
+}
+
+std::vector<Event> EventQueue::GetSortedEvents() const
+{
+  std::vector<Event> events;
+  events.reserve(m_num_live);
+  ForEachNode([&events](const Node& node) {
+    if (!node.removed)
+      events.push_back(node.event);
+  });
+  std::sort(events.begin(), events.end());
+  return events;
+}
+
+// Both nodes must be roots, i.e. have no siblings.
+u32 EventQueue::Meld(u32 a, u32 b)
+{
+  if (a == INVALID_NODE)
+    return b;
+  if (b == INVALID_NODE)
+    return a;
+
+  if (m_nodes[b].event < m_nodes[a].event)
+    std::swap(a, b);
+  m_nodes[b].sibling = m_nodes[a].child;
+  m_nodes[a].child = b;
+  return a;
+}
+
+// The standard two-pass merge: meld siblings pairwise from the left, then fold the results
+// together from the right.
+u32 EventQueue::MergePairs(u32 first)
+{
+  m_scratch.clear();
+  while (first != INVALID_NODE)
+  {
+    const u32 a = first;
+    const u32 b = m_nodes[a].sibling;
+    if (b == INVALID_NODE)
+    {
+      m_scratch.push_back(a);
+      break;
+    }
+
+    first = m_nodes[b].sibling;
+    m_nodes[a].sibling = INVALID_NODE;
+    m_nodes[b].sibling = INVALID_NODE;
+    m_scratch.push_back(Meld(a, b));
+  }
+
+  u32 result = INVALID_NODE;
+  for (auto it = m_scratch.rbegin(); it != m_scratch.rend(); ++it)
+    result = Meld(*it, result);
+  return result;
+}
+
+void EventQueue::PopRoot()
+{
+  const u32 old_root = m_root;
+  m_root = MergePairs(m_nodes[old_root].child);
+  m_free_nodes.push_back(old_root);
+}
+
+void EventQueue::DropRemovedTop()
+{
+  while (m_nodes[m_root].removed)
+  {
+    PopRoot();
+    --m_num_removed;
+  }
+}
+
+void EventQueue::Rebuild()
+{
+  std::vector<u32> live;
+  live.reserve(m_num_live);
+  ForEachNode([&](const Node& node) {
+    if (!node.removed)
+      live.push_back(static_cast<u32>(&node - m_nodes.data()));
+  });
+
+  std::vector<bool> is_live(m_nodes.size());
+  for (u32 index : live)
+    is_live[index] = true;
+  m_free_nodes.clear();
+  for (u32 i = 0; i < static_cast<u32>(m_nodes.size()); ++i)
+  {
+    if (!is_live[i])
+      m_free_nodes.push_back(i);
+  }
+
+  m_root = INVALID_NODE;
+  for (u32 index : live)
+  {
+    m_nodes[index].child = INVALID_NODE;
+    m_nodes[index].sibling = INVALID_NODE;
+    m_root = Meld(m_root, index);
+  }
+  m_num_removed = 0;
+}
+
+template <typename Func>
+void EventQueue::ForEachNode(Func func) const
+{
+  if (m_root == INVALID_NODE)
+    return;
+
+  std::vector<u32> stack{m_root};
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.back()];
+    stack.pop_back();
+    func(node);
+    if (node.sibling != INVALID_NODE)
+      stack.push_back(node.sibling);
+    if (node.child != INVALID_NODE)
+      stack.push_back(node.child);
+  }
+}
+
 // unordered_map stores each element separately as a linked list node so pointers to elements
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+static EventQueue s_event_queue;
 static u64 s_event_fifo_id;
 static std::mutex s_ts_write_lock;
 static Common::FifoQueue<Event, false> s_ts_queue;
@@ -123,7 +369,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  _assert_msg_(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  _assert_msg_(POWERPC, s_event_queue.Empty(), "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -171,7 +417,10 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  // Saved in (time, fifo_order) order, so that identical emulation states give identical save
+  // states regardless of how the queue is laid out in memory.
+  std::vector<Event> events = s_event_queue.GetSortedEvents();
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -205,10 +454,13 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingEvents");
 
   // When loading from a save state, we must assume the Event order is random and meaningless.
-  // The exact layout of the heap in memory is implementation defined, therefore it is platform
-  // and library version specific.
+  // Older save states stored the raw layout of a binary heap.
   if (p.GetMode() == PointerWrap::MODE_READ)
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+  {
+    s_event_queue.Clear();
+    for (const Event& ev : events)
+      s_event_queue.Push(ev);
+  }
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -231,7 +483,7 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  s_event_queue.Clear();
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -258,8 +510,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(Event{timeout, s_event_fifo_id++, userdata, event_type});
   }
   else
   {
@@ -277,15 +528,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
-
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+  s_event_queue.Remove(event_type);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -311,8 +554,7 @@ void MoveEvents()
   for (Event ev; s_ts_queue.Pop(ev);)
   {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(ev);
   }
 }
 
@@ -328,11 +570,9 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
+  while (!s_event_queue.Empty() && s_event_queue.Top().time <= g.global_timer)
   {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
+    Event evt = s_event_queue.Pop();
     // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
     //            g.global_timer, evt.time);
     evt.type->callback(evt.userdata, g.global_timer - evt.time);
@@ -341,10 +581,10 @@ void Advance()
   s_is_global_timer_sane = false;
 
   // Still events left (scheduled in the future)
-  if (!s_event_queue.empty())
+  if (!s_event_queue.Empty())
   {
     g.slice_length = static_cast<int>(
-        std::min<s64>(s_event_queue.front().time - g.global_timer, MAX_SLICE_LENGTH));
+        std::min<s64>(s_event_queue.Top().time - g.global_timer, MAX_SLICE_LENGTH));
   }
 
   PowerPC::ppcState.downcount = CyclesToDowncount(g.slice_length);
@@ -358,9 +598,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
-  std::sort(clone.begin(), clone.end());
-  for (const Event& ev : clone)
+  for (const Event& ev : s_event_queue.GetSortedEvents())
   {
     INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %s", g.global_timer,
              ev.time, ev.type->name->c_str());
@@ -370,10 +608,14 @@ void LogPendingEvents()
 // Should only be called from the CPU thread after the PPC clock has changed
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
 {
-  for (Event& ev : s_event_queue)
+  // Rounding can turn distinct times into equal ones, which the heap order doesn't survive.
+  std::vector<Event> events = s_event_queue.GetSortedEvents();
+  s_event_queue.Clear();
+  for (Event& ev : events)
   {
     const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
     ev.time = g.global_timer + ticks;
+    s_event_queue.Push(ev);
   }
 }
 
@@ -396,9 +638,7 @@ std::string GetScheduledEventsSummary()
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
-  std::sort(clone.begin(), clone.end());
-  for (const Event& ev : clone)
+  for (const Event& ev : s_event_queue.GetSortedEvents())
   {
     text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", ev.type->name->c_str(), ev.time,
                              ev.userdata);
@@ -237,9 +237,10 @@ void DSPEmitter::Compile(u16 start_addr)
     UDSPInstruction inst = dsp_imem_read(m_compile_pc);
     const DSPOPCTemplate* opcode = GetOpTemplate(inst);
 
+    // Counted before emitting, so that the exits and links a branch emits charge it as well.
+    m_block_size[start_addr]++;
     EmitInstruction(inst);
 
-    m_block_size[start_addr]++;
     m_compile_pc += opcode->size;
 
     // If the block was trying to link into itself, remove the link
@@ -212,6 +212,7 @@ public:
 private:
   void WriteBranchExit();
   void WriteBlockLink(u16 dest);
+  void WriteBlockLinkJump(Block target, u16 cycles, u16 target_cycles);
 
   void ReJitConditional(UDSPInstruction opc, void (DSPEmitter::*conditional_fn)(UDSPInstruction));
   void r_jcc(UDSPInstruction opc);
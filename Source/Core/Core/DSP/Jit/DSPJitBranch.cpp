@@ -102,22 +102,26 @@ void DSPEmitter::WriteBranchExit()
 
 void DSPEmitter::WriteBlockLink(u16 dest)
 {
+  // Idle loops must go back to the dispatcher so that the idle skip can take effect.
+  if (Analyzer::GetCodeFlags(m_start_address) & Analyzer::CODE_IDLE_SKIP)
+    return;
+
+  // Instructions executed in this block so far, including the branch being compiled.
+  const u16 cycles = m_block_size[m_start_address];
+
+  // A branch back to the start of the block being compiled turns it into a loop.
+  if (dest == m_start_address)
+  {
+    WriteBlockLinkJump(m_block_link_entry, cycles, cycles);
+    return;
+  }
+
   // Jump directly to the called block if it has already been compiled.
   if (!(dest >= m_start_address && dest <= m_compile_pc))
   {
     if (m_block_links[dest] != nullptr)
     {
-      m_gpr.FlushRegs();
-      // Check if we have enough cycles to execute the next block
-      MOV(64, R(RAX), ImmPtr(&m_cycles_left));
-      MOV(16, R(ECX), MatR(RAX));
-      CMP(16, R(ECX), Imm16(m_block_size[m_start_address] + m_block_size[dest]));
-      FixupBranch notEnoughCycles = J_CC(CC_BE);
-
-      SUB(16, R(ECX), Imm16(m_block_size[m_start_address]));
-      MOV(16, MatR(RAX), R(ECX));
-      JMP(m_block_links[dest], true);
-      SetJumpTarget(notEnoughCycles);
+      WriteBlockLinkJump(m_block_links[dest], cycles, m_block_size[dest]);
     }
     else
     {
@@ -128,14 +132,27 @@ void DSPEmitter::WriteBlockLink(u16 dest)
   }
 }
 
+void DSPEmitter::WriteBlockLinkJump(Block target, u16 cycles, u16 target_cycles)
+{
+  m_gpr.FlushRegs();
+  // Check if we have enough cycles to execute the next block
+  MOV(64, R(RAX), ImmPtr(&m_cycles_left));
+  MOV(16, R(ECX), MatR(RAX));
+  CMP(16, R(ECX), Imm16(cycles + target_cycles));
+  FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+  SUB(16, R(ECX), Imm16(cycles));
+  MOV(16, MatR(RAX), R(ECX));
+  JMP(target, true);
+  SetJumpTarget(notEnoughCycles);
+}
+
 void DSPEmitter::r_jcc(const UDSPInstruction opc)
 {
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // Conditional branches are linked too; ReJitConditional only emits this for the taken path.
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -177,11 +194,7 @@ void DSPEmitter::r_call(const UDSPInstruction opc)
   MOV(16, R(DX), Imm16(m_compile_pc + 2));
   dsp_reg_store_stack(StackRegister::Call);
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
-
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -0,0 +1,229 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/FifoPlayer/FifoBenchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "VideoCommon/Statistics.h"
+
+namespace FifoBenchmark
+{
+using Clock = std::chrono::steady_clock;
+
+struct FrameResult
+{
+  u32 frame;
+  u64 wall_time;  // nanoseconds
+  std::array<u64, Statistics::NUM_OPCODE_CLASSES> opcodes;
+  u64 vertices;
+  u64 vertex_loader_time;   // nanoseconds
+  u64 texture_decode_time;  // nanoseconds
+};
+
+static const std::array<const char*, Statistics::NUM_OPCODE_CLASSES> s_opcode_names = {
+    {"nop", "load_cp_reg", "load_xf_reg", "load_indx", "call_dl", "load_bp_reg", "draw_primitives",
+     "other"}};
+
+static bool s_active = false;
+static Options s_options;
+static std::vector<FrameResult> s_results;
+static Clock::time_point s_frame_start_time;
+static Statistics::Totals s_frame_start_totals;
+
+static void OnFileLoaded()
+{
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetFrameRangeStart(s_options.frame_start);
+  if (s_options.frame_end != 0)
+    player.SetFrameRangeEnd(s_options.frame_end);
+
+  // BootManager may have reloaded the configuration, so only disable the limiter this late.
+  SConfig::GetInstance().m_EmulationSpeed = 0.0f;
+}
+
+static void OnFrameWritten()
+{
+  s_frame_start_totals = stats.totals;
+  s_frame_start_time = Clock::now();
+}
+
+static void OnFrameFinished()
+{
+  const Clock::time_point end_time = Clock::now();
+
+  FrameResult result;
+  result.frame = FifoPlayer::GetInstance().GetCurrentFrameNum();
+  result.wall_time =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - s_frame_start_time).count();
+  for (size_t i = 0; i < result.opcodes.size(); ++i)
+    result.opcodes[i] = stats.totals.numOpcodes[i] - s_frame_start_totals.numOpcodes[i];
+  result.vertices = stats.totals.numVerticesLoaded - s_frame_start_totals.numVerticesLoaded;
+  result.vertex_loader_time =
+      stats.totals.vertexLoaderTime - s_frame_start_totals.vertexLoaderTime;
+  result.texture_decode_time =
+      stats.totals.textureDecodeTime - s_frame_start_totals.textureDecodeTime;
+  s_results.push_back(result);
+}
+
+static double ToMicroseconds(u64 ns)
+{
+  return ns / 1000.0;
+}
+
+static void WriteCSV(std::ofstream& out)
+{
+  out << "frame,wall_time_us";
+  for (const char* name : s_opcode_names)
+    out << ',' << name;
+  out << ",vertices,vertex_loader_time_us,texture_decode_time_us\n";
+
+  for (const FrameResult& result : s_results)
+  {
+    out << StringFromFormat("%u,%.3f", result.frame, ToMicroseconds(result.wall_time));
+    for (u64 count : result.opcodes)
+      out << ',' << count;
+    out << StringFromFormat(",%llu,%.3f,%.3f\n", static_cast<unsigned long long>(result.vertices),
+                            ToMicroseconds(result.vertex_loader_time),
+                            ToMicroseconds(result.texture_decode_time));
+  }
+}
+
+// Quotes a string for JSON. File names can contain backslashes and quotes.
+static std::string JSONString(const std::string& str)
+{
+  std::string result = "\"";
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+
+    if (static_cast<unsigned char>(c) < 0x20)
+      result += StringFromFormat("\\u%04x", c);
+    else
+      result += c;
+  }
+  return result + '"';
+}
+
+static void WriteJSON(std::ofstream& out)
+{
+  std::vector<u64> frame_times;
+  u64 total_time = 0;
+  for (const FrameResult& result : s_results)
+  {
+    frame_times.push_back(result.wall_time);
+    total_time += result.wall_time;
+  }
+  std::sort(frame_times.begin(), frame_times.end());
+
+  const auto percentile = [&frame_times](size_t p) -> u64 {
+    if (frame_times.empty())
+      return 0;
+    return frame_times[std::min(frame_times.size() - 1, frame_times.size() * p / 100)];
+  };
+  const double mean = frame_times.empty() ? 0.0 : double(total_time) / frame_times.size();
+
+  out << "{\n";
+  out << "  \"file\": " << JSONString(SConfig::GetInstance().m_strFilename) << ",\n";
+  out << "  \"video_backend\": " << JSONString(SConfig::GetInstance().m_strVideoBackend) << ",\n";
+  out << "  \"summary\": {\n";
+  out << StringFromFormat("    \"frames\": %zu,\n", s_results.size());
+  out << StringFromFormat("    \"total_time_us\": %.3f,\n", ToMicroseconds(total_time));
+  out << StringFromFormat("    \"mean_frame_time_us\": %.3f,\n", mean / 1000.0);
+  out << StringFromFormat("    \"min_frame_time_us\": %.3f,\n",
+                          ToMicroseconds(frame_times.empty() ? 0 : frame_times.front()));
+  out << StringFromFormat("    \"median_frame_time_us\": %.3f,\n", ToMicroseconds(percentile(50)));
+  out << StringFromFormat("    \"p95_frame_time_us\": %.3f,\n", ToMicroseconds(percentile(95)));
+  out << StringFromFormat("    \"max_frame_time_us\": %.3f,\n",
+                          ToMicroseconds(frame_times.empty() ? 0 : frame_times.back()));
+  out << StringFromFormat("    \"fps\": %.3f\n", mean > 0.0 ? 1e9 / mean : 0.0);
+  out << "  },\n";
+  out << "  \"frames\": [";
+
+  for (size_t i = 0; i < s_results.size(); ++i)
+  {
+    const FrameResult& result = s_results[i];
+    out << (i == 0 ? "\n" : ",\n");
+    out << StringFromFormat("    {\"frame\": %u, \"wall_time_us\": %.3f, \"opcodes\": {",
+                            result.frame, ToMicroseconds(result.wall_time));
+    for (size_t j = 0; j < result.opcodes.size(); ++j)
+    {
+      out << StringFromFormat("%s\"%s\": %llu", j == 0 ? "" : ", ", s_opcode_names[j],
+                              static_cast<unsigned long long>(result.opcodes[j]));
+    }
+    out << StringFromFormat("}, \"vertices\": %llu, \"vertex_loader_time_us\": %.3f, "
+                            "\"texture_decode_time_us\": %.3f}",
+                            static_cast<unsigned long long>(result.vertices),
+                            ToMicroseconds(result.vertex_loader_time),
+                            ToMicroseconds(result.texture_decode_time));
+  }
+
+  out << "\n  ]\n}\n";
+}
+
+void Start(const Options& options)
+{
+  s_options = options;
+  s_results.clear();
+  s_active = true;
+
+  stats.collectTimings = true;
+
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetLoop(false);
+  player.SetFileLoadedCallback(OnFileLoaded);
+  player.SetFrameWrittenCallback(OnFrameWritten);
+  player.SetFrameFinishedCallback(OnFrameFinished);
+}
+
+bool Finish()
+{
+  if (!s_active)
+    return false;
+
+  s_active = false;
+  stats.collectTimings = false;
+
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetFileLoadedCallback(nullptr);
+  player.SetFrameWrittenCallback(nullptr);
+  player.SetFrameFinishedCallback(nullptr);
+
+  std::ofstream out;
+  OpenFStream(out, s_options.report_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open())
+  {
+    ERROR_LOG(COMMON, "Failed to open FIFO benchmark report %s", s_options.report_path.c_str());
+    return false;
+  }
+
+  std::string extension;
+  SplitPath(s_options.report_path, nullptr, nullptr, &extension);
+  if (extension == ".csv")
+    WriteCSV(out);
+  else
+    WriteJSON(out);
+
+  NOTICE_LOG(COMMON, "FIFO benchmark: %zu frames written to %s", s_results.size(),
+             s_options.report_path.c_str());
+  return out.good();
+}
+
+bool IsActive()
+{
+  return s_active;
+}
+}
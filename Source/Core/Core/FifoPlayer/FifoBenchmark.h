@@ -0,0 +1,33 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+// Replays a FIFO log as fast as possible and records per-frame timings and GPU command counts.
+// Meant to be driven by a headless frontend so that rendering throughput regressions can be
+// caught without a real GPU (i.e. with the Null or Software video backends).
+namespace FifoBenchmark
+{
+struct Options
+{
+  // The report is written as CSV if the path ends in ".csv", and as JSON otherwise.
+  std::string report_path;
+  u32 frame_start = 0;
+  // Exclusive. 0 plays the log up to its last frame.
+  u32 frame_end = 0;
+};
+
+// Must be called before the FIFO log is booted. Installs the FifoPlayer callbacks, disables
+// looping and the frame limiter, and enables timing collection in VideoCommon statistics.
+void Start(const Options& options);
+
+// Uninstalls the callbacks and writes the report. Call once emulation has stopped.
+bool Finish();
+
+bool IsActive();
+}
@@ -150,6 +150,9 @@ CPU::State FifoPlayer::AdvanceFrame()
 
   WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
 
+  if (m_FrameFinishedCb)
+    m_FrameFinishedCb();
+
   ++m_CurrentFrame;
   return CPU::State::Running;
 }
@@ -89,9 +89,15 @@ public:
   // If enabled then all memory updates happen at once before the first frame
   // Default is disabled
   void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+  // Whether playback restarts at the beginning of the frame range once the end is reached
+  // Defaults to SConfig::bLoopFifoReplay
+  void SetLoop(bool enabled) { m_Loop = enabled; }
   // Callbacks
   void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
   void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
+  // Called after a frame has been written and the GPU has gone idle again.
+  // GetCurrentFrameNum() still returns the number of that frame during the callback.
+  void SetFrameFinishedCallback(CallbackFunc callback) { m_FrameFinishedCb = callback; }
   static FifoPlayer& GetInstance();
 
 private:
@@ -150,6 +156,7 @@ private:
 
   CallbackFunc m_FileLoadedCb = nullptr;
   CallbackFunc m_FrameWrittenCb = nullptr;
+  CallbackFunc m_FrameFinishedCb = nullptr;
 
   std::unique_ptr<FifoDataFile> m_File;
 
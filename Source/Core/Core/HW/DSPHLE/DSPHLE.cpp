@@ -71,6 +71,14 @@ u32 DSPHLE::DSP_UpdateRate()
   //}
 }
 
+// The ucode may still be processing on another thread; its results have to be in memory before
+// the CPU reads the DSP state.
+void DSPHLE::FinishPendingWork()
+{
+  if (m_ucode != nullptr)
+    m_ucode->FinishPendingWork();
+}
+
 void DSPHLE::SendMailToDSP(u32 mail)
 {
   if (m_ucode != nullptr)
@@ -108,6 +116,8 @@ void DSPHLE::SwapUCode(u32 crc)
 
 void DSPHLE::DoState(PointerWrap& p)
 {
+  FinishPendingWork();
+
   bool is_hle = true;
   p.Do(is_hle);
   if (!is_hle && p.GetMode() == PointerWrap::MODE_READ)
@@ -157,6 +167,7 @@ u16 DSPHLE::DSP_ReadMailBoxHigh(bool cpu_mailbox)
   }
   else
   {
+    FinishPendingWork();
     return AccessMailHandler().ReadDSPMailboxHigh();
   }
 }
@@ -169,6 +180,7 @@ u16 DSPHLE::DSP_ReadMailBoxLow(bool cpu_mailbox)
   }
   else
   {
+    FinishPendingWork();
     return AccessMailHandler().ReadDSPMailboxLow();
   }
 }
@@ -223,6 +235,7 @@ u16 DSPHLE::DSP_WriteControlRegister(u16 value)
 
 u16 DSPHLE::DSP_ReadControlRegister()
 {
+  FinishPendingWork();
   return m_dsp_control.Hex;
 }
 
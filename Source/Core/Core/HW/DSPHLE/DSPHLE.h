@@ -46,6 +46,7 @@ public:
 
 private:
   void SendMailToDSP(u32 mail);
+  void FinishPendingWork();
 
   // Fake mailbox utility
   struct DSPState
@@ -10,6 +10,9 @@
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
+#include "Common/WorkerPool.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/DSPHLE.h"
 #include "Core/HW/DSPHLE/MailHandler.h"
@@ -25,13 +28,23 @@ namespace HLE
 AXUCode::AXUCode(DSPHLE* dsphle, u32 crc) : UCodeInterface(dsphle, crc), m_cmdlist_size(0)
 {
   INFO_LOG(DSPHLE, "Instantiating AXUCode: crc=%08x", crc);
+
+  if (SConfig::GetInstance().m_DSPHLEThread)
+    m_command_list_worker = std::make_unique<Common::WorkerPool>("AX command lists", 1);
 }
 
 AXUCode::~AXUCode()
 {
+  FinishPendingWork();
   m_mail_handler.Clear();
 }
 
+void AXUCode::FinishPendingWork()
+{
+  if (m_command_list_worker)
+    m_command_list_worker->WaitForIdle();
+}
+
 void AXUCode::Initialize()
 {
   m_mail_handler.PushMail(DSP_INIT, true);
@@ -622,11 +635,27 @@ void AXUCode::HandleMail(u32 mail)
 
   bool set_next_is_cmdlist = false;
 
+  // The previous command list must be done before its buffers are reused.
+  FinishPendingWork();
+
   if (next_is_cmdlist)
   {
     CopyCmdList(mail, cmdlist_size);
-    HandleCommandList();
-    m_cmdlist_size = 0;
+    // The worker accesses guest memory while the CPU thread keeps running, which is not
+    // deterministic. This is checked for every command list, as a movie can start recording
+    // in the middle of a game.
+    if (m_command_list_worker && !Core::WantsDeterminism())
+    {
+      m_command_list_worker->Push([this] {
+        HandleCommandList();
+        m_cmdlist_size = 0;
+      });
+    }
+    else
+    {
+      HandleCommandList();
+      m_cmdlist_size = 0;
+    }
     SignalWorkEnd();
   }
   else if (m_upload_setup_in_progress)
@@ -689,6 +718,8 @@ void AXUCode::Update()
 
 void AXUCode::DoAXState(PointerWrap& p)
 {
+  FinishPendingWork();
+
   p.Do(m_cmdlist);
   p.Do(m_cmdlist_size);
 
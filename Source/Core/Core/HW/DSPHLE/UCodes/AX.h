@@ -12,9 +12,16 @@
 
 #pragma once
 
+#include <memory>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
+namespace Common
+{
+class WorkerPool;
+}
+
 namespace DSP
 {
 namespace HLE
@@ -65,6 +72,7 @@ public:
   void HandleMail(u32 mail) override;
   void Update() override;
   void DoState(PointerWrap& p) override;
+  void FinishPendingWork() override;
 
 protected:
   enum MailType
@@ -99,6 +107,10 @@ protected:
   bool m_coeffs_available;
   s16 m_coeffs[0x800];
 
+  // Runs the command lists off the CPU thread when enabled. Mails are still sent from the CPU
+  // thread, so ucodes which send mails while processing a command list must reset it.
+  std::unique_ptr<Common::WorkerPool> m_command_list_worker;
+
   void LoadResamplingCoefficients();
 
   // Copy a command list from memory to our temp buffer
@@ -12,9 +12,8 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
-
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
@@ -320,6 +319,7 @@ u16 AcceleratorGetSample()
 // (or the srctype will automatically be changed to LINEAR).
 //
 // Returns the current position after resampling (including fractional part).
+// The callback is a template parameter so that the per-sample call can be inlined.
 //
 // The input to output ratio is set in <ratio>, which is a floating point num
 // stored as a 32b integer:
@@ -333,7 +333,13 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
+//
+// Unlike the volume ramps below, this stays scalar. Each input sample comes from the callback,
+// which decodes ADPCM with a running predictor and may jump to the loop start or stop at the
+// end, so the inputs can't be fetched in blocks. That leaves two multiplies per output sample
+// to vectorize, and the polyphase path is disabled anyway.
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count, s16* last_samples,
                   u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
 {
   int read_samples_count = 0;
@@ -467,6 +473,33 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
   pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
+#ifdef _M_X86
+// Returns the volumes of the next 8 samples of a ramp starting at <volume>.
+static inline __m128i VolumeRamp8(u16 volume, u16 volume_delta)
+{
+  const __m128i steps = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm_add_epi16(_mm_set1_epi16(volume),
+                       _mm_mullo_epi16(_mm_set1_epi16(volume_delta), steps));
+}
+
+// Computes Clamp((sample * volume) >> 15, -32767, 32767) for 8 samples, with unsigned volumes.
+static inline __m128i ApplyVolume8(__m128i samples, __m128i volumes)
+{
+  const __m128i lo = _mm_mullo_epi16(samples, volumes);
+  const __m128i hi = _mm_mulhi_epi16(samples, volumes);
+
+  // mulhi treats the volumes as signed; volumes >= 0x8000 need another sample << 16 added.
+  const __m128i fixup = _mm_and_si128(_mm_srai_epi16(volumes, 15), samples);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i product_lo = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpacklo_epi16(zero, fixup));
+  __m128i product_hi = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), _mm_unpackhi_epi16(zero, fixup));
+
+  product_lo = _mm_srai_epi32(product_lo, 15);
+  product_hi = _mm_srai_epi32(product_hi, 15);
+  return _mm_max_epi16(_mm_packs_epi32(product_lo, product_hi), _mm_set1_epi16(-32767));
+}
+#endif
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
@@ -479,7 +512,34 @@ void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ra
   if (!ramp)
     volume_delta = 0;
 
-  for (u32 i = 0; i < count; ++i)
+  u32 i = 0;
+#ifdef _M_X86
+  if (count >= 8)
+  {
+    __m128i volumes = VolumeRamp8(volume, volume_delta);
+    const __m128i volume_step = _mm_set1_epi16(volume_delta * 8);
+    __m128i samples;
+
+    for (; i + 8 <= count; i += 8)
+    {
+      samples = ApplyVolume8(_mm_loadu_si128((const __m128i*)&input[i]), volumes);
+      volumes = _mm_add_epi16(volumes, volume_step);
+
+      // Sign extend to 32 bits before accumulating.
+      __m128i* dst = (__m128i*)&out[i];
+      _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst),
+                                          _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)));
+      _mm_storeu_si128(dst + 1,
+                       _mm_add_epi32(_mm_loadu_si128(dst + 1),
+                                     _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)));
+    }
+
+    volume += volume_delta * i;
+    *dpop = (s16)_mm_extract_epi16(samples, 7);
+  }
+#endif
+
+  for (; i < count; ++i)
   {
     s64 sample = input[i];
     sample *= volume;
@@ -502,6 +562,35 @@ s16 LowPassFilter(s16* samples, u32 count, s16 yn1, u16 a0, u16 b0)
   return yn1;
 }
 
+// Apply a global volume ramp using the volume envelope parameters.
+void ApplyVolumeEnvelope(s16* samples, u32 count, PBVolumeEnvelope& env)
+{
+  u32 i = 0;
+#ifdef _M_X86
+  if (count >= 8)
+  {
+    const u16 volume_delta = env.cur_volume_delta;
+    __m128i volumes = VolumeRamp8(env.cur_volume, volume_delta);
+    const __m128i volume_step = _mm_set1_epi16(volume_delta * 8);
+
+    for (; i + 8 <= count; i += 8)
+    {
+      __m128i* ptr = (__m128i*)&samples[i];
+      _mm_storeu_si128(ptr, ApplyVolume8(_mm_loadu_si128(ptr), volumes));
+      volumes = _mm_add_epi16(volumes, volume_step);
+    }
+
+    env.cur_volume += volume_delta * i;
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    samples[i] = MathUtil::Clamp(((s32)samples[i] * env.cur_volume) >> 15, -32767,
+                                 32767);  // -32768 ?
+    env.cur_volume += env.cur_volume_delta;
+  }
+}
+
 // Process 1ms of audio (for AX GC) or 3ms of audio (for AX Wii) from a PB and
 // mix it to the output buffers.
 void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl mctrl,
@@ -516,12 +605,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
   GetInputSamples(pb, samples, count, coeffs);
 
   // Apply a global volume ramp using the volume envelope parameters.
-  for (u32 i = 0; i < count; ++i)
-  {
-    samples[i] = MathUtil::Clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-                                 32767);  // -32768 ?
-    pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-  }
+  ApplyVolumeEnvelope(samples, count, pb.vol_env);
 
   // Optionally, execute a low pass filter
   // TODO: LPF code is currently broken, causing Super Monkey Ball sound
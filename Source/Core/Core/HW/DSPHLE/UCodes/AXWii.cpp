@@ -11,6 +11,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
+#include "Common/WorkerPool.h"
 #include "Core/HW/DSPHLE/DSPHLE.h"
 #include "Core/HW/DSPHLE/MailHandler.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
@@ -29,6 +30,10 @@ AXWiiUCode::AXWiiUCode(DSPHLE* dsphle, u32 crc) : AXUCode(dsphle, crc), m_last_m
   INFO_LOG(DSPHLE, "Instantiating AXWiiUCode");
 
   m_old_axwii = (crc == 0xfa450138);
+
+  // OutputSamples sends DSP_SYNC in the middle of the command list, which has to happen on the
+  // CPU thread.
+  m_command_list_worker.reset();
 }
 
 AXWiiUCode::~AXWiiUCode()
@@ -50,6 +50,8 @@ public:
   virtual void Update() = 0;
 
   virtual void DoState(PointerWrap& p) { DoStateShared(p); }
+  // Waits for work the ucode runs off the CPU thread, before the CPU can observe its results.
+  virtual void FinishPendingWork() {}
   static u32 GetCRC(UCodeInterface* ucode) { return ucode ? ucode->m_crc : UCODE_NULL; }
 protected:
   void PrepareBootUCode(u32 mail);
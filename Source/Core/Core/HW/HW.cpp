@@ -23,6 +23,7 @@
 #include "Core/HW/WII_IPC.h"
 #include "Core/IOS/IOS.h"
 #include "Core/Movie.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 namespace HW
@@ -69,6 +70,7 @@ void Shutdown()
   SerialInterface::Shutdown();
   AudioInterface::Shutdown();
 
+  Rewind::Shutdown();
   State::Shutdown();
   CoreTiming::Shutdown();
 }
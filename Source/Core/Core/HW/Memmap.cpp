@@ -7,13 +7,18 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/ARBruteForcer.h"
 #include "Core/ConfigManager.h"
@@ -113,6 +118,7 @@ struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  u32 physical_address;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -164,6 +170,265 @@ static PhysicalMemoryRegion physical_regions[] = {
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
 
+// Write tracking works on 4 KiB pages of RAM and EXRAM. Every page write protected by TrackWrites
+// stays so until it is written, at which point it gets stamped with the next sequence number.
+// Tokens are sequence numbers as well, so a range is unchanged as long as none of its pages has a
+// newer stamp than the token.
+static const u32 TRACKING_PAGE_SHIFT = 12;
+static const u32 TRACKING_PAGE_SIZE = 1 << TRACKING_PAGE_SHIFT;
+static const u32 RAM_TRACKING_PAGES = RAM_SIZE >> TRACKING_PAGE_SHIFT;
+static const u32 TRACKING_PAGES = RAM_TRACKING_PAGES + (EXRAM_SIZE >> TRACKING_PAGE_SHIFT);
+
+// Serializes TrackWrites and the other functions that change the protection of whole pages, and
+// guards the logical views. The fault handler can't take it, so it only ever clears bits of
+// s_page_protected and changes the protection of the page that faulted.
+static std::mutex s_tracking_mutex;
+static std::array<std::atomic<u32>, TRACKING_PAGES / 32> s_page_protected;
+static std::array<std::atomic<u64>, TRACKING_PAGES> s_page_stamps;
+static std::atomic<u64> s_write_sequence{1};
+static std::atomic<bool> s_tracking_used{false};
+
+static bool IsPageProtected(u32 page)
+{
+  return (s_page_protected[page / 32].load() & (1u << (page % 32))) != 0;
+}
+
+static void SetPageProtected(u32 page)
+{
+  s_page_protected[page / 32].fetch_or(1u << (page % 32));
+}
+
+// Returns whether the page was marked as protected.
+static bool ClearPageProtected(u32 page)
+{
+  const u32 bit = 1u << (page % 32);
+  return (s_page_protected[page / 32].fetch_and(~bit) & bit) != 0;
+}
+
+// Strict, so that faults in the mirrors or in unmapped space are never taken for tracked writes.
+static bool GetTrackingPage(u32 physical_address, u32* page)
+{
+  if (physical_address < REALRAM_SIZE)
+  {
+    *page = physical_address >> TRACKING_PAGE_SHIFT;
+    return true;
+  }
+  if (m_pEXRAM && physical_address >= 0x10000000 && physical_address - 0x10000000 < EXRAM_SIZE)
+  {
+    *page = RAM_TRACKING_PAGES + ((physical_address - 0x10000000) >> TRACKING_PAGE_SHIFT);
+    return true;
+  }
+  return false;
+}
+
+static u32 GetTrackingPageAddress(u32 page)
+{
+  if (page < RAM_TRACKING_PAGES)
+    return page << TRACKING_PAGE_SHIFT;
+  return 0x10000000 + ((page - RAM_TRACKING_PAGES) << TRACKING_PAGE_SHIFT);
+}
+
+// Changes the protection of a run of pages in every view of them.
+static void SetTrackingProtection(u32 first_page, u32 count, bool write_protect)
+{
+  const u32 start = GetTrackingPageAddress(first_page);
+  const u32 size = count << TRACKING_PAGE_SHIFT;
+  const auto protect = [write_protect](u8* pointer, u32 protect_size) {
+    if (write_protect)
+      Common::WriteProtectMemory(pointer, protect_size);
+    else
+      Common::UnWriteProtectMemory(pointer, protect_size);
+  };
+
+  protect(physical_base + start, size);
+  for (const LogicalMemoryView& view : logical_mapped_entries)
+  {
+    const u32 intersection_start = std::max(start, view.physical_address);
+    const u32 intersection_end = std::min(start + size, view.physical_address + view.mapped_size);
+    if (intersection_start < intersection_end)
+    {
+      protect(static_cast<u8*>(view.mapped_pointer) + intersection_start - view.physical_address,
+              intersection_end - intersection_start);
+    }
+  }
+}
+
+// Makes the pages of the range writable again and marks them as written. Called with
+// s_tracking_mutex held.
+static void MarkPagesWritten(u32 first_page, u32 end_page)
+{
+  u32 page = first_page;
+  while (page < end_page)
+  {
+    if (!IsPageProtected(page))
+    {
+      ++page;
+      continue;
+    }
+
+    u32 run_end = page;
+    while (run_end < end_page && IsPageProtected(run_end))
+      ClearPageProtected(run_end++);
+
+    // Stamped first, as writes from other threads can go through as soon as the page is writable.
+    const u64 stamp = s_write_sequence++;
+    for (u32 i = page; i < run_end; ++i)
+      s_page_stamps[i] = stamp;
+    SetTrackingProtection(page, run_end - page, false);
+    page = run_end;
+  }
+}
+
+// For when memory gets replaced wholesale, or the views of it change.
+static void InvalidateWriteTracking()
+{
+  if (!s_tracking_used)
+    return;
+
+  std::lock_guard<std::mutex> lk(s_tracking_mutex);
+  MarkPagesWritten(0, TRACKING_PAGES);
+}
+
+// Saves a fault for every page when writes are made through the functions below.
+static void MarkRangeWritten(u32 address, size_t size)
+{
+  if (!s_tracking_used || size == 0)
+    return;
+
+  u32 first_page, last_page;
+  address &= 0x3FFFFFFF;
+  if (!GetTrackingPage(address, &first_page) ||
+      !GetTrackingPage(address + u32(size) - 1, &last_page))
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(s_tracking_mutex);
+  MarkPagesWritten(first_page, last_page + 1);
+}
+
+bool IsWriteTrackingAvailable()
+{
+#if !defined(_ARCH_32) && (defined(_WIN32) || (defined(__linux__) && !defined(_M_GENERIC)))
+  // The Mach exception handler on macOS only sees faults from the CPU thread.
+  return SConfig::GetInstance().bFastmem && physical_base &&
+         Common::GetPageSize() == TRACKING_PAGE_SIZE;
+#else
+  return false;
+#endif
+}
+
+u64 TrackWrites(u32 address, size_t size)
+{
+  if (size == 0 || !IsWriteTrackingAvailable())
+    return 0;
+
+  u32 first_page, last_page;
+  address &= 0x3FFFFFFF;
+  if (!GetTrackingPage(address, &first_page) ||
+      !GetTrackingPage(address + u32(size) - 1, &last_page) ||
+      GetTrackingPageAddress(last_page) - GetTrackingPageAddress(first_page) !=
+          (last_page - first_page) << TRACKING_PAGE_SHIFT)
+  {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lk(s_tracking_mutex);
+  s_tracking_used = true;
+
+  u32 page = first_page;
+  while (page <= last_page)
+  {
+    if (IsPageProtected(page))
+    {
+      ++page;
+      continue;
+    }
+
+    const u32 run_start = page;
+    while (page <= last_page && !IsPageProtected(page))
+      SetPageProtected(page++);
+    SetTrackingProtection(run_start, page - run_start, true);
+  }
+
+  // Any write from now on faults, and gets a newer stamp than the token.
+  return s_write_sequence++;
+}
+
+bool HasBeenWritten(u32 address, size_t size, u64 token)
+{
+  u32 first_page, last_page;
+  address &= 0x3FFFFFFF;
+  if (token == 0 || size == 0 || !GetTrackingPage(address, &first_page) ||
+      !GetTrackingPage(address + u32(size) - 1, &last_page))
+  {
+    return true;
+  }
+
+  for (u32 page = first_page; page <= last_page; ++page)
+  {
+    if (s_page_stamps[page] > token)
+      return true;
+  }
+  return false;
+}
+
+bool HandleWriteTrackingFault(uintptr_t host_address)
+{
+  if (!s_tracking_used)
+    return false;
+
+  u32 physical_address;
+  const uintptr_t physical_offset = host_address - reinterpret_cast<uintptr_t>(physical_base);
+  const uintptr_t logical_offset = host_address - reinterpret_cast<uintptr_t>(logical_base);
+  if (physical_base && physical_offset < 0x100000000)
+  {
+    physical_address = static_cast<u32>(physical_offset);
+  }
+  else if (logical_base && logical_offset < 0x100000000)
+  {
+    // Only the CPU thread accesses memory through the logical views, and it is also the only
+    // thread which changes them, so they can't change under our feet here.
+    bool found = false;
+    for (const LogicalMemoryView& view : logical_mapped_entries)
+    {
+      const uintptr_t view_offset = host_address - reinterpret_cast<uintptr_t>(view.mapped_pointer);
+      if (view_offset < view.mapped_size)
+      {
+        physical_address = view.physical_address + static_cast<u32>(view_offset);
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      return false;
+  }
+  else
+  {
+    return false;
+  }
+
+  u32 page;
+  if (!GetTrackingPage(physical_address, &page))
+    return false;
+
+  // Stamped first, as writes from other threads can go through as soon as the page is writable.
+  // If the page isn't marked as protected anymore, it was already written through another view
+  // or by another thread, and only this view is left to be made writable.
+  if (ClearPageProtected(page))
+    s_page_stamps[page] = s_write_sequence++;
+
+  // Only the page that faulted is made writable, as the list of views can't be walked without
+  // s_tracking_mutex. The other views get made writable by their own faults.
+  u8* host_page = reinterpret_cast<u8*>(host_address & ~uintptr_t(TRACKING_PAGE_SIZE - 1));
+  Common::UnWriteProtectMemory(host_page, TRACKING_PAGE_SIZE);
+
+  // TrackWrites may have protected the page again since, and that must not be undone.
+  if (IsPageProtected(page))
+    Common::WriteProtectMemory(host_page, TRACKING_PAGE_SIZE);
+  return true;
+}
+
 void Init()
 {
   bool wii = SConfig::GetInstance().bWii;
@@ -218,12 +483,19 @@ void Init()
 
   Clear();
 
+  // Tokens handed out before aren't valid for the new memory.
+  const u64 stamp = s_write_sequence++;
+  for (std::atomic<u64>& page_stamp : s_page_stamps)
+    page_stamp = stamp;
+
   INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p", m_pRAM);
   m_IsInitialized = true;
 }
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
+  std::lock_guard<std::mutex> lk(s_tracking_mutex);
+
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
@@ -256,16 +528,34 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
             exit(0);
           }
-          logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+          logical_mapped_entries.push_back({mapped_pointer, mapped_size, intersection_start});
         }
       }
     }
   }
+
+  // The new views start out writable.
+  if (s_tracking_used)
+  {
+    u32 page = 0;
+    while (page < TRACKING_PAGES)
+    {
+      const u32 run_start = page;
+      while (page < TRACKING_PAGES && IsPageProtected(page))
+        ++page;
+      if (page != run_start)
+        SetTrackingProtection(run_start, page - run_start, true);
+      else
+        ++page;
+    }
+  }
 }
 
 void DoState(PointerWrap& p)
 {
   bool wii = SConfig::GetInstance().bWii;
+  if (p.GetMode() == PointerWrap::MODE_READ)
+    InvalidateWriteTracking();
   p.DoArray(m_pRAM, RAM_SIZE);
   p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
   p.DoMarker("Memory RAM");
@@ -280,6 +570,8 @@ void DoState(PointerWrap& p)
 void Shutdown()
 {
   m_IsInitialized = false;
+  InvalidateWriteTracking();
+  s_tracking_used = false;
   u32 flags = 0;
   if (SConfig::GetInstance().bWii)
     flags |= PhysicalMemoryRegion::WII_ONLY;
@@ -306,6 +598,7 @@ void Shutdown()
 
 void Clear()
 {
+  InvalidateWriteTracking();
   if (m_pRAM)
     memset(m_pRAM, 0, RAM_SIZE);
   if (m_pL1Cache)
@@ -355,6 +648,7 @@ void CopyToEmu(u32 address, const void* data, size_t size)
     PanicAlert("Invalid range in CopyToEmu. %zx bytes to 0x%08x", size, address);
     return;
   }
+  MarkRangeWritten(address, size);
   memcpy(pointer, data, size);
 }
 
@@ -369,6 +663,7 @@ void Memset(u32 address, u8 value, size_t size)
     PanicAlert("Invalid range in Memset. %zx bytes at 0x%08x", size, address);
     return;
   }
+  MarkRangeWritten(address, size);
   memset(pointer, value, size);
 }
 
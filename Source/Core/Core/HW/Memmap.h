@@ -86,6 +86,18 @@ void Write_U64(u64 var, u32 address);
 void Write_U32_Swap(u32 var, u32 address);
 void Write_U64_Swap(u64 var, u32 address);
 
+// Write tracking, for caches of data derived from RAM. Tracked pages are write protected, so that
+// the first write to them afterwards is caught by the fastmem fault handler, whichever thread or
+// view it comes from. Only available while fastmem is enabled.
+bool IsWriteTrackingAvailable();
+// Starts tracking the range. Returns a token for HasBeenWritten, or 0 if the range can't be
+// tracked.
+u64 TrackWrites(u32 address, size_t size);
+// Whether the range may have been written since TrackWrites returned the token.
+bool HasBeenWritten(u32 address, size_t size, u64 token);
+// Called by the fault handler. Returns true if the fault was a write to a tracked page.
+bool HandleWriteTrackingFault(uintptr_t host_address);
+
 // Templated functions for byteswapped copies.
 template <typename T>
 void CopyFromEmuSwapped(T* data, u32 address, size_t size)
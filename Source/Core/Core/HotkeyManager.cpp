@@ -134,6 +134,7 @@ const std::string hotkey_labels[] = {
     _trans("Undo Save State"),
     _trans("Save State"),
     _trans("Load State"),
+    _trans("Rewind"),
     _trans("Permanent Camera Forward"),
     _trans("Permanent Camera Backward"),
     _trans("Less Units Per Metre"),
@@ -263,7 +264,7 @@ const std::array<HotkeyGroupInfo, NUM_HOTKEY_GROUPS> groups_info = {
      {_trans("Save state"), HK_SAVE_STATE_SLOT_1, HK_SAVE_STATE_SLOT_SELECTED},
      {_trans("Select state"), HK_SELECT_STATE_SLOT_1, HK_SELECT_STATE_SLOT_10},
      {_trans("Load last state"), HK_LOAD_LAST_STATE_1, HK_LOAD_LAST_STATE_10},
-     {_trans("Other state hotkeys"), HK_SAVE_FIRST_STATE, HK_LOAD_STATE_FILE},
+     {_trans("Other state hotkeys"), HK_SAVE_FIRST_STATE, HK_REWIND},
      {_trans("VR Camera"), VR_PERMANENT_CAMERA_FORWARD, VR_CAMERA_TILT_DOWN },
      {_trans("VR HUD"), VR_HUD_FORWARD, VR_HUD_3D_FURTHER },
      {_trans("VR 2D Screen"), VR_2D_SCREEN_LARGER, VR_2D_SCREEN_THINNER },
@@ -148,6 +148,7 @@ enum Hotkey
   HK_UNDO_SAVE_STATE,
   HK_SAVE_STATE_FILE,
   HK_LOAD_STATE_FILE,
+  HK_REWIND,
 
   VR_PERMANENT_CAMERA_FORWARD,
   VR_PERMANENT_CAMERA_BACKWARD,
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "Common/Assert.h"
 #include "Common/ChunkFile.h"
@@ -218,8 +219,12 @@ IPCCommandResult FileIO::Read(const ReadWriteRequest& request)
   DEBUG_LOG(IOS_FILEIO, "Read 0x%x bytes to 0x%08x from %s", request.size, request.buffer,
             m_name.c_str());
   m_file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we read
+  // Not read straight into RAM, as the host can't write to pages protected by
+  // Memory::TrackWrites.
+  std::vector<u8> buffer(requested_read_length);
   const u32 number_of_bytes_read = static_cast<u32>(
-      fread(Memory::GetPointer(request.buffer), 1, requested_read_length, m_file->GetHandle()));
+      fread(buffer.data(), 1, requested_read_length, m_file->GetHandle()));
+  Memory::CopyToEmu(request.buffer, buffer.data(), number_of_bytes_read);
 
   if (number_of_bytes_read != requested_read_length && ferror(m_file->GetHandle()))
     return GetDefaultReply(FS_EACCESS);
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <vector>
 #include <mbedtls/error.h>
 #ifndef _WIN32
 #include <arpa/inet.h>
@@ -523,8 +524,9 @@ void WiiSocket::Update(bool read, bool write, bool except)
         case IOCTLV_SO_RECVFROM:
         {
           u32 flags = Memory::Read_U32(BufferIn + 0x04);
-          // Not a string, Windows requires a char* for recvfrom
-          char* data = (char*)Memory::GetPointer(BufferOut);
+          // Not a string, Windows requires a char* for recvfrom. Not received straight into RAM,
+          // as the host can't write to pages protected by Memory::TrackWrites.
+          std::vector<char> data(BufferOutSize);
           int data_len = BufferOutSize;
 
           sockaddr_in local_name;
@@ -551,7 +553,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
           }
 #endif
           socklen_t addrlen = sizeof(sockaddr_in);
-          int ret = recvfrom(fd, data, data_len, flags,
+          int ret = recvfrom(fd, data.data(), data_len, flags,
                              BufferOutSize2 ? (struct sockaddr*)&local_name : nullptr,
                              BufferOutSize2 ? &addrlen : nullptr);
           ReturnValue =
@@ -560,9 +562,12 @@ void WiiSocket::Update(bool read, bool write, bool except)
           INFO_LOG(IOS_NET, "%s(%d, %p) Socket: %08X, Flags: %08X, "
                             "BufferIn: (%08x, %i), BufferIn2: (%08x, %i), "
                             "BufferOut: (%08x, %i), BufferOut2: (%08x, %i)",
-                   BufferOutSize2 ? "IOCTLV_SO_RECVFROM " : "IOCTLV_SO_RECV ", ReturnValue, data,
-                   wii_fd, flags, BufferIn, BufferInSize, BufferIn2, BufferInSize2, BufferOut,
-                   BufferOutSize, BufferOut2, BufferOutSize2);
+                   BufferOutSize2 ? "IOCTLV_SO_RECVFROM " : "IOCTLV_SO_RECV ", ReturnValue,
+                   data.data(), wii_fd, flags, BufferIn, BufferInSize, BufferIn2, BufferInSize2,
+                   BufferOut, BufferOutSize, BufferOut2, BufferOutSize2);
+
+          if (ret > 0)
+            Memory::CopyToEmu(BufferOut, data.data(), ret);
 
           if (BufferOutSize2 != 0)
           {
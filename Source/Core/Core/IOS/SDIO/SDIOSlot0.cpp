@@ -247,8 +247,12 @@ u32 SDIOSlot0::ExecuteCommand(const Request& request, u32 _BufferIn, u32 _Buffer
       if (!m_Card.Seek(req.arg, SEEK_SET))
         ERROR_LOG(IOS_SD, "Seek failed WTF");
 
-      if (m_Card.ReadBytes(Memory::GetPointer(req.addr), size))
+      // Not read straight into RAM, as the host can't write to pages protected by
+      // Memory::TrackWrites.
+      std::vector<u8> buffer(size);
+      if (m_Card.ReadBytes(buffer.data(), size))
       {
+        Memory::CopyToEmu(req.addr, buffer.data(), size);
         DEBUG_LOG(IOS_SD, "Outbuffer size %i got %i", _rwBufferSize, size);
       }
       else
@@ -138,12 +138,16 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
       break;
     }
 
+    // Not read straight into RAM, as the host can't write to pages protected by
+    // Memory::TrackWrites.
+    std::vector<u8> buffer(size);
     size_t read_bytes;
-    if (!fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes))
+    if (!fd_obj->file.ReadArray(buffer.data(), size, &read_bytes))
     {
       return_error_code = -1;  // TODO(wfs): proper error code.
       break;
     }
+    Memory::CopyToEmu(addr, buffer.data(), read_bytes);
     fd_obj->position += read_bytes;
 
     INFO_LOG(IOS, "IOCTL_WFS_READ: read %zd bytes from FD %d (%s)", read_bytes, fd,
@@ -14,6 +14,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
+#include "Core/HW/Memmap.h"
 #include "Core/MachineContext.h"
 #include "Core/PowerPC/JitInterface.h"
 
@@ -44,6 +45,9 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
     uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
     CONTEXT* ctx = pPtrs->ContextRecord;
 
+    if (accessType == 1 && Memory::HandleWriteTrackingFault(badAddress))
+      return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
+
     if (JitInterface::HandleFault(badAddress, ctx))
     {
       return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
@@ -254,6 +258,10 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 #else
   mcontext_t* ctx = &context->uc_mcontext;
 #endif
+  // Writes to pages protected by Memory::TrackWrites just need to be let through.
+  if (Memory::HandleWriteTrackingFault(bad_address))
+    return;
+
   // assume it's not a write
   if (!JitInterface::HandleFault(bad_address,
 #ifdef __APPLE__
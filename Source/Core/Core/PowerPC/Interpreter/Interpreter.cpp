@@ -197,6 +197,16 @@ int Interpreter::SingleStepInner()
   return opinfo->numCycles;
 }
 
+int Interpreter::SingleStepBlock()
+{
+  m_end_block = false;
+
+  int cycles = 0;
+  while (!m_end_block)
+    cycles += SingleStepInner();
+  return cycles;
+}
+
 void Interpreter::SingleStep()
 {
   // Declare start of new slice
@@ -295,16 +305,7 @@ void Interpreter::Run()
     {
       // "fast" version of inner loop. well, it's not so fast.
       while (PowerPC::ppcState.downcount > 0)
-      {
-        m_end_block = false;
-
-        int cycles = 0;
-        while (!m_end_block)
-        {
-          cycles += SingleStepInner();
-        }
-        PowerPC::ppcState.downcount -= cycles;
-      }
+        PowerPC::ppcState.downcount -= SingleStepBlock();
     }
   }
 }
@@ -17,6 +17,8 @@ public:
   void Shutdown() override;
   void SingleStep() override;
   int SingleStepInner();
+  // Executes instructions up to the end of the current block and returns the cycles they took.
+  int SingleStepBlock();
 
   void Run() override;
   void ClearCache() override;
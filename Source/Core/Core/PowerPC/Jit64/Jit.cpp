@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -17,6 +18,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Common/x64ABI.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -24,7 +26,10 @@
 #include "Core/HW/CPU.h"
 #include "Core/HW/GPFifo.h"
 #include "Core/HW/ProcessorInterface.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "Core/PatchEngine.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/FarCodeCache.h"
@@ -143,6 +148,10 @@ enum
   GUARD_OFFSET = STACK_SIZE - SAFE_STACK_SIZE - GUARD_SIZE,
 };
 
+// How many unconditional branches are inlined into blocks that were recompiled because they
+// became hot (see SConfig::iJITTier2Threshold), instead of the analyzer's default.
+constexpr u32 TIER2_BRANCH_FOLLOW_LIMIT = 8;
+
 void Jit64::AllocStack()
 {
 #ifndef _WIN32
@@ -177,6 +186,12 @@ bool Jit64::HandleStackFault()
   if (!m_enable_blr_optimization || !Core::IsCPUThread())
     return false;
 
+  // Invalidating the blocks can't overlap with a background compile. Without the compile thread
+  // there is nothing to wait for, so don't take a lock in the fault handler at all.
+  std::unique_lock<std::mutex> lock(cache_mutex, std::defer_lock);
+  if (m_compile_thread.joinable())
+    lock.lock();
+
   WARN_LOG(POWERPC, "BLR cache disabled due to excessive BL in the emulated program.");
   m_enable_blr_optimization = false;
 #ifndef _WIN32
@@ -254,6 +269,16 @@ void Jit64::Init()
   code_block.m_gpa = &js.gpa;
   code_block.m_fpa = &js.fpa;
   EnableOptimization();
+
+  // Compiling on another thread relies on the block cache never being bypassed, and on the code a
+  // block was compiled from being checkable without side effects before it is linked. When a
+  // block gets linked depends on host timing, so movies and netplay always compile synchronously.
+  const SConfig& config = SConfig::GetInstance();
+  if (config.bJITBackgroundCompile && !config.bJITNoBlockCache && !config.bEnableDebugging &&
+      !config.bMMU && !Movie::IsMovieActive() && !NetPlay::IsNetPlayRunning())
+  {
+    StartCompileThread();
+  }
 }
 
 void Jit64::ClearCache()
@@ -265,16 +290,31 @@ void Jit64::ClearCache()
   ClearCodeSpace();
   Clear();
   UpdateMemoryOptions();
+
+  // Blocks compiled in the background may reference code that was just thrown away.
+  if (!m_compiled_blocks.empty())
+  {
+    std::lock_guard<std::mutex> lk(m_compile_queue_mutex);
+    for (const CompiledBlock& compiled : m_compiled_blocks)
+      m_queued_addresses.erase(compiled.request.address);
+    m_compile_stats.blocks_discarded += m_compiled_blocks.size();
+  }
+  m_compiled_blocks.clear();
+  m_clear_requested = false;
 }
 
 void Jit64::Shutdown()
 {
+  StopCompileThread();
+
   FreeStack();
   FreeCodeSpace();
 
   blocks.Shutdown();
   m_far_code.Shutdown();
   m_const_pool.Shutdown();
+
+  m_persistent_cache.Close();
 }
 
 void Jit64::FallBackToInterpreter(UGeckoInstruction inst)
@@ -548,6 +588,12 @@ void Jit64::Trace()
 
 void Jit64::Jit(u32 em_address)
 {
+  if (m_compile_thread.joinable())
+  {
+    JitInBackground(em_address);
+    return;
+  }
+
   if (m_cleanup_after_stackfault)
   {
     ClearCache();
@@ -558,9 +604,12 @@ void Jit64::Jit(u32 em_address)
 #endif
   }
 
+  UpdatePersistentCache();
+
   if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull() ||
       SConfig::GetInstance().bJITNoBlockCache)
   {
+    m_precompile_disabled = m_persistent_cache.IsOpen();
     ClearCache();
   }
 
@@ -591,10 +640,7 @@ void Jit64::Jit(u32 em_address)
     }
   }
 
-  // Analyze the block, collect all instructions it is made of (including inlining,
-  // if that is enabled), reorder instructions for optimal performance, and join joinable
-  // instructions.
-  u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, blockSize);
+  u32 nextPC = AnalyzeBlock(em_address, blockSize);
 
   if (code_block.m_memory_exception)
   {
@@ -608,7 +654,278 @@ void Jit64::Jit(u32 em_address)
 
   JitBlock* b = blocks.AllocateBlock(em_address);
   DoJit(em_address, &code_buffer, b, nextPC);
+  CommitBackPatchInfo(TakeEmittedBackPatchInfo());
   blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+
+  // Blocks are still recorded without a compile thread, but only warmed up with one.
+  if (m_persistent_cache.IsOpen() && m_persistent_cache.RecordBlock(*b))
+    m_precompile_requested = true;
+}
+
+u32 Jit64::AnalyzeBlock(u32 em_address, u32 block_size)
+{
+  // Hot blocks get recompiled with more branches inlined, so that code which was previously
+  // reached through block links shares one register allocation and constant state.
+  const bool is_hot = js.hotBlockAddresses.find(em_address) != js.hotBlockAddresses.end();
+  if (is_hot)
+    analyzer.SetBranchFollowLimit(TIER2_BRANCH_FOLLOW_LIMIT);
+
+  // Analyze the block, collect all instructions it is made of (including inlining,
+  // if that is enabled), reorder instructions for optimal performance, and join joinable
+  // instructions.
+  const u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, block_size);
+
+  if (is_hot)
+    analyzer.SetBranchFollowLimit(PPCAnalyst::PPCAnalyzer::DEFAULT_BRANCH_FOLLOW_LIMIT);
+
+  return nextPC;
+}
+
+void Jit64::UpdatePersistentCache()
+{
+  const SConfig& config = SConfig::GetInstance();
+  if (!config.bJITPersistentCache || config.bJITNoBlockCache || config.bEnableDebugging)
+  {
+    m_persistent_cache.Close();
+    return;
+  }
+
+  // The game ID is only known once the game has booted, and changes when a Wii title launches
+  // another one.
+  if (m_persistent_cache.GetGameID() != config.GetGameID())
+  {
+    m_persistent_cache.Open(config.GetGameID());
+    m_precompile_requested = m_persistent_cache.IsOpen();
+    m_precompile_disabled = false;
+  }
+}
+
+void Jit64::PrecompilePersistentBlocks()
+{
+  // This only queues the remembered addresses, the compile thread picks them up like any other
+  // request, so the CPU thread never stalls on blocks it hasn't reached yet.
+  m_precompile_requested = false;
+  for (u32 address :
+       m_persistent_cache.TakeBlocksToPrecompile(MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK))
+  {
+    if (!blocks.GetBlockFromStartAddress(address, MSR))
+      QueueCompile(address);
+  }
+}
+
+void Jit64::StartCompileThread()
+{
+  m_compile_thread_exit = false;
+  m_compile_stats = {};
+  m_compile_thread = std::thread(&Jit64::CompileThread, this);
+}
+
+void Jit64::StopCompileThread()
+{
+  if (!m_compile_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lk(m_compile_queue_mutex);
+    m_compile_thread_exit = true;
+  }
+  m_compile_queue_changed.notify_one();
+  m_compile_thread.join();
+
+  const BackgroundCompileStats stats = GetBackgroundCompileStats();
+  NOTICE_LOG(DYNA_REC, "Background JIT: %llu blocks compiled, %llu discarded, max queue depth %zu, "
+                       "latency avg %llu us max %llu us",
+             static_cast<unsigned long long>(stats.blocks_compiled),
+             static_cast<unsigned long long>(stats.blocks_discarded), stats.max_queue_depth,
+             static_cast<unsigned long long>(
+                 stats.blocks_compiled ? stats.total_latency / stats.blocks_compiled : 0),
+             static_cast<unsigned long long>(stats.max_latency));
+
+  m_compile_queue.clear();
+  m_queued_addresses.clear();
+  m_compiled_blocks.clear();
+}
+
+Jit64::BackgroundCompileStats Jit64::GetBackgroundCompileStats()
+{
+  std::lock_guard<std::mutex> lk(m_compile_queue_mutex);
+  return m_compile_stats;
+}
+
+void Jit64::CompileThread()
+{
+  Common::SetCurrentThreadName("JIT compiler");
+
+  std::unique_lock<std::mutex> queue_lock(m_compile_queue_mutex);
+  while (true)
+  {
+    m_compile_queue_changed.wait(
+        queue_lock, [this] { return m_compile_thread_exit || !m_compile_queue.empty(); });
+    if (m_compile_thread_exit)
+      return;
+
+    const CompileRequest request = m_compile_queue.front();
+    m_compile_queue.pop_front();
+    m_compile_stats.queue_depth = m_compile_queue.size();
+    queue_lock.unlock();
+
+    bool compiled;
+    {
+      std::lock_guard<std::mutex> lk(cache_mutex);
+      compiled = CompileDetached(request);
+    }
+
+    queue_lock.lock();
+    if (!compiled)
+      m_queued_addresses.erase(request.address);
+  }
+}
+
+bool Jit64::CompileDetached(const CompileRequest& request)
+{
+  if (m_clear_requested)
+    return false;
+
+  // The trampolines are only checked on the CPU thread, as the fault handler emits those.
+  if (IsAlmostFull() || m_far_code.IsAlmostFull())
+  {
+    // The CPU thread may be running any of the existing code, so only it can clear the cache.
+    m_clear_requested = true;
+    return false;
+  }
+
+  // MSR and memory can change under our feet while the CPU thread keeps running. Anything that
+  // did is caught in IsStillValid() before the block is used.
+  const u32 nextPC = AnalyzeBlock(request.address, code_buffer.GetSize());
+  if (code_block.m_memory_exception)
+    return false;
+
+  CompiledBlock compiled;
+  compiled.request = request;
+  compiled.block = blocks.AllocateDetachedBlock(request.address);
+  DoJit(request.address, &code_buffer, compiled.block.get(), nextPC);
+  compiled.back_patch_info = TakeEmittedBackPatchInfo();
+  compiled.physical_addresses = code_block.m_physical_addresses;
+  compiled.instructions.reserve(code_block.m_num_instructions);
+  for (u32 i = 0; i < code_block.m_num_instructions; ++i)
+    compiled.instructions.emplace_back(code_buffer.codebuffer[i].address,
+                                       code_buffer.codebuffer[i].inst.hex);
+
+  m_compiled_blocks.push_back(std::move(compiled));
+  return true;
+}
+
+void Jit64::JitInBackground(u32 em_address)
+{
+  {
+    // Never wait for the compile thread; interpreting the block is cheaper than that.
+    std::unique_lock<std::mutex> lk(cache_mutex, std::try_to_lock);
+    if (lk.owns_lock())
+    {
+      if (m_cleanup_after_stackfault)
+      {
+        ClearCache();
+        m_cleanup_after_stackfault = false;
+#ifdef _WIN32
+        // The stack is in an invalid state with no guard page, reset it.
+        _resetstkoflw();
+#endif
+      }
+      else if (m_clear_requested || trampolines.IsAlmostFull())
+      {
+        m_precompile_disabled = m_persistent_cache.IsOpen();
+        ClearCache();
+      }
+
+      UpdatePersistentCache();
+      LinkCompiledBlocks();
+      if (m_persistent_cache.IsOpen() && m_precompile_requested && !m_precompile_disabled)
+        PrecompilePersistentBlocks();
+
+      if (blocks.GetBlockFromStartAddress(em_address, MSR))
+        return;
+    }
+  }
+
+  QueueCompile(em_address);
+
+  // The dispatcher goes to the timing code if this uses up the remaining downcount.
+  PowerPC::ppcState.downcount -= Interpreter::getInstance()->SingleStepBlock();
+}
+
+void Jit64::QueueCompile(u32 em_address)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_compile_queue_mutex);
+    if (!m_queued_addresses.insert(em_address).second)
+      return;
+
+    m_compile_queue.push_back({em_address, CompileClock::now()});
+    m_compile_stats.queue_depth = m_compile_queue.size();
+    m_compile_stats.max_queue_depth =
+        std::max(m_compile_stats.max_queue_depth, m_compile_stats.queue_depth);
+  }
+  m_compile_queue_changed.notify_one();
+}
+
+bool Jit64::IsStillValid(const CompiledBlock& compiled) const
+{
+  const JitBlock& block = *compiled.block;
+  if (block.msrBits != (MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK))
+    return false;
+
+  for (const auto& instruction : compiled.instructions)
+  {
+    const PowerPC::TryReadInstResult result = PowerPC::TryReadInstruction(instruction.first);
+    if (!result.valid || result.hex != instruction.second ||
+        compiled.physical_addresses.count(result.physical_address) == 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Jit64::LinkCompiledBlocks()
+{
+  if (m_compiled_blocks.empty())
+    return;
+
+  const CompileClock::time_point now = CompileClock::now();
+  u64 num_linked = 0;
+  u64 total_latency = 0;
+  u64 max_latency = 0;
+  for (CompiledBlock& compiled : m_compiled_blocks)
+  {
+    // Another request for the same address may have been compiled already.
+    if (!IsStillValid(compiled) || blocks.GetBlockFromStartAddress(compiled.request.address, MSR))
+      continue;
+
+    JitBlock* b = blocks.AttachBlock(std::move(compiled.block));
+    CommitBackPatchInfo(std::move(compiled.back_patch_info));
+    blocks.FinalizeBlock(*b, jo.enableBlocklink, compiled.physical_addresses);
+    if (m_persistent_cache.IsOpen() && m_persistent_cache.RecordBlock(*b))
+      m_precompile_requested = true;
+
+    const u64 latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - compiled.request.time).count();
+    total_latency += latency;
+    max_latency = std::max(max_latency, latency);
+    ++num_linked;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_compile_queue_mutex);
+    for (const CompiledBlock& compiled : m_compiled_blocks)
+      m_queued_addresses.erase(compiled.request.address);
+    m_compile_stats.blocks_compiled += num_linked;
+    m_compile_stats.blocks_discarded += m_compiled_blocks.size() - num_linked;
+    m_compile_stats.total_latency += total_latency;
+    m_compile_stats.max_latency = std::max(m_compile_stats.max_latency, max_latency);
+  }
+
+  m_compiled_blocks.clear();
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBlock* b, u32 nextPC)
@@ -658,6 +975,26 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
     // get start tic
     PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
   }
+  else if (SConfig::GetInstance().iJITTier2Threshold > 0 &&
+           js.hotBlockAddresses.find(js.blockStart) == js.hotBlockAddresses.end())
+  {
+    // Count how often this block runs. Once it reaches the threshold, have it recompiled with
+    // wider analysis; invalidating it unlinks it, and the new block gets linked in its place.
+    SwitchToFarCode();
+    const u8* target = GetCodePtr();
+    MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+    ABI_PushRegistersAndAdjustStack({}, 0);
+    ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
+                      static_cast<u32>(JitInterface::ExceptionType::HotBlock));
+    ABI_PopRegistersAndAdjustStack({}, 0);
+    JMP(asm_routines.dispatcherNoCheck, true);
+    SwitchToNearCode();
+
+    MOV(64, R(RSCRATCH), ImmPtr(&b->runCount));
+    ADD(32, MatR(RSCRATCH), Imm8(1));
+    CMP(32, MatR(RSCRATCH), Imm32(SConfig::GetInstance().iJITTier2Threshold));
+    J_CC(CC_E, target);
+  }
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
   // should help logged stack-traces become more accurate
   MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -896,12 +1233,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
         SwitchToFarCode();
         if (!js.fastmemLoadStore)
         {
-          m_exception_handler_at_loc[js.fastmemLoadStore] = nullptr;
+          m_emitted_back_patch_info.exception_handlers[js.fastmemLoadStore] = nullptr;
           SetJumpTarget(js.fixupExceptionHandler ? js.exceptionHandler : memException);
         }
         else
         {
-          m_exception_handler_at_loc[js.fastmemLoadStore] = GetWritableCodePtr();
+          m_emitted_back_patch_info.exception_handlers[js.fastmemLoadStore] = GetWritableCodePtr();
         }
 
         BitSet32 gprToFlush = BitSet32::AllTrue(32);
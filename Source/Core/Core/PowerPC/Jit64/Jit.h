@@ -18,6 +18,16 @@
 // ----------
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -27,6 +37,7 @@
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64Base.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
 class Jit64 : public Jitx86Base
@@ -58,6 +69,19 @@ public:
 
   void ClearCache() override;
 
+  struct BackgroundCompileStats
+  {
+    u64 blocks_compiled = 0;
+    // Blocks whose code or MSR changed while they were being compiled.
+    u64 blocks_discarded = 0;
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    // Time from the first request for a block until it could be linked, in microseconds.
+    u64 total_latency = 0;
+    u64 max_latency = 0;
+  };
+  BackgroundCompileStats GetBackgroundCompileStats();
+
   const CommonAsmRoutines* GetAsmRoutines() override { return &asm_routines; }
   const char* GetName() override { return "JIT64"; }
   // Run!
@@ -237,6 +261,39 @@ private:
   void AllocStack();
   void FreeStack();
 
+  u32 AnalyzeBlock(u32 em_address, u32 block_size);
+
+  void UpdatePersistentCache();
+  void PrecompilePersistentBlocks();
+
+  using CompileClock = std::chrono::steady_clock;
+
+  struct CompileRequest
+  {
+    u32 address;
+    CompileClock::time_point time;
+  };
+
+  struct CompiledBlock
+  {
+    CompileRequest request;
+    JitBaseBlockCache::DetachedBlock block;
+    std::set<u32> physical_addresses;
+    BackPatchInfo back_patch_info;
+    // (address, instruction) pairs the block was compiled from, so that blocks whose code was
+    // overwritten while they were being compiled can be thrown away.
+    std::vector<std::pair<u32, u32>> instructions;
+  };
+
+  void StartCompileThread();
+  void StopCompileThread();
+  void CompileThread();
+  bool CompileDetached(const CompileRequest& request);
+  void JitInBackground(u32 em_address);
+  void QueueCompile(u32 em_address);
+  void LinkCompiledBlocks();
+  bool IsStillValid(const CompiledBlock& compiled) const;
+
   GPRRegCache gpr{*this};
   FPURegCache fpr{*this};
 
@@ -248,4 +305,24 @@ private:
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
   u8* m_stack;
+
+  JitPersistentCache m_persistent_cache;
+  bool m_precompile_requested = false;
+  // Set once the known blocks no longer fit into the code cache, as precompiling them again after
+  // every flush would only make it thrash.
+  bool m_precompile_disabled = false;
+
+  // Only running if SConfig::bJITBackgroundCompile is set. The CPU thread interprets blocks which
+  // aren't compiled yet instead of waiting for them.
+  std::thread m_compile_thread;
+  std::mutex m_compile_queue_mutex;
+  std::condition_variable m_compile_queue_changed;
+  std::deque<CompileRequest> m_compile_queue;
+  // Addresses that are queued, or compiled but not linked yet.
+  std::unordered_set<u32> m_queued_addresses;
+  bool m_compile_thread_exit = false;
+  BackgroundCompileStats m_compile_stats;
+  // Guarded by cache_mutex.
+  std::vector<CompiledBlock> m_compiled_blocks;
+  bool m_clear_requested = false;
 };
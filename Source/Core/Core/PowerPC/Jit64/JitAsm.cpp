@@ -178,9 +178,13 @@ void Jit64AsmRoutineManager::Generate()
   ABI_CallFunction(JitTrampoline);
   ABI_PopRegistersAndAdjustStack({}, 0);
 
+  // With background compilation, Jit may have interpreted the block instead, using up cycles.
+  CMP(32, PPCSTATE(downcount), Imm8(0));
+  FixupBranch interpreted_bail = J_CC(CC_LE, true);
   JMP(dispatcherNoCheck, true);
 
   SetJumpTarget(bail);
+  SetJumpTarget(interpreted_bail);
   doTiming = GetCodePtr();
 
   // make sure npc contains the next pc (needed for exception checking in CoreTiming::Advance)
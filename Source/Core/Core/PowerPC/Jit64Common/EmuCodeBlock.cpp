@@ -4,6 +4,8 @@
 
 #include "Core/PowerPC/Jit64Common/EmuCodeBlock.h"
 
+#include <utility>
+
 #include "Common/Assert.h"
 #include "Common/CPUDetect.h"
 #include "Common/Intrinsics.h"
@@ -48,13 +50,13 @@ void EmuCodeBlock::MemoryExceptionCheck()
   // If we are currently generating a trampoline for a failed fastmem
   // load/store, the trampoline generator will have stashed the exception
   // handler (that we previously generated after the fastmem instruction) in
-  // trampolineExceptionHandler.
-  if (g_jit->js.generatingTrampoline)
+  // m_trampoline_exception_handler.
+  if (m_generating_trampoline)
   {
-    if (g_jit->js.trampolineExceptionHandler)
+    if (m_trampoline_exception_handler)
     {
       TEST(32, PPCSTATE(Exceptions), Gen::Imm32(EXCEPTION_DSI));
-      J_CC(CC_NZ, g_jit->js.trampolineExceptionHandler);
+      J_CC(CC_NZ, m_trampoline_exception_handler);
     }
     return;
   }
@@ -342,7 +344,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     MovInfo mov;
     bool offsetAddedToAddress =
         UnsafeLoadToReg(reg_value, opAddress, accessSize, offset, signExtend, &mov);
-    TrampolineInfo& info = m_back_patch_info[mov.address];
+    TrampolineInfo& info = m_emitted_back_patch_info.trampolines[mov.address];
     info.pc = g_jit->js.compilerPC;
     info.nonAtomicSwapStoreSrc = mov.nonAtomicSwapStore ? mov.nonAtomicSwapStoreSrc : INVALID_REG;
     info.start = backpatchStart;
@@ -500,7 +502,7 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     u8* backpatchStart = GetWritableCodePtr();
     MovInfo mov;
     UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, offset, swap, &mov);
-    TrampolineInfo& info = m_back_patch_info[mov.address];
+    TrampolineInfo& info = m_emitted_back_patch_info.trampolines[mov.address];
     info.pc = g_jit->js.compilerPC;
     info.nonAtomicSwapStoreSrc = mov.nonAtomicSwapStore ? mov.nonAtomicSwapStoreSrc : INVALID_REG;
     info.start = backpatchStart;
@@ -551,8 +553,10 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     SetJumpTarget(slow);
   }
 
-  // PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
-  MOV(32, PPCSTATE(pc), Imm32(g_jit->js.compilerPC));
+  // PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs.
+  // Write trampolines have already stored the PC of the access they belong to.
+  if (!m_generating_trampoline)
+    MOV(32, PPCSTATE(pc), Imm32(g_jit->js.compilerPC));
 
   size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
   ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
@@ -1137,6 +1141,22 @@ void EmuCodeBlock::SetFPRF(Gen::X64Reg xmm)
 
 void EmuCodeBlock::Clear()
 {
+  m_emitted_back_patch_info = {};
   m_back_patch_info.clear();
   m_exception_handler_at_loc.clear();
 }
+
+EmuCodeBlock::BackPatchInfo EmuCodeBlock::TakeEmittedBackPatchInfo()
+{
+  BackPatchInfo info = std::move(m_emitted_back_patch_info);
+  m_emitted_back_patch_info = {};
+  return info;
+}
+
+void EmuCodeBlock::CommitBackPatchInfo(BackPatchInfo info)
+{
+  for (auto& entry : info.trampolines)
+    m_back_patch_info[entry.first] = entry.second;
+  for (auto& entry : info.exception_handlers)
+    m_exception_handler_at_loc[entry.first] = entry.second;
+}
@@ -23,6 +23,13 @@ class Mapping;
 class EmuCodeBlock : public Gen::X64CodeBlock
 {
 public:
+  // Where the fastmem accesses of emitted code can be backpatched, see Jitx86Base::BackPatch().
+  struct BackPatchInfo
+  {
+    std::unordered_map<u8*, TrampolineInfo> trampolines;
+    std::unordered_map<u8*, u8*> exception_handlers;
+  };
+
   void MemoryExceptionCheck();
 
   // Simple functions to switch between near and far code emitting
@@ -123,11 +130,24 @@ public:
   void SetFPRF(Gen::X64Reg xmm);
   void Clear();
 
+  // Returns the backpatching information of everything emitted since the last call.
+  BackPatchInfo TakeEmittedBackPatchInfo();
+  // Makes backpatching information visible to the fault handler. As that runs on the CPU thread
+  // without taking any locks, this must only be called on the CPU thread, too.
+  void CommitBackPatchInfo(BackPatchInfo info);
+
 protected:
   ConstantPool m_const_pool;
   FarCodeCache m_far_code;
   u8* m_near_code;  // Backed up when we switch to far code.
 
+  // Emitting code only adds to m_emitted_back_patch_info, so the compile thread never writes
+  // anything the fault handler reads.
+  BackPatchInfo m_emitted_back_patch_info;
   std::unordered_map<u8*, TrampolineInfo> m_back_patch_info;
   std::unordered_map<u8*, u8*> m_exception_handler_at_loc;
+
+  // Set while the trampoline cache emits the slow path of a backpatched access.
+  bool m_generating_trampoline = false;
+  u8* m_trampoline_exception_handler = nullptr;
 };
@@ -73,13 +73,8 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
   // into the original code if necessary to ensure there is enough space
   // to insert the backpatch jump.)
 
-  js.generatingTrampoline = true;
-  js.trampolineExceptionHandler = exceptionHandler;
-
-  // Generate the trampoline.
-  const u8* trampoline = trampolines.GenerateTrampoline(info);
-  js.generatingTrampoline = false;
-  js.trampolineExceptionHandler = nullptr;
+  // Generate the trampoline. This doesn't touch js, which the compile thread may be using.
+  const u8* trampoline = trampolines.GenerateTrampoline(info, exceptionHandler);
 
   u8* start = info.start;
 
@@ -28,14 +28,16 @@ void TrampolineCache::ClearCodeSpace()
   X64CodeBlock::ClearCodeSpace();
 }
 
-const u8* TrampolineCache::GenerateTrampoline(const TrampolineInfo& info)
+const u8* TrampolineCache::GenerateTrampoline(const TrampolineInfo& info, u8* exception_handler)
 {
-  if (info.read)
-  {
-    return GenerateReadTrampoline(info);
-  }
+  m_generating_trampoline = true;
+  m_trampoline_exception_handler = exception_handler;
 
-  return GenerateWriteTrampoline(info);
+  const u8* trampoline = info.read ? GenerateReadTrampoline(info) : GenerateWriteTrampoline(info);
+
+  m_generating_trampoline = false;
+  m_trampoline_exception_handler = nullptr;
+  return trampoline;
 }
 
 const u8* TrampolineCache::GenerateReadTrampoline(const TrampolineInfo& info)
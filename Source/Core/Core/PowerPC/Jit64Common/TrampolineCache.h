@@ -30,6 +30,7 @@ class TrampolineCache : public EmuCodeBlock
   const u8* GenerateWriteTrampoline(const TrampolineInfo& info);
 
 public:
-  const u8* GenerateTrampoline(const TrampolineInfo& info);
+  // exception_handler is where the fastmem access jumped to on a DSI exception, if anywhere.
+  const u8* GenerateTrampoline(const TrampolineInfo& info, u8* exception_handler);
   void ClearCodeSpace();
 };
@@ -9,6 +9,7 @@
 //#define JIT_LOG_FPR     // Enables logging of the PPC floating point regs
 
 #include <map>
+#include <mutex>
 #include <unordered_set>
 
 #include "Common/CommonTypes.h"
@@ -82,9 +83,6 @@ protected:
     bool carryFlagSet;
     bool carryFlagInverted;
 
-    bool generatingTrampoline = false;
-    u8* trampolineExceptionHandler;
-
     bool mustCheckFifo;
     int fifoBytesSinceCheck;
 
@@ -99,6 +97,8 @@ protected:
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+    // Blocks which ran often enough to be recompiled with wider analysis.
+    std::unordered_set<u32> hotBlockAddresses;
   };
 
   PPCAnalyst::CodeBlock code_block;
@@ -113,6 +113,10 @@ public:
   JitOptions jo;
   JitState js;
 
+  // Held while the block cache or the emitted code is modified from outside of the JIT's own
+  // compile path. Only ever contended if the JIT compiles on a background thread.
+  std::mutex cache_mutex;
+
   JitBase();
   ~JitBase() override;
 
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cstring>
 #include <map>
+#include <memory>
 #include <utility>
 
 #include "Common/CommonTypes.h"
@@ -60,9 +61,10 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  m_jit.js.hotBlockAddresses.clear();
   for (auto& e : block_map)
   {
-    DestroyBlock(e.second);
+    DestroyBlock(*e.second);
   }
   block_map.clear();
   links_to.clear();
@@ -87,19 +89,29 @@ JitBlock** JitBaseBlockCache::GetFastBlockMap()
 void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 {
   for (const auto& e : block_map)
-    f(e.second);
+    f(*e.second);
 }
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
-  u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
-  b.effectiveAddress = em_address;
-  b.physicalAddress = physicalAddress;
-  b.msrBits = MSR & JIT_CACHE_MSR_MASK;
-  b.linkData.clear();
-  b.fast_block_map_index = 0;
-  return &b;
+  return AttachBlock(AllocateDetachedBlock(em_address));
+}
+
+JitBaseBlockCache::DetachedBlock JitBaseBlockCache::AllocateDetachedBlock(u32 em_address)
+{
+  auto b = std::make_unique<JitBlock>();
+  b->effectiveAddress = em_address;
+  b->physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
+  b->msrBits = MSR & JIT_CACHE_MSR_MASK;
+  b->linkData.clear();
+  b->fast_block_map_index = 0;
+  return b;
+}
+
+JitBlock* JitBaseBlockCache::AttachBlock(DetachedBlock block)
+{
+  const u32 physical_address = block->physicalAddress;
+  return block_map.emplace(physical_address, std::move(block))->second.get();
 }
 
 void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
@@ -147,7 +159,7 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
   auto iter = block_map.equal_range(translated_addr);
   for (; iter.first != iter.second; iter.first++)
   {
-    JitBlock& b = iter.first->second;
+    JitBlock& b = *iter.first->second;
     if (b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK))
       return &b;
   }
@@ -200,6 +212,7 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
       {
         m_jit.js.fifoWriteAddresses.erase(i);
         m_jit.js.pairedQuantizeAddresses.erase(i);
+        m_jit.js.hotBlockAddresses.erase(i);
       }
     }
   }
@@ -231,7 +244,7 @@ void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
         auto block_map_iter = block_map.equal_range(block->physicalAddress);
         while (block_map_iter.first != block_map_iter.second)
         {
-          if (&block_map_iter.first->second == block)
+          if (block_map_iter.first->second.get() == block)
           {
             block_map.erase(block_map_iter.first);
             break;
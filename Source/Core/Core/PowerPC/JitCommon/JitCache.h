@@ -133,6 +133,13 @@ public:
   JitBlock* AllocateBlock(u32 em_address);
   void FinalizeBlock(JitBlock& block, bool block_link, const std::set<u32>& physical_addresses);
 
+  // A block which isn't part of the cache yet, for compiling off the CPU thread. The block keeps
+  // its address when it is attached, so the emitted code may refer to it.
+  using DetachedBlock = std::unique_ptr<JitBlock>;
+  DetachedBlock AllocateDetachedBlock(u32 em_address);
+  // Adds a detached block to the cache. It still has to be finalized.
+  JitBlock* AttachBlock(DetachedBlock block);
+
   // Look for the block in the slow but accurate way.
   // This function shall be used if FastLookupIndexForAddress() failed.
   // This might return nullptr if there is no such block.
@@ -172,7 +179,8 @@ private:
 
   // Map indexed by the physical address of the entry point.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  // Blocks are allocated separately so that their address doesn't change when they're attached.
+  std::multimap<u32, std::unique_ptr<JitBlock>> block_map;  // start_addr -> block
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
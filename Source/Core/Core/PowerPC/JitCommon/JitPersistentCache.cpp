@@ -0,0 +1,120 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
+
+#include <xxhash.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+class JitPersistentCache::Reader final : public LinearDiskCacheReader<Key, u32>
+{
+public:
+  explicit Reader(std::map<Key, Entry>& entries) : m_entries(entries) {}
+  void Read(const Key& key, const u32* value, u32 value_size) override
+  {
+    m_entries[key] = Entry{std::vector<u32>(value, value + value_size), true};
+  }
+
+private:
+  std::map<Key, Entry>& m_entries;
+};
+
+JitPersistentCache::~JitPersistentCache()
+{
+  Close();
+}
+
+void JitPersistentCache::Open(const std::string& game_id)
+{
+  Close();
+  if (game_id.empty())
+    return;
+
+  const std::string dir = File::GetUserPath(D_CACHE_IDX) + "JIT" DIR_SEP;
+  if (!File::Exists(dir))
+    File::CreateDir(dir);
+
+  m_game_id = game_id;
+  Reader reader(m_entries);
+  const u32 count = m_disk_cache.OpenAndRead(dir + game_id + ".cache", reader);
+  NOTICE_LOG(DYNA_REC, "Loaded %u persistent JIT cache entries for %s", count, game_id.c_str());
+}
+
+void JitPersistentCache::Close()
+{
+  if (!IsOpen())
+    return;
+
+  m_disk_cache.Sync();
+  m_disk_cache.Close();
+  m_entries.clear();
+  m_game_id.clear();
+}
+
+bool JitPersistentCache::HashInstructions(const std::vector<u32>& physical_addresses, u64* hash)
+{
+  XXH64_state_t state;
+  XXH64_reset(&state, 0);
+  for (u32 address : physical_addresses)
+  {
+    // Memory::GetPointer complains loudly about unmapped addresses, which stale entries can name.
+    const u32 masked = address & 0x3FFFFFFF;
+    const bool in_ram = masked < Memory::REALRAM_SIZE ||
+                        (Memory::m_pEXRAM && (masked >> 28) == 0x1 &&
+                         (masked & 0x0FFFFFFF) < Memory::EXRAM_SIZE);
+    if (!in_ram)
+      return false;
+
+    const u8* instruction = Memory::GetPointer(address);
+    XXH64_update(&state, instruction, sizeof(u32));
+  }
+  *hash = XXH64_digest(&state);
+  return true;
+}
+
+bool JitPersistentCache::RecordBlock(const JitBlock& block)
+{
+  const std::vector<u32> physical_addresses(block.physical_addresses.begin(),
+                                            block.physical_addresses.end());
+  Key key{block.effectiveAddress, block.msrBits, 0};
+  if (physical_addresses.empty() || !HashInstructions(physical_addresses, &key.hash))
+    return false;
+
+  auto it = m_entries.find(key);
+  if (it == m_entries.end())
+  {
+    m_entries.emplace(key, Entry{physical_addresses, false});
+    m_disk_cache.Append(key, physical_addresses.data(), static_cast<u32>(physical_addresses.size()));
+    return false;
+  }
+
+  const bool was_pending = it->second.pending;
+  it->second.pending = false;
+  return was_pending;
+}
+
+std::vector<u32> JitPersistentCache::TakeBlocksToPrecompile(u32 msr_bits)
+{
+  std::vector<u32> addresses;
+  for (auto& entry : m_entries)
+  {
+    if (!entry.second.pending || entry.first.msr_bits != msr_bits)
+      continue;
+
+    // Entries which don't match (yet) stay pending, as the code they belong to might only get
+    // loaded later on.
+    u64 hash;
+    if (HashInstructions(entry.second.physical_addresses, &hash) && hash == entry.first.hash)
+    {
+      addresses.push_back(entry.first.effective_address);
+      entry.second.pending = false;
+    }
+  }
+  return addresses;
+}
@@ -0,0 +1,71 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+
+struct JitBlock;
+
+// Remembers the addresses of the blocks a game had compiled in earlier sessions, keyed by the guest
+// address, the address translation bits in MSR and a hash of the guest instructions. Once the same
+// code is in RAM again, the background compile thread can warm the JIT cache up with them before
+// execution reaches each block.
+//
+// This is not a cache of the emitted host code, which embeds absolute pointers into the JIT's code
+// space (far code, trampolines, the constant pool and block links) that differ every session.
+class JitPersistentCache
+{
+public:
+  struct Key
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u64 hash;
+
+    bool operator<(const Key& other) const
+    {
+      return std::tie(effective_address, msr_bits, hash) <
+             std::tie(other.effective_address, other.msr_bits, other.hash);
+    }
+  };
+
+  ~JitPersistentCache();
+
+  void Open(const std::string& game_id);
+  void Close();
+  bool IsOpen() const { return !m_game_id.empty(); }
+  const std::string& GetGameID() const { return m_game_id; }
+
+  // Adds a freshly compiled block to the cache. Returns true if the block was already known from
+  // a previous session but had not been precompiled yet, which means that code it belongs to has
+  // just been loaded.
+  bool RecordBlock(const JitBlock& block);
+
+  // Returns the addresses of all pending blocks compiled with the given MSR bits whose
+  // instructions are unchanged in RAM, and marks them as no longer pending. Every block is
+  // only returned once per session, clearing the JIT cache doesn't make them pending again.
+  std::vector<u32> TakeBlocksToPrecompile(u32 msr_bits);
+
+private:
+  struct Entry
+  {
+    std::vector<u32> physical_addresses;
+    bool pending;
+  };
+
+  class Reader;
+
+  static bool HashInstructions(const std::vector<u32>& physical_addresses, u64* hash);
+
+  std::string m_game_id;
+  std::map<Key, Entry> m_entries;
+  LinearDiskCache<Key, u32> m_disk_cache;
+};
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdio>
+#include <mutex>
 #include <string>
 
 #ifdef _WIN32
@@ -41,7 +42,10 @@ namespace JitInterface
 void DoState(PointerWrap& p)
 {
   if (g_jit && p.GetMode() == PointerWrap::MODE_READ)
+  {
+    std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
     g_jit->ClearCache();
+  }
 }
 CPUCoreBase* InitJitCore(int core)
 {
@@ -117,6 +121,7 @@ void GetProfileResults(ProfileStats* prof_stats)
     Core::SetState(Core::State::Paused);
 
   QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
+  std::unique_lock<std::mutex> lock(g_jit->cache_mutex);
   g_jit->GetBlockCache()->RunOnBlocks([&prof_stats](const JitBlock& block) {
     // Rough heuristic.  Mem instructions should cost more.
     u64 cost = block.originalSize * (block.runCount / 4);
@@ -128,6 +133,7 @@ void GetProfileResults(ProfileStats* prof_stats)
     prof_stats->cost_sum += cost;
     prof_stats->timecost_sum += timecost;
   });
+  lock.unlock();
 
   sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
   if (old_state == Core::State::Running)
@@ -142,6 +148,7 @@ int GetHostCode(u32* address, const u8** code, u32* code_size)
     return 1;
   }
 
+  std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
   JitBlock* block = g_jit->GetBlockCache()->GetBlockFromStartAddress(*address, MSR);
   if (!block)
   {
@@ -196,8 +203,11 @@ bool HandleStackFault()
 
 void ClearCache()
 {
-  if (g_jit)
-    g_jit->ClearCache();
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
+  g_jit->ClearCache();
 }
 void ClearSafe()
 {
@@ -205,14 +215,20 @@ void ClearSafe()
   // inside a JIT'ed block: it clears the instruction cache, but not
   // the JIT'ed code.
   // TODO: There's probably a better way to handle this situation.
-  if (g_jit)
-    g_jit->GetBlockCache()->Clear();
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
+  g_jit->GetBlockCache()->Clear();
 }
 
 void InvalidateICache(u32 address, u32 size, bool forced)
 {
-  if (g_jit)
-    g_jit->GetBlockCache()->InvalidateICache(address, size, forced);
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
+  g_jit->GetBlockCache()->InvalidateICache(address, size, forced);
 }
 
 void CompileExceptionCheck(ExceptionType type)
@@ -220,6 +236,7 @@ void CompileExceptionCheck(ExceptionType type)
   if (!g_jit)
     return;
 
+  std::lock_guard<std::mutex> lock(g_jit->cache_mutex);
   std::unordered_set<u32>* exception_addresses = nullptr;
 
   switch (type)
@@ -233,6 +250,9 @@ void CompileExceptionCheck(ExceptionType type)
   case ExceptionType::SpeculativeConstants:
     exception_addresses = &g_jit->js.noSpeculativeConstantsAddresses;
     break;
+  case ExceptionType::HotBlock:
+    exception_addresses = &g_jit->js.hotBlockAddresses;
+    break;
   }
 
   if (PC != 0 && (exception_addresses->find(PC)) == (exception_addresses->end()))
@@ -40,9 +40,6 @@ namespace PPCAnalyst
 #endif
 CONSTEXPR(int, CODEBUFFER_SIZE, 32000);
 
-// 0 does not perform block merging
-CONSTEXPR(u32, BRANCH_FOLLOWING_THRESHOLD, 2);
-
 CONSTEXPR(u32, INVALID_BRANCH_TARGET, 0xFFFFFFFF);
 
 CodeBuffer::CodeBuffer(int size)
@@ -747,11 +744,11 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 
     bool conditional_continue = false;
 
-    // TODO: Find the optimal value for BRANCH_FOLLOWING_THRESHOLD.
+    // TODO: Find the optimal value for DEFAULT_BRANCH_FOLLOW_LIMIT.
     //       If it is small, the performance will be down.
     //       If it is big, the size of generated code will be big and
     //       cache clearning will happen many times.
-    if (HasOption(OPTION_BRANCH_FOLLOW) && numFollows < BRANCH_FOLLOWING_THRESHOLD)
+    if (HasOption(OPTION_BRANCH_FOLLOW) && numFollows < m_branch_follow_limit)
     {
       if (inst.OPCD == 18 && blockSize > 1)
       {
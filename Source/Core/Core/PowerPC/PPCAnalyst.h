@@ -180,6 +180,7 @@ private:
 
   // Options
   u32 m_options;
+  u32 m_branch_follow_limit;
 
 public:
   enum AnalystOption
@@ -220,11 +221,16 @@ public:
     OPTION_CROR_MERGE = (1 << 6),
   };
 
-  PPCAnalyzer() : m_options(0) {}
+  // How many unconditional branches OPTION_BRANCH_FOLLOW may follow within one block.
+  // 0 does not perform block merging.
+  static constexpr u32 DEFAULT_BRANCH_FOLLOW_LIMIT = 2;
+
+  PPCAnalyzer() : m_options(0), m_branch_follow_limit(DEFAULT_BRANCH_FOLLOW_LIMIT) {}
   // Option setting/getting
   void SetOption(AnalystOption option) { m_options |= option; }
   void ClearOption(AnalystOption option) { m_options &= ~(option); }
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
+  void SetBranchFollowLimit(u32 limit) { m_branch_follow_limit = limit; }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize);
 };
 
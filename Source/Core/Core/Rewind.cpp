@@ -0,0 +1,357 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/Rewind.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <lzo/lzo1x.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
+#include "Core/State.h"
+
+namespace Rewind
+{
+using Clock = std::chrono::steady_clock;
+
+// Every this many captured frames, a frame is stored in full rather than as a delta.
+static const u32 KEYFRAME_INTERVAL = 60;
+// Frames aren't captured while this many are still waiting to be encoded.
+static const u32 MAX_PENDING_FRAMES = 2;
+
+struct Frame
+{
+  u64 id;
+  bool keyframe;
+  // The uncompressed size of the state or delta.
+  size_t size;
+  size_t memory_offset;
+  std::vector<u8> data;
+};
+
+// Guards the stored frames and the stats.
+static std::mutex s_mutex;
+static std::deque<Frame> s_frames;
+static size_t s_bytes_stored = 0;
+static u64 s_next_frame_id = 0;
+static std::vector<std::vector<u8>> s_spare_buffers;
+// Captured states that are still waiting for the encoder.
+static size_t s_pending_bytes = 0;
+static Stats s_stats;
+
+// The newest keyframe, uncompressed. Only used by the encoder, or while it is idle.
+static std::vector<u8> s_keyframe;
+static u64 s_keyframe_id = 0;
+static size_t s_keyframe_memory_offset = 0;
+static u32 s_frames_since_keyframe = 0;
+
+static std::atomic<bool> s_capture_queued{false};
+// Only used on the CPU thread.
+static int s_frames_until_capture = 0;
+static std::atomic<u32> s_pending_frames{0};
+
+static Common::WorkerPool& GetEncoderPool()
+{
+  static Common::WorkerPool pool("Rewind encoder", 1);
+  return pool;
+}
+
+static u64 GetMicroseconds(Clock::time_point start)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+static std::vector<u8> Compress(const std::vector<u8>& data)
+{
+  std::vector<u8> out(data.size() + data.size() / 16 + 64 + 3);
+  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+  lzo_uint out_len = 0;
+  if (lzo1x_1_compress(data.data(), data.size(), out.data(), &out_len, wrkmem.data()) != LZO_E_OK)
+    return {};
+  out.resize(out_len);
+  out.shrink_to_fit();
+  return out;
+}
+
+static bool Decompress(const Frame& frame, std::vector<u8>& out)
+{
+  out.resize(frame.size);
+  lzo_uint out_len = frame.size;
+  return lzo1x_decompress_safe(frame.data.data(), frame.data.size(), out.data(), &out_len,
+                               nullptr) == LZO_E_OK &&
+         out_len == frame.size;
+}
+
+// The uncompressed states held besides the stored frames, which count against the budget too.
+static size_t GetBufferedBytes()
+{
+  size_t bytes = s_keyframe.capacity() + s_pending_bytes;
+  for (const std::vector<u8>& buffer : s_spare_buffers)
+    bytes += buffer.capacity();
+  return bytes;
+}
+
+// Drops the oldest keyframes along with their deltas until the stored frames and the buffered
+// states fit into the budget. The newest keyframe is always kept.
+static void EnforceBudget()
+{
+  const size_t budget = static_cast<size_t>(SConfig::GetInstance().iRewindBufferSize) << 20;
+  while (s_bytes_stored + GetBufferedBytes() > budget)
+  {
+    const auto next_keyframe = std::find_if(std::next(s_frames.begin()), s_frames.end(),
+                                            [](const Frame& frame) { return frame.keyframe; });
+    if (next_keyframe == s_frames.end())
+      break;
+
+    for (auto it = s_frames.begin(); it != next_keyframe; ++it)
+      s_bytes_stored -= it->data.size();
+    s_frames.erase(s_frames.begin(), next_keyframe);
+  }
+}
+
+static void Encode(std::vector<u8>& state, size_t memory_offset)
+{
+  const Clock::time_point start = Clock::now();
+  const size_t captured_bytes = state.capacity();
+
+  Frame frame;
+  frame.id = s_next_frame_id++;
+  frame.keyframe = s_keyframe.empty() || s_frames_since_keyframe >= KEYFRAME_INTERVAL;
+  frame.size = state.size();
+  frame.memory_offset = memory_offset;
+
+  if (!frame.keyframe)
+  {
+    const std::vector<u8> delta =
+        State::CreateDelta(s_keyframe, s_keyframe_memory_offset, state, memory_offset);
+    // Once most of the state changed, a new keyframe is cheaper for the following frames.
+    if (delta.size() > state.size() / 4)
+    {
+      frame.keyframe = true;
+    }
+    else
+    {
+      frame.size = delta.size();
+      frame.data = Compress(delta);
+      ++s_frames_since_keyframe;
+    }
+  }
+
+  if (frame.keyframe)
+  {
+    frame.data = Compress(state);
+    s_keyframe.swap(state);
+    s_keyframe_id = frame.id;
+    s_keyframe_memory_offset = memory_offset;
+    s_frames_since_keyframe = 0;
+  }
+
+  const u64 encode_time = GetMicroseconds(start);
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  s_pending_bytes -= captured_bytes;
+  // Saves the next captures from having to fault in a fresh buffer.
+  if (s_spare_buffers.size() < MAX_PENDING_FRAMES)
+    s_spare_buffers.push_back(std::move(state));
+
+  s_bytes_stored += frame.data.size();
+  s_frames.push_back(std::move(frame));
+  EnforceBudget();
+
+  s_stats.total_encode_time += encode_time;
+  s_stats.max_encode_time = std::max(s_stats.max_encode_time, encode_time);
+}
+
+// Runs on the host thread, as the core has to be paused for saving a state.
+static void Capture()
+{
+  s_capture_queued = false;
+  if (Core::GetState() != Core::State::Running)
+    return;
+
+  std::vector<u8> state;
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+    if (s_pending_frames >= MAX_PENDING_FRAMES)
+    {
+      ++s_stats.frames_skipped;
+      return;
+    }
+    if (!s_spare_buffers.empty())
+    {
+      state.swap(s_spare_buffers.back());
+      s_spare_buffers.pop_back();
+    }
+  }
+
+  const Clock::time_point start = Clock::now();
+  State::SaveToBuffer(state);
+  const size_t memory_offset = State::GetLastMemoryOffset();
+  const u64 capture_time = GetMicroseconds(start);
+
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+    s_pending_bytes += state.capacity();
+    ++s_stats.frames_captured;
+    s_stats.total_capture_time += capture_time;
+    s_stats.max_capture_time = std::max(s_stats.max_capture_time, capture_time);
+  }
+
+  ++s_pending_frames;
+  auto shared_state = std::make_shared<std::vector<u8>>(std::move(state));
+  GetEncoderPool().Push([shared_state, memory_offset] {
+    Encode(*shared_state, memory_offset);
+    --s_pending_frames;
+  });
+}
+
+void FrameUpdate()
+{
+  const SConfig& config = SConfig::GetInstance();
+  // Loading a state would desync a movie, so there is nothing to capture frames for.
+  if (config.iRewindBufferSize <= 0 || NetPlay::IsNetPlayRunning() || Movie::IsMovieActive())
+    return;
+
+  if (--s_frames_until_capture > 0)
+    return;
+  s_frames_until_capture = std::max(config.iRewindInterval, 1);
+
+  // Only one capture at a time; the host may fall behind the emulation.
+  if (!s_capture_queued.exchange(true))
+    Core::QueueHostJob(Capture);
+}
+
+// Decompresses the newest stored frame. Also makes its keyframe the base for the next deltas, as
+// the frames after it are gone.
+static bool RestoreNewestFrame(std::vector<u8>& state)
+{
+  const Frame& target = s_frames.back();
+  const auto keyframe = std::find_if(s_frames.rbegin(), s_frames.rend(),
+                                     [](const Frame& frame) { return frame.keyframe; });
+  if (keyframe == s_frames.rend())
+    return false;
+
+  if (s_keyframe.empty() || s_keyframe_id != keyframe->id)
+  {
+    if (!Decompress(*keyframe, s_keyframe))
+    {
+      s_keyframe.clear();
+      return false;
+    }
+    s_keyframe_id = keyframe->id;
+    s_keyframe_memory_offset = keyframe->memory_offset;
+  }
+  s_frames_since_keyframe = static_cast<u32>(std::distance(s_frames.rbegin(), keyframe));
+
+  if (target.keyframe)
+  {
+    state = s_keyframe;
+    return true;
+  }
+
+  std::vector<u8> delta;
+  return Decompress(target, delta) && State::ApplyDelta(s_keyframe, delta, state);
+}
+
+bool StepBack()
+{
+  if (!Core::IsRunningAndStarted())
+    return false;
+
+  if (Movie::IsMovieActive())
+  {
+    Core::DisplayMessage("Rewinding is not possible while a movie is recording or playing", 2000);
+    return false;
+  }
+
+  // Like frame advance, this leaves the emulation paused, which also stops new captures.
+  Core::SetState(Core::State::Paused);
+  GetEncoderPool().WaitForIdle();
+
+  std::vector<u8> state;
+  size_t frames_left;
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+
+    // The newest frame is (about) where the emulation is now.
+    if (s_frames.size() < 2)
+    {
+      Core::DisplayMessage("Nothing left to rewind", 2000);
+      return false;
+    }
+    s_bytes_stored -= s_frames.back().data.size();
+    s_frames.pop_back();
+
+    if (!RestoreNewestFrame(state))
+    {
+      ERROR_LOG(CORE, "Failed to restore rewind frame");
+      return false;
+    }
+    frames_left = s_frames.size() - 1;
+  }
+
+  State::LoadFromBuffer(state);
+  Core::DisplayMessage(StringFromFormat("Rewound %d frames (%zu steps left)",
+                                        std::max(SConfig::GetInstance().iRewindInterval, 1),
+                                        frames_left),
+                       1000);
+  return true;
+}
+
+void Clear()
+{
+  GetEncoderPool().WaitForIdle();
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  s_frames.clear();
+  s_bytes_stored = 0;
+  std::vector<std::vector<u8>>().swap(s_spare_buffers);
+  std::vector<u8>().swap(s_keyframe);
+  s_frames_since_keyframe = 0;
+}
+
+void Shutdown()
+{
+  const Stats stats = GetStats();
+  if (stats.frames_captured != 0)
+  {
+    NOTICE_LOG(CORE, "Rewind: %llu frames captured, %llu skipped, %zu stored in %zu bytes, "
+                     "capture avg %llu us max %llu us, encode avg %llu us max %llu us",
+               static_cast<unsigned long long>(stats.frames_captured),
+               static_cast<unsigned long long>(stats.frames_skipped), stats.frames_stored,
+               stats.bytes_stored,
+               static_cast<unsigned long long>(stats.total_capture_time / stats.frames_captured),
+               static_cast<unsigned long long>(stats.max_capture_time),
+               static_cast<unsigned long long>(stats.total_encode_time / stats.frames_captured),
+               static_cast<unsigned long long>(stats.max_encode_time));
+  }
+
+  Clear();
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  s_stats = {};
+}
+
+Stats GetStats()
+{
+  std::lock_guard<std::mutex> lk(s_mutex);
+  Stats stats = s_stats;
+  stats.frames_stored = s_frames.size();
+  stats.bytes_stored = s_bytes_stored;
+  return stats;
+}
+}
@@ -0,0 +1,45 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Keeps the savestates of recent frames in memory, so that emulation can be stepped backwards.
+// A state is captured every SConfig::iRewindInterval frames, as saving one means pausing the
+// emulation. Frames are stored as LZO compressed deltas against a periodic keyframe, and the
+// oldest ones are dropped once they and the uncompressed states still in use exceed
+// SConfig::iRewindBufferSize. Rewinding is unavailable during netplay and movies.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace Rewind
+{
+struct Stats
+{
+  u64 frames_captured = 0;
+  // Frames that were not captured because the encoder was still busy.
+  u64 frames_skipped = 0;
+  size_t frames_stored = 0;
+  size_t bytes_stored = 0;
+  // How long the emulation was paused to capture a frame, in microseconds.
+  u64 total_capture_time = 0;
+  u64 max_capture_time = 0;
+  // How long encoding a frame took in the background, in microseconds.
+  u64 total_encode_time = 0;
+  u64 max_encode_time = 0;
+};
+
+// Called on the CPU thread once per frame.
+void FrameUpdate();
+
+// Pauses the emulation and loads the last frame captured before the current one. Host thread
+// only.
+bool StepBack();
+
+void Clear();
+void Shutdown();
+
+Stats GetStats();
+}
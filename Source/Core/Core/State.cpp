@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
@@ -13,12 +16,14 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
+#include "Common/WorkerPool.h"
 
 #include "Core/ARBruteForcer.h"
 #include "Core/ConfigManager.h"
@@ -39,6 +44,8 @@
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoBackendBase.h"
 
+#include <xxhash.h>
+
 namespace State
 {
 #if defined(__LZO_STRICT_16BIT)
@@ -51,12 +58,53 @@ static const u32 IN_LEN = 128 * 1024u;
 
 static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
-static unsigned char __LZO_MMODEL out[OUT_LEN];
+// LZO chunks are compressed and decompressed in parallel, a batch at a time so that the
+// intermediate buffers stay small.
+static const size_t CHUNKS_PER_BATCH = 64;
+
+// Delta savestates only store the pages that differ from the last full savestate written in this
+// session. That state is also written to a file named after its hash, which the deltas refer to,
+// so that overwriting the slot it was saved to doesn't break them. Bases are deleted once no
+// savestate refers to them anymore.
+//
+// The changed pages are found by comparing against the base on the save thread. Memory's write
+// tracking could tell which pages were written instead, but it is only available with fastmem on
+// some platforms, and it would make every first write to a page after a save fault on the
+// emulation thread.
+static const u32 DELTA_MAGIC = 0x544C4544;  // "DELT", which is never a valid version cookie
+static const size_t DELTA_PAGE_SIZE = 4096;
+static const size_t DELTA_PAGES_PER_JOB = 256;
+// Bounds how many savestates are lost if a base savestate gets deleted.
+static const u32 MAX_DELTAS_PER_BASE = 16;
+
+struct DeltaHeader
+{
+  u64 size;
+  u64 memory_offset;
+  u64 base_size;
+  u64 base_memory_offset;
+};
 
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Precedes the base file name and the delta in delta savestates.
+struct DeltaFileHeader
+{
+  u32 magic;
+  u32 base_filename_size;
+  u64 base_hash;
+};
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+struct DeltaBase
+{
+  std::string filename;
+  std::string game_id;
+  std::vector<u8> buffer;
+  size_t memory_offset = 0;
+  u64 hash = 0;
+  u32 num_deltas = 0;
+};
+
+// Only used by the save thread, or after Flush().
+static DeltaBase s_delta_base;
 
 static std::string g_last_filename;
 
@@ -77,8 +125,12 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 
 static std::thread g_save_thread;
 
+// Where the hardware state (which starts with RAM) begins in the last measured savestate. Deltas
+// use it to match up pages even if the state before it changed size.
+static size_t s_memory_offset = 0;
+
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 86;  // Last changed in PR 2353
+static const u32 STATE_VERSION = 87;  // Last changed for the ubershader constants
 
 // Maps savestate versions to Dolphin versions.
 // Versions after 42 don't need to be added to this list,
@@ -191,6 +243,8 @@ static std::string DoState(PointerWrap& p)
   // the controller code might need to schedule an event if the controller has changed.
   CoreTiming::DoState(p);
   p.DoMarker("CoreTiming");
+  if (p.GetMode() == PointerWrap::MODE_MEASURE)
+    s_memory_offset = reinterpret_cast<size_t>(*p.ptr);
   HW::DoState(p);
   p.DoMarker("HW");
   Movie::DoState(p);
@@ -222,6 +276,11 @@ void LoadFromBuffer(std::vector<u8>& buffer)
   Core::PauseAndLock(false, wasUnpaused);
 }
 
+size_t GetLastMemoryOffset()
+{
+  return s_memory_offset;
+}
+
 void SaveToBuffer(std::vector<u8>& buffer)
 {
   bool wasUnpaused = Core::PauseAndLock(true);
@@ -303,9 +362,432 @@ struct CompressAndDumpState_args
   std::vector<u8>* buffer_vector;
   std::mutex* buffer_mutex;
   std::string filename;
+  size_t memory_offset;
+  bool delta;
   bool wait;
 };
 
+static Common::WorkerPool& GetCompressionPool()
+{
+  static Common::WorkerPool pool("Savestate compression");
+  return pool;
+}
+
+static void WriteCompressed(File::IOFile& f, const u8* data, size_t size)
+{
+  // There always is a final chunk shorter than IN_LEN, even if it's empty.
+  const size_t num_chunks = size / IN_LEN + 1;
+  std::vector<std::vector<u8>> out(std::min(num_chunks, CHUNKS_PER_BATCH));
+  std::vector<lzo_uint> out_lens(out.size());
+
+  for (size_t first = 0; first < num_chunks; first += CHUNKS_PER_BATCH)
+  {
+    const size_t count = std::min(CHUNKS_PER_BATCH, num_chunks - first);
+    GetCompressionPool().ParallelFor(count, [&](size_t i) {
+      const size_t offset = (first + i) * IN_LEN;
+      const lzo_uint32 cur_len = static_cast<lzo_uint32>(std::min<size_t>(IN_LEN, size - offset));
+      std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+      out[i].resize(OUT_LEN);
+      if (lzo1x_1_compress(data + offset, cur_len, out[i].data(), &out_lens[i], wrkmem.data()) !=
+          LZO_E_OK)
+      {
+        PanicAlertT("Internal LZO Error - compression failed");
+      }
+    });
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      // The size of the data to write is 'out_len'
+      const lzo_uint32 out_len = static_cast<lzo_uint32>(out_lens[i]);
+      f.WriteArray(&out_len, 1);
+      f.WriteBytes(out[i].data(), out_len);
+    }
+  }
+}
+
+// buffer must already have the uncompressed size.
+static bool ReadCompressed(File::IOFile& f, std::vector<u8>& buffer)
+{
+  std::vector<std::vector<u8>> in(CHUNKS_PER_BATCH);
+  std::vector<int> results(CHUNKS_PER_BATCH);
+  size_t first = 0;
+  bool end_of_file = false;
+
+  while (!end_of_file)
+  {
+    size_t count = 0;
+    for (; count < CHUNKS_PER_BATCH; ++count)
+    {
+      lzo_uint32 cur_len = 0;  // number of bytes to read
+      if (!f.ReadArray(&cur_len, 1))
+      {
+        end_of_file = true;
+        break;
+      }
+      if (cur_len > OUT_LEN)
+      {
+        PanicAlertT("Internal LZO Error - decompression failed (%d) (%zu) \n"
+                    "Try loading the state again",
+                    LZO_E_INPUT_OVERRUN, (first + count) * IN_LEN);
+        return false;
+      }
+      in[count].resize(cur_len);
+      f.ReadBytes(in[count].data(), cur_len);
+    }
+
+    // Every chunk but the last one decompresses to exactly IN_LEN bytes.
+    GetCompressionPool().ParallelFor(count, [&](size_t i) {
+      const size_t offset = (first + i) * IN_LEN;
+      if (offset > buffer.size())
+      {
+        results[i] = LZO_E_OUTPUT_OVERRUN;
+        return;
+      }
+      const lzo_uint expected_len = std::min<size_t>(IN_LEN, buffer.size() - offset);
+      lzo_uint new_len = expected_len;  // number of bytes to write
+      results[i] = lzo1x_decompress_safe(in[i].data(), in[i].size(), buffer.data() + offset,
+                                         &new_len, nullptr);
+      if (results[i] == LZO_E_OK && new_len != expected_len)
+        results[i] = LZO_E_ERROR;
+    });
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (results[i] != LZO_E_OK)
+      {
+        PanicAlertT("Internal LZO Error - decompression failed (%d) (%zu) \n"
+                    "Try loading the state again",
+                    results[i], (first + i) * IN_LEN);
+        return false;
+      }
+    }
+    first += count;
+  }
+
+  return true;
+}
+
+static size_t GetDeltaBaseOffset(const DeltaHeader& header, size_t offset)
+{
+  if (offset < header.memory_offset)
+    return offset;
+  return offset - header.memory_offset + header.base_memory_offset;
+}
+
+static bool IsPageUnchanged(const DeltaHeader& header, const u8* base, const u8* state,
+                            size_t page)
+{
+  const size_t offset = page * DELTA_PAGE_SIZE;
+  const size_t size = std::min<size_t>(DELTA_PAGE_SIZE, header.size - offset);
+  // A page spanning the start of the hardware state can't be matched up with the base.
+  if (offset < header.memory_offset && offset + size > header.memory_offset)
+    return false;
+
+  const size_t base_offset = GetDeltaBaseOffset(header, offset);
+  return base_offset + size <= header.base_size &&
+         std::memcmp(base + base_offset, state + offset, size) == 0;
+}
+
+std::vector<u8> CreateDelta(const std::vector<u8>& base, size_t base_memory_offset,
+                            const std::vector<u8>& state, size_t memory_offset)
+{
+  DeltaHeader header;
+  header.size = state.size();
+  header.memory_offset = memory_offset;
+  header.base_size = base.size();
+  header.base_memory_offset = base_memory_offset;
+
+  // One byte per page, nonzero for pages that are stored in the delta.
+  const size_t num_pages = (state.size() + DELTA_PAGE_SIZE - 1) / DELTA_PAGE_SIZE;
+  std::vector<u8> changed(num_pages);
+  const size_t num_jobs = (num_pages + DELTA_PAGES_PER_JOB - 1) / DELTA_PAGES_PER_JOB;
+  GetCompressionPool().ParallelFor(num_jobs, [&](size_t job) {
+    const size_t end = std::min(num_pages, (job + 1) * DELTA_PAGES_PER_JOB);
+    for (size_t page = job * DELTA_PAGES_PER_JOB; page < end; ++page)
+      changed[page] = !IsPageUnchanged(header, base.data(), state.data(), page);
+  });
+
+  std::vector<u8> delta(sizeof(header) + num_pages);
+  std::memcpy(delta.data(), &header, sizeof(header));
+  std::memcpy(delta.data() + sizeof(header), changed.data(), num_pages);
+  for (size_t page = 0; page < num_pages; ++page)
+  {
+    if (!changed[page])
+      continue;
+    const size_t offset = page * DELTA_PAGE_SIZE;
+    const size_t size = std::min<size_t>(DELTA_PAGE_SIZE, state.size() - offset);
+    delta.insert(delta.end(), state.begin() + offset, state.begin() + offset + size);
+  }
+  return delta;
+}
+
+static bool ApplyDelta(const std::vector<u8>& base, const u8* delta, size_t delta_size,
+                       std::vector<u8>& state)
+{
+  DeltaHeader header;
+  if (delta_size < sizeof(header))
+    return false;
+  std::memcpy(&header, delta, sizeof(header));
+  if (base.size() != header.base_size)
+    return false;
+
+  const size_t num_pages = (header.size + DELTA_PAGE_SIZE - 1) / DELTA_PAGE_SIZE;
+  if (delta_size < sizeof(header) + num_pages)
+    return false;
+  const u8* const changed = delta + sizeof(header);
+
+  std::vector<u8> buffer(header.size);
+  const u8* changed_data = changed + num_pages;
+  const u8* const changed_end = delta + delta_size;
+  for (size_t page = 0; page < num_pages; ++page)
+  {
+    const size_t offset = page * DELTA_PAGE_SIZE;
+    const size_t size = std::min<size_t>(DELTA_PAGE_SIZE, header.size - offset);
+    if (changed[page])
+    {
+      if (changed_end - changed_data < static_cast<ptrdiff_t>(size))
+        return false;
+      std::memcpy(buffer.data() + offset, changed_data, size);
+      changed_data += size;
+    }
+    else
+    {
+      const size_t base_offset = GetDeltaBaseOffset(header, offset);
+      if (base_offset + size > base.size())
+        return false;
+      std::memcpy(buffer.data() + offset, base.data() + base_offset, size);
+    }
+  }
+
+  state.swap(buffer);
+  return true;
+}
+
+bool ApplyDelta(const std::vector<u8>& base, const std::vector<u8>& delta, std::vector<u8>& state)
+{
+  return ApplyDelta(base, delta.data(), delta.size(), state);
+}
+
+static std::vector<u8> CreateDeltaFile(const DeltaBase& base, const std::vector<u8>& state,
+                                       size_t memory_offset)
+{
+  DeltaFileHeader header;
+  header.magic = DELTA_MAGIC;
+  header.base_filename_size = static_cast<u32>(base.filename.size());
+  header.base_hash = base.hash;
+
+  const std::vector<u8> delta = CreateDelta(base.buffer, base.memory_offset, state, memory_offset);
+  std::vector<u8> data(sizeof(header) + base.filename.size());
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::memcpy(data.data() + sizeof(header), base.filename.data(), base.filename.size());
+  data.insert(data.end(), delta.begin(), delta.end());
+  return data;
+}
+
+static bool IsDeltaFile(const std::vector<u8>& buffer)
+{
+  u32 magic;
+  if (buffer.size() < sizeof(magic))
+    return false;
+  std::memcpy(&magic, buffer.data(), sizeof(magic));
+  return magic == DELTA_MAGIC;
+}
+
+static bool ReadStateFile(const std::string& filename, std::vector<u8>& ret_data);
+
+static bool ApplyDeltaFile(const std::vector<u8>& data, std::vector<u8>& ret_data)
+{
+  DeltaFileHeader header;
+  if (data.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+  const size_t delta_offset = sizeof(header) + header.base_filename_size;
+  if (data.size() < delta_offset)
+    return false;
+  const std::string base_filename(reinterpret_cast<const char*>(data.data() + sizeof(header)),
+                                  header.base_filename_size);
+
+  std::vector<u8> base_buffer;
+  const std::vector<u8>* base = &s_delta_base.buffer;
+  if (s_delta_base.filename != base_filename || s_delta_base.hash != header.base_hash)
+  {
+    if (!ReadStateFile(base_filename, base_buffer) || IsDeltaFile(base_buffer) ||
+        XXH64(base_buffer.data(), base_buffer.size(), 0) != header.base_hash)
+    {
+      Core::DisplayMessage(
+          StringFromFormat("The base state %s of this state is missing or damaged",
+                           base_filename.c_str()),
+          4000);
+      return false;
+    }
+    base = &base_buffer;
+  }
+
+  return ApplyDelta(*base, data.data() + delta_offset, data.size() - delta_offset, ret_data);
+}
+
+static std::string GetDeltaBaseFilename(const std::string& game_id, u64 hash)
+{
+  return StringFromFormat("%sBases/%s_%016" PRIx64 ".sav",
+                          File::GetUserPath(D_STATESAVES_IDX).c_str(), game_id.c_str(), hash);
+}
+
+static std::string GetDeltaRefsFilename(const std::string& base_filename)
+{
+  return base_filename + ".refs";
+}
+
+static bool IsSameDeltaBase(const std::string& a, const std::string& b)
+{
+  // Bases are named after their contents and all live in the same directory.
+  std::string name_a, name_b;
+  SplitPath(a, nullptr, &name_a, nullptr);
+  SplitPath(b, nullptr, &name_b, nullptr);
+  return name_a == name_b;
+}
+
+// Reads which base a delta savestate refers to. The delta file header and the base file name
+// always fit into the first LZO chunk, so the rest of the file isn't read.
+static bool ReadDeltaBaseFilename(const std::string& filename, std::string* base_filename)
+{
+  File::IOFile f(filename, "rb");
+  StateHeader header;
+  if (!f || !f.ReadArray(&header, 1))
+    return false;
+
+  std::vector<u8> buffer;
+  if (header.size != 0)
+  {
+    lzo_uint32 in_len = 0;
+    if (!f.ReadArray(&in_len, 1) || in_len > OUT_LEN)
+      return false;
+    std::vector<u8> in(in_len);
+    if (!f.ReadBytes(in.data(), in_len))
+      return false;
+
+    buffer.resize(std::min<size_t>(IN_LEN, header.size));
+    lzo_uint out_len = buffer.size();
+    if (lzo1x_decompress_safe(in.data(), in_len, buffer.data(), &out_len, nullptr) != LZO_E_OK)
+      return false;
+    buffer.resize(out_len);
+  }
+  else
+  {
+    if (f.GetSize() < sizeof(header))
+      return false;
+    buffer.resize(std::min<u64>(IN_LEN, f.GetSize() - sizeof(header)));
+    if (!f.ReadBytes(buffer.data(), buffer.size()))
+      return false;
+  }
+
+  DeltaFileHeader delta_header;
+  if (!IsDeltaFile(buffer) || buffer.size() < sizeof(delta_header))
+    return false;
+  std::memcpy(&delta_header, buffer.data(), sizeof(delta_header));
+  if (buffer.size() - sizeof(delta_header) < delta_header.base_filename_size)
+    return false;
+  base_filename->assign(reinterpret_cast<const char*>(buffer.data() + sizeof(delta_header)),
+                        delta_header.base_filename_size);
+  return true;
+}
+
+// Each base keeps a list of the savestates which were saved as deltas against it.
+static void AddDeltaRef(const std::string& base_filename, const std::string& filename)
+{
+  const std::string refs_filename = GetDeltaRefsFilename(base_filename);
+  std::string refs;
+  File::ReadFileToString(refs_filename, refs);
+
+  std::vector<std::string> lines;
+  SplitString(refs, '\n', lines);
+  if (std::find(lines.begin(), lines.end(), filename) == lines.end())
+    File::WriteStringToFile(refs + filename + '\n', refs_filename);
+}
+
+// Deletes the bases that no savestate refers to anymore, because all their deltas were
+// overwritten or deleted. Overwriting a slot moves its previous state to lastState.sav, which
+// keeps the base alive as well.
+static void DeleteUnusedDeltaBases()
+{
+  const std::string last_state = File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav";
+  for (const std::string& base_filename :
+       Common::DoFileSearch({".sav"}, {File::GetUserPath(D_STATESAVES_IDX) + "Bases"}))
+  {
+    const std::string refs_filename = GetDeltaRefsFilename(base_filename);
+    std::string refs;
+    File::ReadFileToString(refs_filename, refs);
+
+    std::vector<std::string> candidates;
+    SplitString(refs, '\n', candidates);
+    candidates.push_back(last_state);
+
+    bool used = false;
+    std::string used_refs;
+    for (const std::string& candidate : candidates)
+    {
+      std::string candidate_base;
+      if (candidate.empty() || !ReadDeltaBaseFilename(candidate, &candidate_base) ||
+          !IsSameDeltaBase(candidate_base, base_filename))
+      {
+        continue;
+      }
+
+      used = true;
+      if (candidate != last_state)
+        used_refs += candidate + '\n';
+    }
+
+    // The current base may not have any deltas yet, but it will get them.
+    if (!used && !IsSameDeltaBase(s_delta_base.filename, base_filename))
+    {
+      File::Delete(base_filename);
+      File::Delete(refs_filename);
+    }
+    else if (used_refs != refs)
+    {
+      File::WriteStringToFile(used_refs, refs_filename);
+    }
+  }
+}
+
+static bool CanSaveDelta()
+{
+  return !s_delta_base.buffer.empty() &&
+         s_delta_base.game_id == SConfig::GetInstance().GetGameID() &&
+         s_delta_base.num_deltas < MAX_DELTAS_PER_BASE;
+}
+
+static void WriteStateData(File::IOFile& f, const u8* data, size_t data_size)
+{
+  // Setting up the header
+  StateHeader header;
+  strncpy(header.gameID, SConfig::GetInstance().GetGameID().c_str(), 6);
+  header.size = g_use_compression ? (u32)data_size : 0;
+  header.time = Common::Timer::GetDoubleTime();
+
+  f.WriteArray(&header, 1);
+
+  if (header.size != 0)  // non-zero header size means the state is compressed
+    WriteCompressed(f, data, data_size);
+  else  // uncompressed
+    f.WriteBytes(data, data_size);
+}
+
+// The base is only written once the first delta needs it. The name is unique to its contents, so
+// an existing file can be kept.
+static bool WriteDeltaBase(const DeltaBase& base)
+{
+  if (File::Exists(base.filename))
+    return true;
+
+  File::CreateFullPath(base.filename);
+  File::IOFile f(base.filename, "wb");
+  if (!f)
+    return false;
+  WriteStateData(f, base.buffer.data(), base.buffer.size());
+  return f.IsGood();
+}
+
 static void CompressAndDumpState(CompressAndDumpState_args save_args)
 {
   std::lock_guard<std::mutex> lk(*save_args.buffer_mutex);
@@ -356,50 +838,47 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
     return;
   }
 
-  // Setting up the header
-  StateHeader header;
-  strncpy(header.gameID, SConfig::GetInstance().GetGameID().c_str(), 6);
-  header.size = g_use_compression ? (u32)buffer_size : 0;
-  header.time = Common::Timer::GetDoubleTime();
-
-  f.WriteArray(&header, 1);
-
-  if (header.size != 0)  // non-zero header size means the state is compressed
+  std::vector<u8> delta;
+  if (save_args.delta && CanSaveDelta() && WriteDeltaBase(s_delta_base))
   {
-    lzo_uint i = 0;
-    while (true)
-    {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
-      {
-        cur_len = IN_LEN;
-      }
-
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
-
-      // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
+    delta = CreateDeltaFile(s_delta_base, *save_args.buffer_vector, save_args.memory_offset);
+    // Not worth depending on the base for.
+    if (delta.size() > buffer_size / 2)
+      delta.clear();
+  }
+  const u8* const data = delta.empty() ? buffer_data : delta.data();
+  const size_t data_size = delta.empty() ? buffer_size : delta.size();
 
-      if (cur_len != IN_LEN)
-        break;
+  WriteStateData(f, data, data_size);
 
-      i += cur_len;
-    }
+  if (!delta.empty())
+  {
+    ++s_delta_base.num_deltas;
+    AddDeltaRef(s_delta_base.filename, filename);
   }
-  else  // uncompressed
+  else if (save_args.delta)
+  {
+    // This state is the base for the next ones. The save buffer is only scratch space for the next
+    // save, so it can simply be swapped.
+    s_delta_base.game_id = SConfig::GetInstance().GetGameID();
+    s_delta_base.memory_offset = save_args.memory_offset;
+    s_delta_base.hash = XXH64(buffer_data, buffer_size, 0);
+    s_delta_base.filename = GetDeltaBaseFilename(s_delta_base.game_id, s_delta_base.hash);
+    s_delta_base.num_deltas = 0;
+    s_delta_base.buffer.swap(*save_args.buffer_vector);
+  }
+  else
   {
-    f.WriteBytes(buffer_data, buffer_size);
+    s_delta_base = {};
   }
 
-  Core::DisplayMessage(StringFromFormat("Saved State to %s", filename.c_str()), 2000);
+  // The state that was just written has to be complete before checking what it refers to.
+  f.Close();
+  DeleteUnusedDeltaBases();
+
+  Core::DisplayMessage(StringFromFormat("Saved %sState to %s", delta.empty() ? "" : "Delta ",
+                                        filename.c_str()),
+                       2000);
   Host_UpdateMainFrame();
 }
 
@@ -431,6 +910,8 @@ void SaveAs(const std::string& filename, bool wait)
     save_args.buffer_vector = &g_current_buffer;
     save_args.buffer_mutex = &g_cs_current_buffer;
     save_args.filename = filename;
+    save_args.memory_offset = s_memory_offset;
+    save_args.delta = SConfig::GetInstance().bDeltaSaveStates;
     save_args.wait = wait;
 
     Flush();
@@ -476,14 +957,14 @@ std::string GetInfoStringOfSlot(int slot, bool translate)
   return Common::Timer::GetDateTimeFormatted(header.time);
 }
 
-static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
+// Reads a state file as it is stored, without resolving deltas.
+static bool ReadStateFile(const std::string& filename, std::vector<u8>& ret_data)
 {
-  Flush();
   File::IOFile f(filename, "rb");
   if (!f)
   {
     Core::DisplayMessage("State not found", 2000);
-    return;
+    return false;
   }
 
   StateHeader header;
@@ -493,7 +974,7 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
   {
     Core::DisplayMessage(
         StringFromFormat("State belongs to a different game (ID %.*s)", 6, header.gameID), 2000);
-    return;
+    return false;
   }
 
   std::vector<u8> buffer;
@@ -504,29 +985,8 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
       Core::DisplayMessage("Decompressing State...", 500);
 
     buffer.resize(header.size);
-
-    lzo_uint i = 0;
-    while (true)
-    {
-      lzo_uint32 cur_len = 0;  // number of bytes to read
-      lzo_uint new_len = 0;    // number of bytes to write
-
-      if (!f.ReadArray(&cur_len, 1))
-        break;
-
-      f.ReadBytes(out, cur_len);
-      const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-      if (res != LZO_E_OK)
-      {
-        // This doesn't seem to happen anymore.
-        PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-                    "Try loading the state again",
-                    res, i, new_len);
-        return;
-      }
-
-      i += new_len;
-    }
+    if (!ReadCompressed(f, buffer))
+      return false;
   }
   else  // uncompressed
   {
@@ -536,12 +996,32 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
     if (!f.ReadBytes(&buffer[0], size))
     {
       PanicAlert("wtf? reading bytes: %zu", size);
-      return;
+      return false;
     }
   }
 
   // all good
   ret_data.swap(buffer);
+  return true;
+}
+
+static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
+{
+  Flush();
+
+  std::vector<u8> buffer;
+  if (!ReadStateFile(filename, buffer))
+    return;
+
+  if (IsDeltaFile(buffer))
+  {
+    std::vector<u8> delta;
+    delta.swap(buffer);
+    if (!ApplyDeltaFile(delta, buffer))
+      return;
+  }
+
+  ret_data.swap(buffer);
 }
 
 void LoadAs(const std::string& filename)
@@ -693,6 +1173,8 @@ void Shutdown()
     std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
     std::vector<u8>().swap(g_undo_load_buffer);
   }
+
+  s_delta_base = {};
 }
 
 static std::string MakeStateFilename(int number)
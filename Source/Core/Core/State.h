@@ -53,6 +53,15 @@ void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// Where the hardware state, which starts with RAM, begins in the last state that was saved.
+// Deltas use it to line up the pages of states that differ in size.
+size_t GetLastMemoryOffset();
+
+// Stores the pages of state that differ from base. Applying the delta needs the same base.
+std::vector<u8> CreateDelta(const std::vector<u8>& base, size_t base_memory_offset,
+                            const std::vector<u8>& state, size_t memory_offset);
+bool ApplyDelta(const std::vector<u8>& base, const std::vector<u8>& delta, std::vector<u8>& state);
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
@@ -8,6 +8,9 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
@@ -18,11 +21,13 @@
 #include <zlib.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -31,6 +36,106 @@ namespace DiscIO
 {
 bool IsGCZBlob(File::IOFile& file);
 
+// Decoded chunks are kept in the SectorReader cache, so this bounds its memory use to
+// CACHE_LINES * GCZ_CHUNK_SIZE while letting sequential reads decode several blocks at once.
+static constexpr u32 GCZ_CHUNK_SIZE = 256 * 1024;
+
+static Common::WorkerPool& GetDecompressionPool()
+{
+  static Common::WorkerPool pool("GCZ decompression");
+  return pool;
+}
+
+class CompressedBlobReader::Inflater
+{
+public:
+  Inflater() { m_initialized = inflateInit(&m_stream) == Z_OK; }
+  ~Inflater()
+  {
+    if (m_initialized)
+      inflateEnd(&m_stream);
+  }
+
+  Inflater(const Inflater&) = delete;
+  Inflater& operator=(const Inflater&) = delete;
+
+  // Returns the number of bytes written to out. stream_end is set if the input was a complete
+  // zlib stream.
+  u32 Inflate(const u8* in, u32 in_size, u8* out, u32 out_size, bool* stream_end)
+  {
+    *stream_end = false;
+    if (!m_initialized || inflateReset(&m_stream) != Z_OK)
+      return 0;
+
+    m_stream.next_in = const_cast<u8*>(in);
+    m_stream.avail_in = in_size;
+    m_stream.next_out = out;
+    m_stream.avail_out = out_size;
+    *stream_end = inflate(&m_stream, Z_FULL_FLUSH) == Z_STREAM_END;
+    return out_size - m_stream.avail_out;
+  }
+
+private:
+  z_stream m_stream = {};
+  bool m_initialized;
+};
+
+namespace
+{
+class Deflater
+{
+public:
+  Deflater() { m_initialized = deflateInit(&m_stream, 9) == Z_OK; }
+  ~Deflater()
+  {
+    if (m_initialized)
+      deflateEnd(&m_stream);
+  }
+
+  Deflater(const Deflater&) = delete;
+  Deflater& operator=(const Deflater&) = delete;
+
+  // Sets comp_size to 0 if the block should be stored uncompressed.
+  bool Deflate(const u8* in, u32 in_size, u8* out, u32 out_size, u32* comp_size)
+  {
+    if (!m_initialized || deflateReset(&m_stream) != Z_OK)
+      return false;
+
+    m_stream.next_in = const_cast<u8*>(in);
+    m_stream.avail_in = in_size;
+    m_stream.next_out = out;
+    m_stream.avail_out = out_size;
+    const int status = deflate(&m_stream, Z_FINISH);
+    *comp_size = (status != Z_STREAM_END) || (m_stream.avail_out < 10) ?
+                     0 :
+                     out_size - m_stream.avail_out;
+    return true;
+  }
+
+private:
+  z_stream m_stream = {};
+  bool m_initialized;
+};
+
+struct CompressionBatch
+{
+  u32 first_block = 0;
+  u32 num_blocks = 0;
+  std::vector<u8> in_buf;
+  std::vector<std::vector<u8>> out_bufs;
+  // 0 for blocks that are stored uncompressed
+  std::vector<u32> comp_sizes;
+  std::vector<u32> hashes;
+  std::atomic<bool> failed{false};
+};
+}  // Anonymous namespace
+
+static Common::WorkerPool& GetCompressionPool()
+{
+  static Common::WorkerPool pool("GCZ compression");
+  return pool;
+}
+
 CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string& filename)
     : m_file(std::move(file)), m_file_name(filename)
 {
@@ -39,6 +144,8 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
   m_file.ReadArray(&m_header, 1);
 
   SetSectorSize(m_header.block_size);
+  if (m_header.block_size != 0)
+    SetChunkSize(std::max<int>(1, GCZ_CHUNK_SIZE / m_header.block_size));
 
   // cache block pointers and hashes
   m_block_pointers.resize(m_header.num_blocks);
@@ -50,11 +157,7 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
                   (sizeof(u64)) * m_header.num_blocks     // skip block pointers
                   + (sizeof(u32)) * m_header.num_blocks;  // skip hashes
 
-  // A compressed block is never ever longer than a decompressed block, so just header.block_size
-  // should be fine.
-  // I still add some safety margin.
-  const u32 zlib_buffer_size = m_header.block_size + 64;
-  m_zlib_buffer.resize(zlib_buffer_size);
+  m_inflaters.push_back(std::make_unique<Inflater>());
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
@@ -86,70 +189,104 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
-  u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-  u64 offset = m_block_pointers[block_num] + m_data_offset;
+  return ReadMultipleAlignedBlocks(block_num, 1, out_ptr);
+}
 
-  if (offset & (1ULL << 63))
+bool CompressedBlobReader::ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr)
+{
+  if (num_blocks == 0)
+    return true;
+  if (block_num + num_blocks > m_header.num_blocks)
+    return false;
+
+  // Blocks are stored back to back, so the compressed data of a run of blocks is contiguous.
+  // The top bit of the pointers flags uncompressed blocks and has to be masked off.
+  constexpr u64 UNCOMPRESSED_FLAG = 1ULL << 63;
+  const u64 last_block = block_num + num_blocks - 1;
+  const u64 start = m_block_pointers[block_num] & ~UNCOMPRESSED_FLAG;
+  const u64 end = (m_block_pointers[last_block] & ~UNCOMPRESSED_FLAG) +
+                  static_cast<u32>(GetBlockCompressedSize(last_block));
+  if (end < start || end - start > num_blocks * (m_header.block_size + 64ULL))
   {
-    if (comp_block_size != m_header.block_size)
-      NOTICE_LOG(DISCIO, "Uncompressed block with wrong size");
-    uncompressed = true;
-    offset &= ~(1ULL << 63);
+    NOTICE_LOG(DISCIO, "The disc image \"%s\" has invalid block pointers.", m_file_name.c_str());
+    return false;
   }
 
-  // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
-
-  m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  m_zlib_buffer.resize(static_cast<size_t>(end - start));
+  m_file.Seek(start + m_data_offset, SEEK_SET);
+  if (!m_file.ReadBytes(m_zlib_buffer.data(), m_zlib_buffer.size()))
   {
     NOTICE_LOG(DISCIO, "The disc image \"%s\" is truncated, some of the data is missing.",
-                m_file_name.c_str());
+               m_file_name.c_str());
     m_file.Clear();
     return false;
   }
 
+  if (num_blocks == 1)
+    return DecodeBlock(block_num, m_zlib_buffer.data(), out_ptr, m_inflaters[0].get());
+
+  Common::WorkerPool& pool = GetDecompressionPool();
+  const size_t num_tasks = static_cast<size_t>(std::min<u64>(num_blocks, pool.GetThreadCount()));
+  while (m_inflaters.size() < num_tasks)
+    m_inflaters.push_back(std::make_unique<Inflater>());
+
+  // Each task decodes a contiguous range of blocks with its own zlib stream.
+  std::atomic<bool> success{true};
+  pool.ParallelFor(num_tasks, [&](size_t task) {
+    const u64 first = block_num + num_blocks * task / num_tasks;
+    const u64 last = block_num + num_blocks * (task + 1) / num_tasks;
+    for (u64 i = first; i < last; ++i)
+    {
+      const u64 offset = (m_block_pointers[i] & ~UNCOMPRESSED_FLAG) - start;
+      u8* const out = out_ptr + (i - block_num) * m_header.block_size;
+      if (!DecodeBlock(i, &m_zlib_buffer[offset], out, m_inflaters[task].get()))
+        success = false;
+    }
+  });
+  return success;
+}
+
+bool CompressedBlobReader::DecodeBlock(u64 block_num, const u8* comp_data, u8* out_ptr,
+                                       Inflater* inflater)
+{
+  u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
+  const bool uncompressed = (m_block_pointers[block_num] & (1ULL << 63)) != 0;
+
+  if (uncompressed && comp_block_size != m_header.block_size)
+    NOTICE_LOG(DISCIO, "Uncompressed block with wrong size");
+
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(comp_data, comp_block_size);
   if (block_hash != m_hashes[block_num])
     NOTICE_LOG(DISCIO, "The disc image \"%s\" is corrupt.\n"
-                "Hash of block %" PRIu64 " is %08x instead of %08x.",
-                m_file_name.c_str(),
-                block_num, block_hash, m_hashes[block_num]);
-
-	if (uncompressed)
-	{
-		std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
-	}
-	else
-	{
-		z_stream z = {};
-		z.next_in  = m_zlib_buffer.data();
-		z.avail_in = comp_block_size;
-		if (z.avail_in > m_header.block_size)
-		{
-			NOTICE_LOG(DISCIO, "We have a problem");
-		}
-		z.next_out  = out_ptr;
-		z.avail_out = m_header.block_size;
-		inflateInit(&z);
-		int status = inflate(&z, Z_FULL_FLUSH);
-		u32 uncomp_size = m_header.block_size - z.avail_out;
-		if (status != Z_STREAM_END)
-		{
-			// this seem to fire wrongly from time to time
-			// to be sure, don't use compressed isos :P
-			NOTICE_LOG(DISCIO, "Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
-		}
-		inflateEnd(&z);
-		if (uncomp_size != m_header.block_size)
-		{
-			NOTICE_LOG(DISCIO, "Wrong block size");
-			return false;
-		}
-	}
-	return true;
+                       "Hash of block %" PRIu64 " is %08x instead of %08x.",
+               m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
+
+  if (uncompressed)
+  {
+    std::copy(comp_data, comp_data + std::min(comp_block_size, m_header.block_size), out_ptr);
+    return true;
+  }
+
+  if (comp_block_size > m_header.block_size)
+    NOTICE_LOG(DISCIO, "We have a problem");
+
+  bool stream_end;
+  const u32 uncomp_size =
+      inflater->Inflate(comp_data, comp_block_size, out_ptr, m_header.block_size, &stream_end);
+  if (!stream_end)
+  {
+    // this seem to fire wrongly from time to time
+    // to be sure, don't use compressed isos :P
+    NOTICE_LOG(DISCIO, "Failure reading block %" PRIu64 " - out of data and not at end.",
+               block_num);
+  }
+  if (uncomp_size != m_header.block_size)
+  {
+    NOTICE_LOG(DISCIO, "Wrong block size");
+    return false;
+  }
+  return true;
 }
 
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
@@ -193,10 +330,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -210,8 +343,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -220,93 +351,155 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   // seek to the start of the input file to make sure we get everything
   infile.Seek(0, SEEK_SET);
 
+  // The blocks go through a three stage pipeline: this thread reads batch n + 1 and writes
+  // batch n - 1 in order while the worker pool deflates batch n. Every block is still
+  // compressed independently with the same settings, so the output is identical to what a
+  // single thread produces.
+  Common::WorkerPool& pool = GetCompressionPool();
+  const u32 blocks_per_batch = std::max<u32>(16, static_cast<u32>(pool.GetThreadCount()) * 4);
+  const u32 num_batches = (header.num_blocks + blocks_per_batch - 1) / blocks_per_batch;
+  std::array<CompressionBatch, 3> batches;
+  std::vector<std::unique_ptr<Deflater>> deflaters;
+  for (size_t i = 0; i < std::min<size_t>(blocks_per_batch, pool.GetThreadCount()); ++i)
+    deflaters.push_back(std::make_unique<Deflater>());
+
+  const auto read_batch = [&](CompressionBatch& batch, u32 first_block) {
+    batch.first_block = first_block;
+    batch.num_blocks = std::min(blocks_per_batch, header.num_blocks - first_block);
+    batch.in_buf.resize(static_cast<size_t>(batch.num_blocks) * block_size);
+    batch.out_bufs.resize(batch.num_blocks);
+    batch.comp_sizes.resize(batch.num_blocks);
+    batch.hashes.resize(batch.num_blocks);
+
+    for (u32 i = 0; i < batch.num_blocks; ++i)
+    {
+      u8* const in_buf = &batch.in_buf[static_cast<size_t>(i) * block_size];
+      size_t read_bytes;
+      if (scrubbing)
+        read_bytes = disc_scrubber.GetNextBlock(infile, in_buf);
+      else
+        infile.ReadArray(in_buf, header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in_buf + read_bytes, in_buf + header.block_size, 0);
+    }
+  };
+
+  const auto compress_batch = [&](CompressionBatch& batch) {
+    batch.failed = false;
+    const size_t num_tasks = std::min<size_t>(batch.num_blocks, deflaters.size());
+    pool.ParallelFor(num_tasks, [&](size_t task) {
+      for (u32 i = static_cast<u32>(batch.num_blocks * task / num_tasks);
+           i < batch.num_blocks * (task + 1) / num_tasks; ++i)
+      {
+        u8* const in_buf = &batch.in_buf[static_cast<size_t>(i) * block_size];
+        std::vector<u8>& out_buf = batch.out_bufs[i];
+        out_buf.resize(block_size);
+
+        u32 comp_size;
+        if (!deflaters[task]->Deflate(in_buf, block_size, out_buf.data(), block_size, &comp_size))
+        {
+          batch.failed = true;
+          return;
+        }
+        batch.comp_sizes[i] = comp_size;
+        batch.hashes[i] = comp_size != 0 ? HashAdler32(out_buf.data(), comp_size) :
+                                           HashAdler32(in_buf, block_size);
+      }
+    });
+  };
+
   // Now we are ready to write compressed data!
   u64 position = 0;
+  u64 bytes_read = 0;
   int num_compressed = 0;
   int num_stored = 0;
-  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
+  const u32 progress_monitor = std::max<u32>(1, header.num_blocks / 1000);
   bool success = true;
+  const auto start_time = std::chrono::steady_clock::now();
 
-  for (u32 i = 0; i < header.num_blocks; i++)
-  {
-    if (i % progress_monitor == 0)
+  const auto write_batch = [&](const CompressionBatch& batch) {
+    if (batch.failed)
     {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
+      ERROR_LOG(DISCIO, "Deflate failed");
+      return false;
     }
 
-    offsets[i] = position;
-
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
+    for (u32 i = 0; i < batch.num_blocks; ++i)
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
+      const u32 block = batch.first_block + i;
+      offsets[block] = position;
+
+      const u8* write_buf;
+      int write_size;
+      if (batch.comp_sizes[i] == 0)
+      {
+        // let's store uncompressed
+        write_buf = &batch.in_buf[static_cast<size_t>(i) * block_size];
+        offsets[block] |= 0x8000000000000000ULL;
+        write_size = block_size;
+        num_stored++;
+      }
+      else
+      {
+        // let's store compressed
+        write_buf = batch.out_bufs[i].data();
+        write_size = batch.comp_sizes[i];
+        num_compressed++;
+      }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
+      if (!outfile.WriteBytes(write_buf, write_size))
+      {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
+        return false;
+      }
 
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
+      position += write_size;
+      hashes[block] = batch.hashes[i];
     }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
+    bytes_read += static_cast<u64>(batch.num_blocks) * block_size;
+    const u32 blocks_done = batch.first_block + batch.num_blocks;
+    if (blocks_done / progress_monitor == batch.first_block / progress_monitor)
+      return true;
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::string temp =
+        StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(),
+                         blocks_done, header.num_blocks, (int)(100 * position / bytes_read));
+    if (seconds > 0)
+      temp += StringFromFormat(" (%.1f MiB/s)", bytes_read / seconds / (1024 * 1024));
+    return callback(temp, (float)blocks_done / (float)header.num_blocks, arg);
+  };
+
+  if (num_batches > 0)
+    read_batch(batches[0], 0);
+
+  // Shared with the jobs so that a job can still touch it after Wait() has returned.
+  auto compressed = std::make_shared<Common::Event>();
+  for (u32 n = 0; n < num_batches; ++n)
+  {
+    pool.Push([&compress_batch, &batches, compressed, n] {
+      compress_batch(batches[n % batches.size()]);
+      compressed->Set();
+    });
+
+    if (n > 0 && success)
+      success = write_batch(batches[(n - 1) % batches.size()]);
+    if (n + 1 < num_batches && success)
+      read_batch(batches[(n + 1) % batches.size()], (n + 1) * blocks_per_batch);
+
+    // The job refers to our locals, so it has to finish even if we bail out.
+    compressed->Wait();
+    if (!success)
       break;
-    }
-
-    position += write_size;
-
-    hashes[i] = HashAdler32(write_buf, write_size);
   }
 
+  if (num_batches > 0 && success)
+    success = write_batch(batches[(num_batches - 1) % batches.size()]);
+
   header.compressed_data_size = position;
 
   if (!success)
@@ -324,9 +517,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -365,38 +555,79 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
     return false;
   }
 
+  // Like compression, this is pipelined: a job on the compression pool decodes buffer n (the
+  // reader itself inflates the blocks of each chunk in parallel) while this thread writes
+  // buffer n - 1.
   const CompressedBlobHeader& header = reader->GetHeader();
-  static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-  int progress_monitor = std::max<int>(1, num_buffers / 100);
+  static const size_t BUFFER_BLOCKS = 64;
+  const u64 buffer_size = static_cast<u64>(header.block_size) * BUFFER_BLOCKS;
+  const u64 total_size = static_cast<u64>(header.block_size) * header.num_blocks;
+  std::array<std::vector<u8>, 2> buffers;
+  for (std::vector<u8>& buffer : buffers)
+    buffer.resize(static_cast<size_t>(buffer_size));
+  const u64 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
+  const auto get_size = [&](u64 i) { return std::min(buffer_size, total_size - i * buffer_size); };
+  const u64 progress_monitor = std::max<u64>(1, num_buffers / 100);
+
+  Common::WorkerPool& pool = GetCompressionPool();
+  auto decoded = std::make_shared<Common::Event>();
+  std::atomic<bool> read_success{true};
+  const auto start_time = std::chrono::steady_clock::now();
   bool success = true;
 
   for (u64 i = 0; i < num_buffers; i++)
   {
-    if (i % progress_monitor == 0)
+    pool.Push([&reader, &buffers, &read_success, &get_size, buffer_size, decoded, i] {
+      if (!reader->Read(i * buffer_size, get_size(i), buffers[i % buffers.size()].data()))
+        read_success = false;
+      decoded->Set();
+    });
+
+    if (i > 0)
     {
-      bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
-      if (was_cancelled)
+      const u64 sz = get_size(i - 1);
+      const bool report_progress = i % progress_monitor == 0;
+      if (!outfile.WriteBytes(buffers[(i - 1) % buffers.size()].data(), sz))
       {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
         success = false;
-        break;
+      }
+      else if (report_progress)
+      {
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        const std::string text =
+            seconds > 0 ? GetStringT("Unpacking") +
+                              StringFromFormat(" (%.1f MiB/s)",
+                                               i * buffer_size / seconds / (1024 * 1024)) :
+                          GetStringT("Unpacking");
+        success = callback(text, (float)i / (float)num_buffers, arg);
       }
     }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
+
+    // The job refers to our locals, so it has to finish even if we bail out.
+    decoded->Wait();
+    if (!success)
+      break;
+  }
+
+  if (success && num_buffers > 0)
+  {
+    const u64 sz = get_size(num_buffers - 1);
+    if (!outfile.WriteBytes(buffers[(num_buffers - 1) % buffers.size()].data(), sz))
     {
       PanicAlertT("Failed to write the output file \"%s\".\n"
                   "Check that you have enough space available on the target drive.",
                   outfile_path.c_str());
       success = false;
-      break;
     }
   }
 
+  if (!read_success)
+    ERROR_LOG(DISCIO, "Failed to read some blocks of \"%s\".", infile_path.c_str());
+
   if (!success)
   {
     // Remove the incomplete output file.
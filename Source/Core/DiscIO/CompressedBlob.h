@@ -54,16 +54,28 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+protected:
+  // Reads the compressed data of all blocks with a single file access and inflates the blocks
+  // in parallel on a shared worker pool.
+  bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr) override;
+
 private:
+  class Inflater;
+
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
+  bool DecodeBlock(u64 block_num, const u8* comp_data, u8* out_ptr, Inflater* inflater);
+
   CompressedBlobHeader m_header;
   std::vector<u64> m_block_pointers;
   std::vector<u32> m_hashes;
   int m_data_offset;
   File::IOFile m_file;
   u64 m_file_size;
+  // Compressed data of the blocks currently being decoded
   std::vector<u8> m_zlib_buffer;
+  // One zlib stream per parallel decoding task, reused across reads
+  std::vector<std::unique_ptr<Inflater>> m_inflaters;
   std::string m_file_name;
 };
 
@@ -18,9 +18,11 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/WorkerPool.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/Enums.h"
@@ -31,8 +33,18 @@ namespace DiscIO
 {
 constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
 
+// Decrypting a single cluster is too quick for handing it to another thread to pay off.
+constexpr size_t MIN_CLUSTERS_FOR_THREADING = 4;
+
+static Common::WorkerPool& GetDecryptionPool()
+{
+  static Common::WorkerPool pool("Wii decryption");
+  return pool;
+}
+
 CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader)
-    : m_pReader(std::move(reader)), m_game_partition(PARTITION_NONE), m_last_decrypted_block(-1)
+    : m_pReader(std::move(reader)), m_game_partition(PARTITION_NONE),
+      m_cluster_cache(CLUSTER_CACHE_SIZE)
 {
   _assert_(m_pReader);
 
@@ -123,40 +135,49 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer,
   auto it = m_partition_keys.find(partition);
   if (it == m_partition_keys.end())
     return false;
-  mbedtls_aes_context* aes_context = it->second.get();
+  const mbedtls_aes_context* aes_context = it->second.get();
 
-  std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
   while (_Length > 0)
   {
     // Calculate offsets
-    u64 block_offset_on_disc =
-        partition.offset + PARTITION_DATA_OFFSET + _ReadOffset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
-    u64 data_offset_in_block = _ReadOffset % BLOCK_DATA_SIZE;
+    const u64 cluster = _ReadOffset / BLOCK_DATA_SIZE;
+    const u64 block_offset_on_disc =
+        partition.offset + PARTITION_DATA_OFFSET + cluster * BLOCK_TOTAL_SIZE;
+    const u64 data_offset_in_block = _ReadOffset % BLOCK_DATA_SIZE;
 
-    if (m_last_decrypted_block != block_offset_on_disc)
+    u64 copy_size;
+    if (const DecryptedCluster* cached = FindCachedCluster(block_offset_on_disc))
     {
-      // Read the current block
-      if (!m_pReader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, read_buffer.data()))
+      copy_size = std::min(_Length, BLOCK_DATA_SIZE - data_offset_in_block);
+      memcpy(_pBuffer, &cached->data[data_offset_in_block], static_cast<size_t>(copy_size));
+    }
+    else
+    {
+      // Decrypt the rest of the read in one go, stopping early at clusters we already have.
+      const u64 last_cluster = (_ReadOffset + _Length - 1) / BLOCK_DATA_SIZE;
+      size_t count = 1;
+      while (count < MAX_CLUSTERS_PER_BATCH && cluster + count <= last_cluster &&
+             !FindCachedCluster(block_offset_on_disc + count * BLOCK_TOTAL_SIZE))
+      {
+        ++count;
+      }
+
+      m_decrypted_buffer.resize(count * BLOCK_DATA_SIZE);
+      if (!DecryptClusters(block_offset_on_disc, count, aes_context, m_decrypted_buffer.data()))
         return false;
 
-      // Decrypt the block's data.
-      // 0x3D0 - 0x3DF in read_buffer will be overwritten,
-      // but that won't affect anything, because we won't
-      // use the content of read_buffer anymore after this
-      mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, &read_buffer[0x3D0],
-                            &read_buffer[BLOCK_HEADER_SIZE], m_last_decrypted_block_data);
-      m_last_decrypted_block = block_offset_on_disc;
-
-      // The only thing we currently use from the 0x000 - 0x3FF part
-      // of the block is the IV (at 0x3D0), but it also contains SHA-1
-      // hashes that IOS uses to check that discs aren't tampered with.
-      // http://wiibrew.org/wiki/Wii_Disc#Encrypted
-    }
+      copy_size = std::min(_Length, count * BLOCK_DATA_SIZE - data_offset_in_block);
+      memcpy(_pBuffer, &m_decrypted_buffer[data_offset_in_block], static_cast<size_t>(copy_size));
 
-    // Copy the decrypted data
-    u64 copy_size = std::min(_Length, BLOCK_DATA_SIZE - data_offset_in_block);
-    memcpy(_pBuffer, &m_last_decrypted_block_data[data_offset_in_block],
-           static_cast<size_t>(copy_size));
+      // Clusters in the middle of a large read are unlikely to be wanted again soon, but the
+      // ones at the edges usually are, by the next read of the same file.
+      CacheCluster(block_offset_on_disc, &m_decrypted_buffer[0]);
+      if (count > 1)
+      {
+        CacheCluster(block_offset_on_disc + (count - 1) * BLOCK_TOTAL_SIZE,
+                     &m_decrypted_buffer[(count - 1) * BLOCK_DATA_SIZE]);
+      }
+    }
 
     // Update offsets
     _Length -= copy_size;
@@ -167,6 +188,62 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer,
   return true;
 }
 
+bool CVolumeWiiCrypted::DecryptClusters(u64 block_offset_on_disc, size_t count,
+                                        const mbedtls_aes_context* aes_context, u8* out) const
+{
+  // The clusters are contiguous on disc, so they can all be fetched with a single read
+  m_raw_buffer.resize(count * BLOCK_TOTAL_SIZE);
+  if (!m_pReader->Read(block_offset_on_disc, m_raw_buffer.size(), m_raw_buffer.data()))
+    return false;
+
+  // The only thing we currently use from the 0x000 - 0x3FF part
+  // of the block is the IV (at 0x3D0), but it also contains SHA-1
+  // hashes that IOS uses to check that discs aren't tampered with.
+  // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+  const auto decrypt = [&](size_t i) {
+    const u8* block = &m_raw_buffer[i * BLOCK_TOTAL_SIZE];
+    Common::AES::DecryptCBC(aes_context, &block[0x3D0], &block[BLOCK_HEADER_SIZE],
+                            &out[i * BLOCK_DATA_SIZE], BLOCK_DATA_SIZE);
+  };
+
+  if (count < MIN_CLUSTERS_FOR_THREADING)
+  {
+    for (size_t i = 0; i < count; ++i)
+      decrypt(i);
+  }
+  else
+  {
+    GetDecryptionPool().ParallelFor(count, decrypt);
+  }
+
+  return true;
+}
+
+const CVolumeWiiCrypted::DecryptedCluster*
+CVolumeWiiCrypted::FindCachedCluster(u64 block_offset_on_disc) const
+{
+  for (DecryptedCluster& entry : m_cluster_cache)
+  {
+    if (entry.offset_on_disc == block_offset_on_disc)
+    {
+      entry.last_used = ++m_cache_clock;
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void CVolumeWiiCrypted::CacheCluster(u64 block_offset_on_disc, const u8* data) const
+{
+  auto least_recently_used = std::min_element(
+      m_cluster_cache.begin(), m_cluster_cache.end(),
+      [](const DecryptedCluster& a, const DecryptedCluster& b) { return a.last_used < b.last_used; });
+
+  least_recently_used->offset_on_disc = block_offset_on_disc;
+  least_recently_used->last_used = ++m_cache_clock;
+  std::copy(data, data + BLOCK_DATA_SIZE, least_recently_used->data.begin());
+}
+
 std::vector<Partition> CVolumeWiiCrypted::GetPartitions() const
 {
   std::vector<Partition> partitions;
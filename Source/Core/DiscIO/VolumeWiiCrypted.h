@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <limits>
 #include <map>
 #include <mbedtls/aes.h>
 #include <memory>
@@ -63,14 +65,35 @@ public:
   static constexpr unsigned int BLOCK_TOTAL_SIZE = BLOCK_HEADER_SIZE + BLOCK_DATA_SIZE;
 
 private:
+  struct DecryptedCluster
+  {
+    u64 offset_on_disc = std::numeric_limits<u64>::max();
+    u64 last_used = 0;
+    std::array<u8, BLOCK_DATA_SIZE> data;
+  };
+
+  // Reads count consecutive clusters starting at block_offset_on_disc and decrypts their data
+  // into out, which must have room for count * BLOCK_DATA_SIZE bytes.
+  bool DecryptClusters(u64 block_offset_on_disc, size_t count,
+                       const mbedtls_aes_context* aes_context, u8* out) const;
+  const DecryptedCluster* FindCachedCluster(u64 block_offset_on_disc) const;
+  void CacheCluster(u64 block_offset_on_disc, const u8* data) const;
+
+  // Enough to keep the clusters of a few files that are being streamed at the same time.
+  static constexpr size_t CLUSTER_CACHE_SIZE = 16;
+  // Upper bound on how many uncached clusters a single read decrypts at once (2 MiB on disc).
+  static constexpr size_t MAX_CLUSTERS_PER_BATCH = 64;
+
   std::unique_ptr<IBlobReader> m_pReader;
   std::map<Partition, std::unique_ptr<mbedtls_aes_context>> m_partition_keys;
   std::map<Partition, IOS::ES::TicketReader> m_partition_tickets;
   std::map<Partition, IOS::ES::TMDReader> m_partition_tmds;
   Partition m_game_partition;
 
-  mutable u64 m_last_decrypted_block;
-  mutable u8 m_last_decrypted_block_data[BLOCK_DATA_SIZE];
+  mutable std::vector<DecryptedCluster> m_cluster_cache;
+  mutable u64 m_cache_clock = 0;
+  mutable std::vector<u8> m_raw_buffer;
+  mutable std::vector<u8> m_decrypted_buffer;
 };
 
 }  // namespace
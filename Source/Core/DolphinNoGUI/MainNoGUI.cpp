@@ -16,22 +16,26 @@
 #include "Common/Flag.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 
 #include "Core/Analytics.h"
 #include "Core/BootManager.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/FifoPlayer/FifoBenchmark.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/STM/STM.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/USB/Bluetooth/WiimoteDevice.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "UICommon/CommandLineParse.h"
 #include "UICommon/UICommon.h"
 
+#include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VR.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -290,6 +294,8 @@ class PlatformX11 : public Platform
           }
           else if (key == XK_F9)
             Core::SaveScreenShot();
+          else if (key == XK_F10)
+            Rewind::StepBack();
           else if (key == XK_F11)
             State::LoadLastSaved();
           else if (key == XK_F12)
@@ -375,6 +381,25 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
   auto parser = CommandLineParse::CreateParser(CommandLineParse::ParserOptions::OmitGUIOptions);
+  parser->add_option("--fifo-benchmark")
+      .action("store")
+      .metavar("<report>")
+      .help("Replay a FIFO log as fast as possible and write per-frame timings to a JSON or CSV "
+            "report");
+  parser->add_option("--fifo-frame-start")
+      .action("store")
+      .type("int")
+      .set_default(0)
+      .help("First FIFO log frame to benchmark");
+  parser->add_option("--fifo-frame-end")
+      .action("store")
+      .type("int")
+      .set_default(0)
+      .help("FIFO log frame to stop benchmarking at (exclusive, 0 for the whole log)");
+  parser->add_option("--pack-textures")
+      .action("store")
+      .metavar("<game id>")
+      .help("Pack the custom textures of a game into a single archive and exit");
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
@@ -388,7 +413,7 @@ int main(int argc, char* argv[])
     boot_filename = args.front();
     args.erase(args.begin());
   }
-  else
+  else if (!options.is_set("pack_textures"))
   {
     parser->print_help();
     return 0;
@@ -400,6 +425,21 @@ int main(int argc, char* argv[])
     user_directory = static_cast<const char*>(options.get("user"));
   }
 
+  if (options.is_set("pack_textures"))
+  {
+    const std::string game_id = static_cast<const char*>(options.get("pack_textures"));
+    UICommon::SetUserDirectory(user_directory);
+    UICommon::Init();
+    const bool success = HiresTexture::PackArchive(game_id);
+    UICommon::Shutdown();
+    if (!success)
+    {
+      fprintf(stderr, "Could not pack the custom textures of %s\n", game_id.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
   platform = GetPlatform();
   if (!platform)
   {
@@ -423,6 +463,22 @@ int main(int argc, char* argv[])
 
   DolphinAnalytics::Instance()->ReportDolphinStart("nogui");
 
+  if (options.is_set("fifo_benchmark"))
+  {
+    if (!StringEndsWith(boot_filename, ".dff") && !StringEndsWith(boot_filename, ".DFF"))
+    {
+      fprintf(stderr, "--fifo-benchmark requires a FIFO log (.dff), got %s\n",
+              boot_filename.c_str());
+      return 1;
+    }
+
+    FifoBenchmark::Options benchmark;
+    benchmark.report_path = static_cast<const char*>(options.get("fifo_benchmark"));
+    benchmark.frame_start = static_cast<int>(options.get("fifo_frame_start"));
+    benchmark.frame_end = static_cast<int>(options.get("fifo_frame_end"));
+    FifoBenchmark::Start(benchmark);
+  }
+
   if (!BootManager::BootCore(boot_filename, SConfig::BOOT_DEFAULT))
   {
     fprintf(stderr, "Could not boot %s\n", boot_filename.c_str());
@@ -440,6 +496,8 @@ int main(int argc, char* argv[])
   Core::Stop();
 
   Core::Shutdown();
+  if (FifoBenchmark::IsActive() && !FifoBenchmark::Finish())
+    fprintf(stderr, "Could not write the FIFO benchmark report\n");
   platform->Shutdown();
   UICommon::Shutdown();
 
@@ -20,6 +20,7 @@
 #include "Core/HotkeyManager.h"
 #include "Core/Movie.h"
 #include "Core/NetPlayProto.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DolphinQt2/AboutDialog.h"
@@ -101,6 +102,7 @@ void MainWindow::ConnectMenuBar()
   connect(m_menu_bar, &MenuBar::Reset, this, &MainWindow::Reset);
   connect(m_menu_bar, &MenuBar::Fullscreen, this, &MainWindow::FullScreen);
   connect(m_menu_bar, &MenuBar::FrameAdvance, this, &MainWindow::FrameAdvance);
+  connect(m_menu_bar, &MenuBar::Rewind, this, &MainWindow::Rewind);
   connect(m_menu_bar, &MenuBar::Screenshot, this, &MainWindow::ScreenShot);
   connect(m_menu_bar, &MenuBar::StateLoad, this, &MainWindow::StateLoad);
   connect(m_menu_bar, &MenuBar::StateSave, this, &MainWindow::StateSave);
@@ -264,6 +266,12 @@ void MainWindow::FrameAdvance()
   EmulationPaused();
 }
 
+void MainWindow::Rewind()
+{
+  if (Rewind::StepBack())
+    EmulationPaused();
+}
+
 void MainWindow::FullScreen()
 {
   // If the render widget is fullscreen we want to reset it to whatever is in
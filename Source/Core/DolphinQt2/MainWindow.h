@@ -40,6 +40,7 @@ private slots:
   void ForceStop();
   void Reset();
   void FrameAdvance();
+  void Rewind();
   void StateLoad();
   void StateSave();
   void StateLoadSlot();
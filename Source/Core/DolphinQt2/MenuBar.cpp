@@ -39,6 +39,7 @@ void MenuBar::EmulationStarted()
   m_reset_action->setEnabled(true);
   m_fullscreen_action->setEnabled(true);
   m_frame_advance_action->setEnabled(true);
+  m_rewind_action->setEnabled(true);
   m_screenshot_action->setEnabled(true);
   m_state_load_menu->setEnabled(true);
   m_state_save_menu->setEnabled(true);
@@ -62,6 +63,7 @@ void MenuBar::EmulationStopped()
   m_reset_action->setEnabled(false);
   m_fullscreen_action->setEnabled(false);
   m_frame_advance_action->setEnabled(false);
+  m_rewind_action->setEnabled(false);
   m_screenshot_action->setEnabled(false);
   m_state_load_menu->setEnabled(false);
   m_state_save_menu->setEnabled(false);
@@ -90,6 +92,7 @@ void MenuBar::AddEmulationMenu()
   m_reset_action = emu_menu->addAction(tr("Reset"), this, SIGNAL(Reset()));
   m_fullscreen_action = emu_menu->addAction(tr("Fullscreen"), this, SIGNAL(Fullscreen()));
   m_frame_advance_action = emu_menu->addAction(tr("Frame Advance"), this, SIGNAL(FrameAdvance()));
+  m_rewind_action = emu_menu->addAction(tr("Rewind"), this, SIGNAL(Rewind()));
   m_screenshot_action = emu_menu->addAction(tr("Take Screenshot"), this, SIGNAL(Screenshot()));
   AddStateLoadMenu(emu_menu);
   AddStateSaveMenu(emu_menu);
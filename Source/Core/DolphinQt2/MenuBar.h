@@ -26,6 +26,7 @@ signals:
   void Reset();
   void Fullscreen();
   void FrameAdvance();
+  void Rewind();
   void Screenshot();
   void StateLoad();
   void StateSave();
@@ -83,6 +84,7 @@ private:
   QAction* m_reset_action;
   QAction* m_fullscreen_action;
   QAction* m_frame_advance_action;
+  QAction* m_rewind_action;
   QAction* m_screenshot_action;
   QMenu* m_state_load_menu;
   QMenu* m_state_save_menu;
@@ -54,6 +54,7 @@
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/USB/Bluetooth/BTBase.h"
 #include "Core/Movie.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DolphinWX/Config/ConfigMain.h"
@@ -1968,6 +1969,8 @@ void CFrame::ParseHotkeys()
     State::UndoLoadState();
   if (IsHotkey(HK_UNDO_SAVE_STATE))
     State::UndoSaveState();
+  if (IsHotkey(HK_REWIND, true))
+    Rewind::StepBack();
 }
 
 void CFrame::HandleFrameSkipHotkeys()
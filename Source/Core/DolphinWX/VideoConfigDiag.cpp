@@ -323,6 +323,15 @@ static wxString gpu_texture_decoding_desc =
     wxTRANSLATE("Enables texture decoding using the GPU instead of the CPU. This may result in "
                 "performance gains in some scenarios, or on systems where the CPU is the "
                 "bottleneck.\n\nIf unsure, leave this unchecked.");
+static wxString texture_write_tracking_desc =
+    wxTRANSLATE("Watches for the emulated CPU writing to texture memory, so that textures which "
+                "weren't written to don't need to be hashed again. Requires fastmem, and has no "
+                "effect on macOS.\n\nIf unsure, leave this unchecked.");
+static wxString background_shader_compiling_desc =
+    wxTRANSLATE("Compiles new shaders on background threads instead of pausing the emulation. "
+                "Until a shader is ready, the object is drawn with a slower generic shader, which "
+                "reduces stuttering at the cost of GPU performance.\n\nIf unsure, leave this "
+                "unchecked.");
 
 #if !defined(__APPLE__)
 // Search for available resolutions - TODO: Move to Common?
@@ -534,6 +543,13 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string& title)
                                         wxGetTranslation(backend_multithreading_desc),
                                         vconfig.bBackendMultithreading));
         }
+
+        if (vconfig.backend_info.bSupportsBackgroundShaderCompiling)
+        {
+          szr_other->Add(CreateCheckBox(page_general, _("Compile Shaders in Background"),
+                                        wxGetTranslation(background_shader_compiling_desc),
+                                        vconfig.bBackgroundShaderCompiling));
+        }
       }
 
       wxStaticBoxSizer* const group_basic =
@@ -839,6 +855,11 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string& title)
                          1, wxEXPAND | wxLEFT | wxRIGHT, space5);
       }
 
+      szr_safetex->Add(CreateCheckBox(page_hacks, _("Track Texture Writes"),
+                                      wxGetTranslation(texture_write_tracking_desc),
+                                      vconfig.bTextureWriteTracking),
+                       1, wxEXPAND | wxLEFT | wxRIGHT, space5);
+
       if (slider_pos == -1)
       {
         stc_slider->Disable();
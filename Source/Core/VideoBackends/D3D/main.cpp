@@ -78,6 +78,7 @@ void VideoBackend::InitBackendInfo()
   g_Config.backend_info.bSupportsInternalResolutionFrameDumps = false;
   g_Config.backend_info.bSupportsGPUTextureDecoding = false;
   g_Config.backend_info.bSupportsST3CTextures = false;
+  g_Config.backend_info.bSupportsBackgroundShaderCompiling = false;
 
   IDXGIFactory* factory;
   IDXGIAdapter* ad;
@@ -4,16 +4,26 @@
 
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/Align.h"
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/GL/GLInterfaceBase.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/WorkerPool.h"
 
 #include "Core/ConfigManager.h"
+#include "Core/Host.h"
 
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
@@ -21,6 +31,7 @@
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -34,16 +45,30 @@ u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static std::unique_ptr<StreamBuffer> s_buffer;
-static int num_failures = 0;
+static std::atomic<int> num_failures{0};
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
 static GLuint CurrentProgram = 0;
 ProgramShaderCache::PCache ProgramShaderCache::pshaders;
+std::map<UBERSHADERUID, SHADER> ProgramShaderCache::s_uber_shaders;
 ProgramShaderCache::PCacheEntry* ProgramShaderCache::last_entry;
 SHADERUID ProgramShaderCache::last_uid;
 
 static std::string s_glsl_header = "";
 
+// Programs are linked on a thread with its own shared context, and handed back to the video
+// thread through s_compiled_programs.
+struct CompiledProgram
+{
+  SHADERUID uid;
+  SHADER shader;
+  bool success;
+};
+static std::unique_ptr<cInterfaceBase> s_shared_context;
+static std::unique_ptr<Common::WorkerPool> s_compile_pool;
+static std::mutex s_compiled_programs_lock;
+static std::vector<CompiledProgram> s_compiled_programs;
+
 static std::string GetGLSLVersionString()
 {
   GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -184,6 +209,9 @@ void ProgramShaderCache::UploadConstants(bool force_upload)
 
 SHADER* ProgramShaderCache::SetShader(u32 primitive_type)
 {
+  if (s_compile_pool)
+    RetrieveAsyncShaders();
+
   SHADERUID uid;
   GetShaderId(&uid, primitive_type);
 
@@ -192,6 +220,9 @@ SHADER* ProgramShaderCache::SetShader(u32 primitive_type)
   {
     if (uid == last_uid)
     {
+      if (last_entry->pending)
+        return SetUberShader(primitive_type);
+
       GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
       last_entry->shader.Bind();
       return &last_entry->shader;
@@ -206,6 +237,8 @@ SHADER* ProgramShaderCache::SetShader(u32 primitive_type)
   {
     PCacheEntry* entry = &iter->second;
     last_entry = entry;
+    if (entry->pending)
+      return SetUberShader(primitive_type);
 
     GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
     last_entry->shader.Bind();
@@ -244,6 +277,13 @@ SHADER* ProgramShaderCache::SetShader(u32 primitive_type)
   }
 #endif
 
+  if (s_compile_pool && g_ActiveConfig.UseBackgroundShaderCompiling())
+  {
+    newentry.pending = true;
+    QueueCompile(uid, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+    return SetUberShader(primitive_type);
+  }
+
   if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
   {
     GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
@@ -258,8 +298,92 @@ SHADER* ProgramShaderCache::SetShader(u32 primitive_type)
   return &last_entry->shader;
 }
 
+SHADER* ProgramShaderCache::SetUberShader(u32 primitive_type)
+{
+  UBERSHADERUID uid;
+  uid.vuid = GetUberVertexShaderUid();
+  uid.puid = GetUberPixelShaderUid();
+  uid.guid = GetGeometryShaderUid(primitive_type);
+
+  // Only a handful of ubershaders are needed, so they are compiled right away.
+  auto iter = s_uber_shaders.find(uid);
+  if (iter == s_uber_shaders.end())
+  {
+    SHADER& shader = s_uber_shaders[uid];
+    ShaderCode vcode = GenerateUberVertexShaderCode(APIType::OpenGL, uid.vuid.GetUidData());
+    ShaderCode pcode = GenerateUberPixelShaderCode(APIType::OpenGL, uid.puid.GetUidData());
+    ShaderCode gcode;
+    if (g_ActiveConfig.backend_info.bSupportsGeometryShaders &&
+        !uid.guid.GetUidData()->IsPassthrough())
+      gcode = GenerateGeometryShaderCode(APIType::OpenGL, uid.guid.GetUidData());
+
+    if (!CompileShader(shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
+    {
+      GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+      return nullptr;
+    }
+    iter = s_uber_shaders.find(uid);
+  }
+
+  GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+  iter->second.Bind();
+  return &iter->second;
+}
+
+void ProgramShaderCache::QueueCompile(const SHADERUID& uid, const std::string& vcode,
+                                      const std::string& pcode, const std::string& gcode)
+{
+  s_compile_pool->Push([uid, vcode, pcode, gcode] {
+    CompiledProgram program;
+    program.uid = uid;
+    program.success = LinkProgram(program.shader, vcode, pcode, gcode);
+
+    // The video thread may only use the program once it has been fully built.
+    glFinish();
+
+    std::lock_guard<std::mutex> lock(s_compiled_programs_lock);
+    s_compiled_programs.push_back(std::move(program));
+  });
+}
+
+void ProgramShaderCache::RetrieveAsyncShaders()
+{
+  std::vector<CompiledProgram> programs;
+  {
+    std::lock_guard<std::mutex> lock(s_compiled_programs_lock);
+    if (s_compiled_programs.empty())
+      return;
+    programs.swap(s_compiled_programs);
+  }
+
+  for (CompiledProgram& program : programs)
+  {
+    PCacheEntry& entry = pshaders[program.uid];
+    entry.pending = false;
+    if (!program.success)
+      continue;
+
+    entry.shader = program.shader;
+    // Needs the video thread's context, as it may bind the program.
+    entry.shader.SetProgramVariables();
+    INCSTAT(stats.numPixelShadersCreated);
+  }
+  SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+}
+
 bool ProgramShaderCache::CompileShader(SHADER& shader, const std::string& vcode,
                                        const std::string& pcode, const std::string& gcode)
+{
+  if (!LinkProgram(shader, vcode, pcode, gcode))
+    return false;
+
+  shader.SetProgramVariables();
+
+  return true;
+}
+
+bool ProgramShaderCache::LinkProgram(SHADER& shader, const std::string& vcode,
+                                     const std::string& pcode, const std::string& gcode)
 {
   GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
   GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -335,8 +459,6 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const std::string& vcode,
     return false;
   }
 
-  shader.SetProgramVariables();
-
   return true;
 }
 
@@ -502,6 +624,8 @@ void ProgramShaderCache::Init()
   // Then once more to get bytes
   s_buffer = StreamBuffer::Create(GL_UNIFORM_BUFFER, UBO_LENGTH);
 
+  CreateHeader();
+
   // Read our shader cache, only if supported and enabled
   if (g_ogl_config.bSupportsGLSLCache && g_ActiveConfig.bShaderCache)
   {
@@ -524,18 +648,55 @@ void ProgramShaderCache::Init()
 
       ProgramShaderCacheInserter inserter;
       g_program_disk_cache.OpenAndRead(cache_filename, inserter);
+
+      // Rebuild the programs now rather than when the game first draws with them, and start a
+      // new cache file, as the old binaries will never load again with this driver.
+      if (!inserter.stale_uids.empty())
+      {
+        PrecompileShaders(inserter.stale_uids);
+
+        g_program_disk_cache.Close();
+        File::Delete(cache_filename);
+        g_program_disk_cache.OpenAndRead(cache_filename, inserter);
+        for (auto& entry : pshaders)
+          entry.second.in_cache = 0;
+      }
     }
     SETSTAT(stats.numPixelShadersAlive, pshaders.size());
   }
 
-  CreateHeader();
-
   CurrentProgram = 0;
   last_entry = nullptr;
+
+  if (g_ActiveConfig.UseBackgroundShaderCompiling())
+  {
+    s_shared_context = GLInterface->CreateSharedContext();
+    if (s_shared_context)
+    {
+      s_compile_pool = std::make_unique<Common::WorkerPool>("Shader compiler", 1);
+      s_compile_pool->Push([] { s_shared_context->MakeCurrent(); });
+    }
+    else
+    {
+      WARN_LOG(VIDEO, "Failed to create a shared context, compiling shaders on the video thread.");
+      g_Config.backend_info.bSupportsBackgroundShaderCompiling = false;
+      g_ActiveConfig.backend_info.bSupportsBackgroundShaderCompiling = false;
+    }
+  }
 }
 
 void ProgramShaderCache::Shutdown()
 {
+  if (s_compile_pool)
+  {
+    s_compile_pool->WaitForIdle();
+    s_compile_pool->Push([] { s_shared_context->ClearCurrent(); });
+    s_compile_pool->WaitForIdle();
+    s_compile_pool.reset();
+    s_shared_context.reset();
+    RetrieveAsyncShaders();
+  }
+
   // store all shaders in cache on disk
   if (g_ogl_config.bSupportsGLSLCache)
   {
@@ -583,6 +744,10 @@ void ProgramShaderCache::Shutdown()
   }
   pshaders.clear();
 
+  for (auto& entry : s_uber_shaders)
+    entry.second.Destroy();
+  s_uber_shaders.clear();
+
   s_buffer.reset();
 }
 
@@ -757,7 +922,105 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
   else
   {
     glDeleteProgram(entry.shader.glprogid);
+    stale_uids.push_back(key);
+  }
+}
+
+void ProgramShaderCache::PrecompileShaders(const std::vector<SHADERUID>& uids)
+{
+  // The same uid may be in the file more than once, and a later copy may have loaded fine.
+  std::vector<SHADERUID> to_compile;
+  for (const SHADERUID& uid : uids)
+  {
+    if (!pshaders.count(uid))
+      to_compile.push_back(uid);
   }
+  std::sort(to_compile.begin(), to_compile.end());
+  to_compile.erase(std::unique(to_compile.begin(), to_compile.end()), to_compile.end());
+  if (to_compile.empty())
+    return;
+
+  const size_t count = to_compile.size();
+  INFO_LOG(VIDEO, "Recompiling %zu programs from the shader cache", count);
+
+  // Generating the sources only reads the config, so it is spread across all cores.
+  struct ProgramSources
+  {
+    std::string vcode, pcode, gcode;
+  };
+  std::vector<ProgramSources> sources(count);
+  {
+    Common::WorkerPool pool("Shader generator");
+    pool.ParallelFor(count, [&](size_t i) {
+      const SHADERUID& uid = to_compile[i];
+      sources[i].vcode =
+          GenerateVertexShaderCode(APIType::OpenGL, uid.vuid.GetUidData()).GetBuffer();
+      sources[i].pcode =
+          GeneratePixelShaderCode(APIType::OpenGL, uid.puid.GetUidData()).GetBuffer();
+      if (g_ActiveConfig.backend_info.bSupportsGeometryShaders &&
+          !uid.guid.GetUidData()->IsPassthrough())
+      {
+        sources[i].gcode =
+            GenerateGeometryShaderCode(APIType::OpenGL, uid.guid.GetUidData()).GetBuffer();
+      }
+    });
+  }
+
+  // Linking needs a context per thread. The video thread links as well and reports progress,
+  // and is the only one linking if no shared contexts can be created.
+  std::vector<SHADER> programs(count);
+  std::vector<u8> linked(count, 0);
+  std::atomic<size_t> next_index{0};
+  std::atomic<size_t> num_linked{0};
+  auto link_programs = [&](bool report_progress) {
+    for (size_t i = next_index++; i < count; i = next_index++)
+    {
+      linked[i] = LinkProgram(programs[i], sources[i].vcode, sources[i].pcode, sources[i].gcode);
+      size_t done = ++num_linked;
+      if (report_progress)
+        Host_UpdateTitle(StringFromFormat("Compiling shaders... %zu/%zu", done, count));
+    }
+  };
+
+  const size_t max_threads = std::min<size_t>(std::thread::hardware_concurrency(), count);
+  std::vector<std::unique_ptr<cInterfaceBase>> contexts;
+  while (contexts.size() + 1 < max_threads)
+  {
+    std::unique_ptr<cInterfaceBase> context = GLInterface->CreateSharedContext();
+    if (!context)
+      break;
+    contexts.push_back(std::move(context));
+  }
+
+  std::vector<std::thread> threads;
+  for (auto& context : contexts)
+  {
+    threads.emplace_back([&link_programs, context = context.get()] {
+      Common::SetCurrentThreadName("Shader compiler");
+      context->MakeCurrent();
+      link_programs(false);
+      // The video thread may only use the programs once they have been fully built.
+      glFinish();
+      context->ClearCurrent();
+    });
+  }
+  link_programs(true);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!linked[i])
+      continue;
+
+    PCacheEntry& entry = pshaders[to_compile[i]];
+    entry.shader = programs[i];
+    entry.shader.SetProgramVariables();
+    INCSTAT(stats.numPixelShadersCreated);
+  }
+
+  OSD::AddMessage(StringFromFormat("Recompiled %zu shaders after a driver change", count),
+                  OSD::Duration::NORMAL);
 }
 
 }  // namespace OGL
@@ -4,13 +4,17 @@
 
 #pragma once
 
+#include <map>
 #include <tuple>
+#include <vector>
 
 #include "Common/GL/GLUtil.h"
 #include "Common/LinearDiskCache.h"
 
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/UberShaderVertex.h"
 #include "VideoCommon/VertexShaderGen.h"
 
 namespace OGL
@@ -33,6 +37,19 @@ public:
   }
 };
 
+class UBERSHADERUID
+{
+public:
+  UberVertexShaderUid vuid;
+  UberPixelShaderUid puid;
+  GeometryShaderUid guid;
+
+  bool operator<(const UBERSHADERUID& r) const
+  {
+    return std::tie(puid, vuid, guid) < std::tie(r.puid, r.vuid, r.guid);
+  }
+};
+
 struct SHADER
 {
   SHADER() : glprogid(0) {}
@@ -57,6 +74,8 @@ public:
   {
     SHADER shader;
     bool in_cache;
+    // Still being compiled in the background, the ubershaders are used in the meantime.
+    bool pending = false;
 
     void Destroy() { shader.Destroy(); }
   };
@@ -80,10 +99,23 @@ private:
   {
   public:
     void Read(const SHADERUID& key, const u8* value, u32 value_size) override;
+
+    // Programs whose binary was rejected by the driver, e.g. after a driver update.
+    std::vector<SHADERUID> stale_uids;
   };
 
+  static void PrecompileShaders(const std::vector<SHADERUID>& uids);
+
+  static bool LinkProgram(SHADER& shader, const std::string& vcode, const std::string& pcode,
+                          const std::string& gcode);
+  static void QueueCompile(const SHADERUID& uid, const std::string& vcode,
+                           const std::string& pcode, const std::string& gcode);
+  static void RetrieveAsyncShaders();
+  static SHADER* SetUberShader(u32 primitive_type);
+
   typedef std::map<SHADERUID, PCacheEntry> PCache;
   static PCache pshaders;
+  static std::map<UBERSHADERUID, SHADER> s_uber_shaders;
   static PCacheEntry* last_entry;
   static SHADERUID last_uid;
 
@@ -96,6 +96,8 @@ void VideoBackend::InitBackendInfo()
   // will show the option when it is not supported. The only way around this would be
   // creating a context when calling this function to determine what is available.
   g_Config.backend_info.bSupportsGPUTextureDecoding = true;
+  // Cleared by ProgramShaderCache::Init when no shared context can be created.
+  g_Config.backend_info.bSupportsBackgroundShaderCompiling = true;
 
   // Overwritten in Render.cpp later
   g_Config.backend_info.bSupportsDualSourceBlend = true;
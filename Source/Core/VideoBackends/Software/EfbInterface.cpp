@@ -9,6 +9,7 @@
 #include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/Swap.h"
 
@@ -32,6 +33,20 @@ static inline u32 GetDepthOffset(u16 x, u16 y)
   return (x + y * EFB_WIDTH) * 3 + DEPTH_BUFFER_START;
 }
 
+// Pixels are 3 bytes, so these must not access a whole u32: the fourth byte belongs to the next
+// pixel, which may be in another tile that a different thread is rasterizing.
+static inline u32 LoadPixel(u32 offset)
+{
+  return efb[offset] | (efb[offset + 1] << 8) | (efb[offset + 2] << 16);
+}
+
+static inline void StorePixel(u32 offset, u32 value)
+{
+  efb[offset] = static_cast<u8>(value);
+  efb[offset + 1] = static_cast<u8>(value >> 8);
+  efb[offset + 2] = static_cast<u8>(value >> 16);
+}
+
 static void SetPixelAlphaOnly(u32 offset, u8 a)
 {
   switch (bpmem.zcontrol.pixel_format)
@@ -44,10 +59,9 @@ static void SetPixelAlphaOnly(u32 offset, u8 a)
   case PEControl::RGBA6_Z24:
   {
     u32 a32 = a;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xffffffc0;
+    u32 val = LoadPixel(offset) & 0x00ffffc0;
     val |= (a32 >> 2) & 0x0000003f;
-    *dst = val;
+    StorePixel(offset, val);
   }
   break;
   default:
@@ -63,31 +77,24 @@ static void SetPixelColorOnly(u32 offset, u8* rgb)
   case PEControl::Z24:
   {
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   case PEControl::RGBA6_Z24:
   {
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff00003f;
+    u32 val = LoadPixel(offset) & 0x0000003f;
     val |= (src >> 4) & 0x00000fc0;  // blue
     val |= (src >> 6) & 0x0003f000;  // green
     val |= (src >> 8) & 0x00fc0000;  // red
-    *dst = val;
+    StorePixel(offset, val);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     WARN_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   default:
@@ -103,32 +110,24 @@ static void SetPixelAlphaColor(u32 offset, u8* color)
   case PEControl::Z24:
   {
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   case PEControl::RGBA6_Z24:
   {
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= (src >> 2) & 0x0000003f;  // alpha
+    u32 val = (src >> 2) & 0x0000003f;  // alpha
     val |= (src >> 4) & 0x00000fc0;  // blue
     val |= (src >> 6) & 0x0003f000;  // green
     val |= (src >> 8) & 0x00fc0000;  // red
-    *dst = val;
+    StorePixel(offset, val);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     WARN_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   default:
@@ -138,8 +137,7 @@ static void SetPixelAlphaColor(u32 offset, u8* color)
 
 static u32 GetPixelColor(u32 offset)
 {
-  u32 src;
-  std::memcpy(&src, &efb[offset], sizeof(u32));
+  const u32 src = LoadPixel(offset);
 
   switch (bpmem.zcontrol.pixel_format)
   {
@@ -171,19 +169,13 @@ static void SetPixelDepth(u32 offset, u32 depth)
   case PEControl::RGBA6_Z24:
   case PEControl::Z24:
   {
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= depth & 0x00ffffff;
-    *dst = val;
+    StorePixel(offset, depth);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     WARN_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= depth & 0x00ffffff;
-    *dst = val;
+    StorePixel(offset, depth);
   }
   break;
   default:
@@ -201,13 +193,13 @@ static u32 GetPixelDepth(u32 offset)
   case PEControl::RGBA6_Z24:
   case PEControl::Z24:
   {
-    depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+    depth = LoadPixel(offset);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     WARN_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-    depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+    depth = LoadPixel(offset);
   }
   break;
   default:
@@ -304,6 +296,24 @@ static void BlendColor(u8* srcClr, u8* dstClr)
   u32 srcFactor = GetSourceFactor(srcClr, dstClr, bpmem.blendmode.srcfactor);
   u32 dstFactor = GetDestinationFactor(srcClr, dstClr, bpmem.blendmode.dstfactor);
 
+#ifdef _M_X86
+  // One 16-bit lane per component, with the source and destination terms interleaved so pmaddwd
+  // sums them; packus then clamps to 255.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i src = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(u32*)srcClr), zero);
+  const __m128i dst = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(u32*)dstClr), zero);
+  __m128i sf = _mm_unpacklo_epi8(_mm_cvtsi32_si128(srcFactor), zero);
+  __m128i df = _mm_unpacklo_epi8(_mm_cvtsi32_si128(dstFactor), zero);
+
+  // add MSB of factors to make their range 0 -> 256
+  sf = _mm_add_epi16(sf, _mm_srli_epi16(sf, 7));
+  df = _mm_add_epi16(df, _mm_srli_epi16(df, 7));
+
+  __m128i color = _mm_madd_epi16(_mm_unpacklo_epi16(src, dst), _mm_unpacklo_epi16(sf, df));
+  color = _mm_srli_epi32(color, 8);
+  color = _mm_packs_epi32(color, color);
+  *(u32*)dstClr = _mm_cvtsi128_si32(_mm_packus_epi16(color, color));
+#else
   for (int i = 0; i < 4; i++)
   {
     // add MSB of factors to make their range 0 -> 256
@@ -319,6 +329,7 @@ static void BlendColor(u8* srcClr, u8* dstClr)
     dstFactor >>= 8;
     srcFactor >>= 8;
   }
+#endif
 }
 
 static void LogicBlend(u32 srcClr, u32* dstClr, BlendMode::LogicOp op)
@@ -378,11 +389,16 @@ static void LogicBlend(u32 srcClr, u32* dstClr, BlendMode::LogicOp op)
 
 static void SubtractBlend(u8* srcClr, u8* dstClr)
 {
+#ifdef _M_X86
+  *(u32*)dstClr = _mm_cvtsi128_si32(
+      _mm_subs_epu8(_mm_cvtsi32_si128(*(u32*)dstClr), _mm_cvtsi32_si128(*(u32*)srcClr)));
+#else
   for (int i = 0; i < 4; i++)
   {
     int c = (int)dstClr[i] - (int)srcClr[i];
     dstClr[i] = (c < 0) ? 0 : c;
   }
+#endif
 }
 
 static void Dither(u16 x, u16 y, u8* color)
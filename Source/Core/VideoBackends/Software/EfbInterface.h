@@ -62,16 +62,15 @@ void CopyToXFB(yuv422_packed* xfb_in_ram, u32 fbWidth, u32 fbHeight, const EFBRe
 void BypassXFB(u8* texture, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma);
 
 extern u32 perf_values[PQ_NUM_MEMBERS];
-inline void IncPerfCounterQuadCount(PerfQueryType type)
+inline void IncPerfCounterQuadCount(PerfQueryType type, u32 num_pixels = 1)
 {
   // NOTE: hardware doesn't process individual pixels but quads instead.
   // Current software renderer architecture works on pixels though, so
   // we have this "quad" hack here to only increment the registers on
   // every fourth rendered pixel
   static u32 quad[PQ_NUM_MEMBERS];
-  if (++quad[type] != 3)
-    return;
-  quad[type] = 0;
-  ++perf_values[type];
+  u32 total = quad[type] + num_pixels;
+  perf_values[type] += total / 3;
+  quad[type] = total % 3;
 }
 }
@@ -10,10 +10,18 @@ struct OutputVertexData;
 
 namespace Rasterizer
 {
+// Rasterizes tiles on one thread per CPU core.
 void Init();
+// num_threads includes the video thread. With only one, triangles are drawn right away instead of
+// being binned into tiles.
+void Init(u32 num_threads);
+void Shutdown();
 
+// Triangles may be queued until Flush(), which must be called before the EFB is accessed and
+// before any of the state used for drawing changes.
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
+void Flush();
 
 void SetTevReg(int reg, int comp, s16 color);
 
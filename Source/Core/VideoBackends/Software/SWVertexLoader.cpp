@@ -122,6 +122,8 @@ void SWVertexLoader::vFlush()
     INCSTAT(stats.thisFrame.numVerticesLoaded)
   }
 
+  Rasterizer::Flush();
+
   DebugUtil::OnObjectEnd();
 }
 
@@ -138,6 +138,7 @@ void VideoSoftware::InitBackendInfo()
   g_Config.backend_info.bSupportsInternalResolutionFrameDumps = false;
   g_Config.backend_info.bSupportsGPUTextureDecoding = false;
   g_Config.backend_info.bSupportsST3CTextures = false;
+  g_Config.backend_info.bSupportsBackgroundShaderCompiling = false;
 
   // aamodes
   g_Config.backend_info.AAModes = {1};
@@ -183,6 +184,7 @@ void VideoSoftware::Video_Cleanup()
 {
   CleanupShared();
 
+  Rasterizer::Shutdown();
   SWRenderer::Shutdown();
   DebugUtil::Shutdown();
   // The following calls are NOT Thread Safe
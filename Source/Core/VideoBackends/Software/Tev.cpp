@@ -2,10 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Tev.h"
@@ -157,6 +159,12 @@ void Tev::Init()
   m_ScaleRShiftLUT[1] = 0;
   m_ScaleRShiftLUT[2] = 0;
   m_ScaleRShiftLUT[3] = 1;
+
+  m_PixelsIn = 0;
+  m_PixelsOut = 0;
+  std::fill(std::begin(m_PerfCounts), std::end(m_PerfCounts), 0);
+  m_BBox[BoundingBox::LEFT] = m_BBox[BoundingBox::TOP] = 0xFFFF;
+  m_BBox[BoundingBox::RIGHT] = m_BBox[BoundingBox::BOTTOM] = 0;
 }
 
 static inline s16 Clamp255(s16 in)
@@ -316,6 +324,109 @@ void Tev::DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
   Reg[ac.dest][ALP_C] = result;
 }
 
+// Both combiners in their regular mode: with SSE2, the color and alpha results are computed
+// together, one 32-bit lane per ABGR component. Lane parameters reproduce the scalar rounding and
+// negation order exactly, including the alpha combiner's rounding only applying for shift 3.
+void Tev::DrawRegular(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac,
+                      const InputRegType inputs[4])
+{
+#ifdef _M_X86
+  alignas(16) s16 factors[8];
+  alignas(16) s16 weights[8];
+  alignas(16) s32 offsets[4];
+  alignas(16) s32 rounding[4];
+  alignas(16) s32 negate_before[4];
+  alignas(16) s32 negate_after[4];
+  alignas(16) s32 rshift[4];
+  alignas(16) s16 clamp_min[8];
+  alignas(16) s16 clamp_max[8];
+
+  for (int i = 0; i < 4; i++)
+  {
+    const InputRegType& InputReg = inputs[i];
+    const bool alpha = i == ALP_C;
+    const u32 shift = alpha ? ac.shift : cc.shift;
+    const u32 op = alpha ? ac.op : cc.op;
+    const u32 bias = alpha ? ac.bias : cc.bias;
+    const bool clamp = alpha ? ac.clamp : cc.clamp;
+    const u8 lshift = m_ScaleLShiftLUT[shift];
+
+    u16 c = InputReg.c + (InputReg.c >> 7);
+
+    // a * (256 - c) + b * c, pre-shifted, as one pmaddwd pair
+    factors[i * 2] = InputReg.a;
+    factors[i * 2 + 1] = InputReg.b;
+    weights[i * 2] = (256 - c) << lshift;
+    weights[i * 2 + 1] = c << lshift;
+
+    offsets[i] = (InputReg.d + m_BiasLUT[bias]) << lshift;
+    rounding[i] = ((shift == 3) != alpha) ? 0 : (op == 1) ? 127 : 128;
+    negate_before[i] = (alpha && op) ? -1 : 0;
+    negate_after[i] = (!alpha && op) ? -1 : 0;
+    rshift[i] = m_ScaleRShiftLUT[shift] ? -1 : 0;
+    clamp_min[i] = clamp_min[i + 4] = clamp ? 0 : -1024;
+    clamp_max[i] = clamp_max[i + 4] = clamp ? 255 : 1023;
+  }
+
+  __m128i temp = _mm_madd_epi16(_mm_load_si128((const __m128i*)factors),
+                                _mm_load_si128((const __m128i*)weights));
+  temp = _mm_add_epi32(temp, _mm_load_si128((const __m128i*)rounding));
+
+  const __m128i before = _mm_load_si128((const __m128i*)negate_before);
+  temp = _mm_sub_epi32(_mm_xor_si128(temp, before), before);
+  temp = _mm_srai_epi32(temp, 8);
+  const __m128i after = _mm_load_si128((const __m128i*)negate_after);
+  temp = _mm_sub_epi32(_mm_xor_si128(temp, after), after);
+
+  __m128i result = _mm_add_epi32(_mm_load_si128((const __m128i*)offsets), temp);
+  const __m128i rshift_mask = _mm_load_si128((const __m128i*)rshift);
+  result = _mm_or_si128(_mm_and_si128(rshift_mask, _mm_srai_epi32(result, 1)),
+                        _mm_andnot_si128(rshift_mask, result));
+
+  // The results always fit in 16 bits, so saturating matches the scalar truncation
+  result = _mm_packs_epi32(result, result);
+  result = _mm_max_epi16(result, _mm_load_si128((const __m128i*)clamp_min));
+  result = _mm_min_epi16(result, _mm_load_si128((const __m128i*)clamp_max));
+
+  alignas(16) s16 output[8];
+  _mm_store_si128((__m128i*)output, result);
+
+  Reg[cc.dest][BLU_C] = output[BLU_C];
+  Reg[cc.dest][GRN_C] = output[GRN_C];
+  Reg[cc.dest][RED_C] = output[RED_C];
+  Reg[ac.dest][ALP_C] = output[ALP_C];
+#else
+  DrawColorRegular(cc, inputs);
+  ClampColor(cc);
+  DrawAlphaRegular(ac, inputs);
+  ClampAlpha(ac);
+#endif
+}
+
+void Tev::ClampColor(const TevStageCombiner::ColorCombiner& cc)
+{
+  if (cc.clamp)
+  {
+    Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+    Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+    Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+  }
+  else
+  {
+    Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+    Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+    Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+  }
+}
+
+void Tev::ClampAlpha(const TevStageCombiner::AlphaCombiner& ac)
+{
+  if (ac.clamp)
+    Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+  else
+    Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+}
+
 void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
 {
   switch ((ac.shift << 1) | ac.op | 8)  // encoded compare mode
@@ -567,7 +678,7 @@ void Tev::Draw()
   _assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
   _assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-  INCSTAT(stats.thisFrame.tevPixelsIn);
+  ++m_PixelsIn;
 
   // initial color values
   for (int i = 0; i < 4; i++)
@@ -669,34 +780,25 @@ void Tev::Draw()
     inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
     inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
 
-    if (cc.bias != 3)
-      DrawColorRegular(cc, inputs);
-    else
-      DrawColorCompare(cc, inputs);
-
-    if (cc.clamp)
+    if (cc.bias != 3 && ac.bias != 3)
     {
-      Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+      DrawRegular(cc, ac, inputs);
     }
     else
     {
-      Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+      if (cc.bias != 3)
+        DrawColorRegular(cc, inputs);
+      else
+        DrawColorCompare(cc, inputs);
+      ClampColor(cc);
+
+      if (ac.bias != 3)
+        DrawAlphaRegular(ac, inputs);
+      else
+        DrawAlphaCompare(ac, inputs);
+      ClampAlpha(ac);
     }
 
-    if (ac.bias != 3)
-      DrawAlphaRegular(ac, inputs);
-    else
-      DrawAlphaCompare(ac, inputs);
-
-    if (ac.clamp)
-      Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-    else
-      Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
-
 #if ALLOW_TEV_DUMPS
     if (g_ActiveConfig.bDumpTevStages)
     {
@@ -831,23 +933,19 @@ void Tev::Draw()
   if (late_ztest && bpmem.zmode.testenable)
   {
     // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    IncPerfCounter(PQ_ZCOMP_INPUT);
 
     if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
       return;
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+    IncPerfCounter(PQ_ZCOMP_OUTPUT);
   }
 
   // branchless bounding box update
-  BoundingBox::coords[BoundingBox::LEFT] =
-      std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-  BoundingBox::coords[BoundingBox::RIGHT] =
-      std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-  BoundingBox::coords[BoundingBox::TOP] =
-      std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-  BoundingBox::coords[BoundingBox::BOTTOM] =
-      std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+  m_BBox[BoundingBox::LEFT] = std::min((u16)Position[0], m_BBox[BoundingBox::LEFT]);
+  m_BBox[BoundingBox::RIGHT] = std::max((u16)Position[0], m_BBox[BoundingBox::RIGHT]);
+  m_BBox[BoundingBox::TOP] = std::min((u16)Position[1], m_BBox[BoundingBox::TOP]);
+  m_BBox[BoundingBox::BOTTOM] = std::max((u16)Position[1], m_BBox[BoundingBox::BOTTOM]);
 
 #if ALLOW_TEV_DUMPS
   if (g_ActiveConfig.bDumpTevStages)
@@ -869,12 +967,38 @@ void Tev::Draw()
   }
 #endif
 
-  INCSTAT(stats.thisFrame.tevPixelsOut);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+  ++m_PixelsOut;
+  IncPerfCounter(PQ_BLEND_INPUT);
 
   EfbInterface::BlendTev(Position[0], Position[1], output);
 }
 
+void Tev::FlushCounters()
+{
+  ADDSTAT(stats.thisFrame.tevPixelsIn, m_PixelsIn);
+  ADDSTAT(stats.thisFrame.tevPixelsOut, m_PixelsOut);
+  m_PixelsIn = 0;
+  m_PixelsOut = 0;
+
+  for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+  {
+    if (m_PerfCounts[i])
+      EfbInterface::IncPerfCounterQuadCount(static_cast<PerfQueryType>(i), m_PerfCounts[i]);
+    m_PerfCounts[i] = 0;
+  }
+
+  BoundingBox::coords[BoundingBox::LEFT] =
+      std::min(m_BBox[BoundingBox::LEFT], BoundingBox::coords[BoundingBox::LEFT]);
+  BoundingBox::coords[BoundingBox::RIGHT] =
+      std::max(m_BBox[BoundingBox::RIGHT], BoundingBox::coords[BoundingBox::RIGHT]);
+  BoundingBox::coords[BoundingBox::TOP] =
+      std::min(m_BBox[BoundingBox::TOP], BoundingBox::coords[BoundingBox::TOP]);
+  BoundingBox::coords[BoundingBox::BOTTOM] =
+      std::max(m_BBox[BoundingBox::BOTTOM], BoundingBox::coords[BoundingBox::BOTTOM]);
+  m_BBox[BoundingBox::LEFT] = m_BBox[BoundingBox::TOP] = 0xFFFF;
+  m_BBox[BoundingBox::RIGHT] = m_BBox[BoundingBox::BOTTOM] = 0;
+}
+
 void Tev::SetRegColor(int reg, int comp, s16 color)
 {
   KonstantColors[reg][comp] = color;
@@ -5,9 +5,13 @@
 #pragma once
 
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class Tev
 {
+  // Compares the SIMD combiner against the scalar one.
+  friend class TevTest;
+
   struct InputRegType
   {
     unsigned a : 8;
@@ -63,9 +67,20 @@ class Tev
   void DrawColorCompare(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
   void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
   void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+  void DrawRegular(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac,
+                   const InputRegType inputs[4]);
+
+  void ClampColor(const TevStageCombiner::ColorCombiner& cc);
+  void ClampAlpha(const TevStageCombiner::AlphaCombiner& ac);
 
   void Indirect(unsigned int stageNum, s32 s, s32 t);
 
+  // Counters are kept per instance, as the rasterizer draws with one Tev per thread.
+  u32 m_PixelsIn;
+  u32 m_PixelsOut;
+  u32 m_PerfCounts[PQ_NUM_MEMBERS];
+  u16 m_BBox[4];
+
 public:
   s32 Position[3];
   u8 Color[2][4];  // must be RGBA for correct swap table ordering
@@ -87,5 +102,9 @@ public:
 
   void Draw();
 
+  void IncPerfCounter(PerfQueryType type) { ++m_PerfCounts[type]; }
+  // Adds the counters and bounding box to the global ones, and resets them.
+  void FlushCounters();
+
   void SetRegColor(int reg, int comp, s16 color);
 };
@@ -5,16 +5,22 @@
 #include "VideoBackends/Vulkan/ObjectCache.h"
 
 #include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
 #include <xxhash.h>
 
 #include "Common/Assert.h"
 #include "Common/CommonFuncs.h"
 #include "Common/LinearDiskCache.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
 
 #include "Core/ConfigManager.h"
+#include "Core/Host.h"
 
 #include "VideoBackends/Vulkan/ShaderCompiler.h"
 #include "VideoBackends/Vulkan/StreamBuffer.h"
@@ -33,6 +39,8 @@ ObjectCache::ObjectCache()
 
 ObjectCache::~ObjectCache()
 {
+  WaitForBackgroundCompiles();
+  m_compile_pool.reset();
   DestroyPipelineCache();
   DestroyShaderCaches();
   DestroySharedShaders();
@@ -69,6 +77,10 @@ bool ObjectCache::Initialize()
   if (!m_utility_shader_vertex_buffer || !m_utility_shader_uniform_buffer)
     return false;
 
+  // glslang and vkCreate* are thread-safe, so the compiles can happen on several threads.
+  if (g_ActiveConfig.UseBackgroundShaderCompiling())
+    m_compile_pool = std::make_unique<Common::WorkerPool>("Shader compiler", 2);
+
   return true;
 }
 
@@ -386,6 +398,27 @@ std::pair<VkPipeline, bool> ObjectCache::GetPipelineWithCacheResult(const Pipeli
   return {pipeline, false};
 }
 
+std::pair<VkPipeline, bool> ObjectCache::GetPipelineWithCacheResultAsync(const PipelineInfo& info)
+{
+  auto iter = m_pipeline_objects.find(info);
+  if (iter != m_pipeline_objects.end())
+    return {iter->second, true};
+
+  // Already queued?
+  if (!m_pending_pipelines.insert(info).second)
+    return {VK_NULL_HANDLE, true};
+
+  m_compile_pool->Push([this, info] {
+    VkPipeline pipeline = CreatePipeline(info);
+    QueueCompileResult([this, info, pipeline] {
+      m_pending_pipelines.erase(info);
+      m_pipeline_objects.emplace(info, pipeline);
+    });
+  });
+
+  return {VK_NULL_HANDLE, false};
+}
+
 VkPipeline ObjectCache::CreateComputePipeline(const ComputePipelineInfo& info)
 {
   VkComputePipelineCreateInfo pipeline_info = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
@@ -423,6 +456,9 @@ VkPipeline ObjectCache::GetComputePipeline(const ComputePipelineInfo& info)
 
 void ObjectCache::ClearPipelineCache()
 {
+  // Queued pipelines may reference the objects which are about to be destroyed.
+  WaitForBackgroundCompiles();
+
   for (const auto& it : m_pipeline_objects)
   {
     if (it.second != VK_NULL_HANDLE)
@@ -591,6 +627,8 @@ void ObjectCache::DestroyPipelineCache()
 
 void ObjectCache::SavePipelineCache()
 {
+  WaitForBackgroundCompiles();
+
   size_t data_size;
   VkResult res =
       vkGetPipelineCacheData(g_vulkan_context->GetDevice(), m_pipeline_cache, &data_size, nullptr);
@@ -684,6 +722,52 @@ void ObjectCache::DestroyShaderCaches()
 
   if (g_vulkan_context->SupportsGeometryShaders())
     DestroyShaderCache(m_gs_cache);
+
+  for (const auto& it : m_uber_vs_cache)
+  {
+    if (it.second != VK_NULL_HANDLE)
+      vkDestroyShaderModule(g_vulkan_context->GetDevice(), it.second, nullptr);
+  }
+  m_uber_vs_cache.clear();
+
+  for (const auto& it : m_uber_ps_cache)
+  {
+    if (it.second != VK_NULL_HANDLE)
+      vkDestroyShaderModule(g_vulkan_context->GetDevice(), it.second, nullptr);
+  }
+  m_uber_ps_cache.clear();
+}
+
+void ObjectCache::WaitForBackgroundCompiles()
+{
+  if (!m_compile_pool)
+    return;
+
+  m_compile_pool->WaitForIdle();
+  RetrieveAsyncResults();
+}
+
+void ObjectCache::QueueCompileResult(std::function<void()> result)
+{
+  std::lock_guard<std::mutex> guard(m_compile_results_lock);
+  m_compile_results.push_back(std::move(result));
+}
+
+bool ObjectCache::RetrieveAsyncResults()
+{
+  std::vector<std::function<void()>> results;
+  {
+    std::lock_guard<std::mutex> guard(m_compile_results_lock);
+    if (m_compile_results.empty())
+      return false;
+
+    results.swap(m_compile_results);
+  }
+
+  for (const auto& result : results)
+    result();
+
+  return true;
 }
 
 VkShaderModule ObjectCache::GetVertexShaderForUid(const VertexShaderUid& uid)
@@ -770,6 +854,212 @@ VkShaderModule ObjectCache::GetPixelShaderForUid(const PixelShaderUid& uid)
   return module;
 }
 
+VkShaderModule ObjectCache::GetVertexShaderForUidAsync(const VertexShaderUid& uid)
+{
+  auto it = m_vs_cache.shader_map.find(uid);
+  if (it != m_vs_cache.shader_map.end())
+    return it->second;
+
+  if (!m_vs_cache.pending.insert(uid).second)
+    return VK_NULL_HANDLE;
+
+  // The source is generated here, as the generator reads the active config.
+  ShaderCode source_code = GenerateVertexShaderCode(APIType::Vulkan, uid.GetUidData());
+  m_compile_pool->Push([this, uid, source = source_code.GetBuffer()] {
+    ShaderCompiler::SPIRVCodeVector spv;
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (ShaderCompiler::CompileVertexShader(&spv, source.c_str(), source.length()))
+      module = Util::CreateShaderModule(spv.data(), spv.size());
+
+    QueueCompileResult([this, uid, module, spv] {
+      if (module != VK_NULL_HANDLE)
+      {
+        m_vs_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
+        INCSTAT(stats.numVertexShadersCreated);
+        INCSTAT(stats.numVertexShadersAlive);
+      }
+
+      m_vs_cache.pending.erase(uid);
+      m_vs_cache.shader_map.emplace(uid, module);
+    });
+  });
+
+  return VK_NULL_HANDLE;
+}
+
+VkShaderModule ObjectCache::GetPixelShaderForUidAsync(const PixelShaderUid& uid)
+{
+  auto it = m_ps_cache.shader_map.find(uid);
+  if (it != m_ps_cache.shader_map.end())
+    return it->second;
+
+  if (!m_ps_cache.pending.insert(uid).second)
+    return VK_NULL_HANDLE;
+
+  ShaderCode source_code = GeneratePixelShaderCode(APIType::Vulkan, uid.GetUidData());
+  m_compile_pool->Push([this, uid, source = source_code.GetBuffer()] {
+    ShaderCompiler::SPIRVCodeVector spv;
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (ShaderCompiler::CompileFragmentShader(&spv, source.c_str(), source.length()))
+      module = Util::CreateShaderModule(spv.data(), spv.size());
+
+    QueueCompileResult([this, uid, module, spv] {
+      if (module != VK_NULL_HANDLE)
+      {
+        m_ps_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
+        INCSTAT(stats.numPixelShadersCreated);
+        INCSTAT(stats.numPixelShadersAlive);
+      }
+
+      m_ps_cache.pending.erase(uid);
+      m_ps_cache.shader_map.emplace(uid, module);
+    });
+  });
+
+  return VK_NULL_HANDLE;
+}
+
+// Runs func for every index on all cores. Progress is shown in the title bar, as this happens
+// before the first frame is drawn.
+static void PrecompileParallel(const char* what, size_t count,
+                               const std::function<void(size_t)>& func)
+{
+  if (count == 0)
+    return;
+
+  INFO_LOG(VIDEO, "Compiling %zu %s from the UID cache", count, what);
+
+  Common::WorkerPool pool("Shader compiler");
+  std::atomic<size_t> num_done{0};
+  const std::thread::id caller_id = std::this_thread::get_id();
+  pool.ParallelFor(count, [&](size_t i) {
+    func(i);
+    size_t done = ++num_done;
+    if (std::this_thread::get_id() == caller_id)
+      Host_UpdateTitle(StringFromFormat("Compiling %s... %zu/%zu", what, done, count));
+  });
+}
+
+void ObjectCache::PrecompileShaders(const std::vector<VertexShaderUid>& vs_uids,
+                                    const std::vector<GeometryShaderUid>& gs_uids,
+                                    const std::vector<PixelShaderUid>& ps_uids)
+{
+  auto precompile = [](auto& cache, const auto& uids, const char* what, auto generate,
+                       auto compile) {
+    using Uid = typename std::decay_t<decltype(uids)>::value_type;
+    std::vector<Uid> to_compile;
+    for (const Uid& uid : uids)
+    {
+      if (!cache.shader_map.count(uid))
+        to_compile.push_back(uid);
+    }
+    std::sort(to_compile.begin(), to_compile.end());
+    to_compile.erase(std::unique(to_compile.begin(), to_compile.end()), to_compile.end());
+
+    std::vector<ShaderCompiler::SPIRVCodeVector> spv(to_compile.size());
+    std::vector<VkShaderModule> modules(to_compile.size(), VK_NULL_HANDLE);
+    PrecompileParallel(what, to_compile.size(), [&](size_t i) {
+      ShaderCode source_code = generate(to_compile[i].GetUidData());
+      if (compile(&spv[i], source_code.GetBuffer()))
+        modules[i] = Util::CreateShaderModule(spv[i].data(), spv[i].size());
+    });
+
+    for (size_t i = 0; i < to_compile.size(); i++)
+    {
+      if (modules[i] != VK_NULL_HANDLE)
+        cache.disk_cache.Append(to_compile[i], spv[i].data(), static_cast<u32>(spv[i].size()));
+      cache.shader_map.emplace(to_compile[i], modules[i]);
+    }
+  };
+
+  precompile(m_vs_cache, vs_uids, "vertex shaders",
+             [](const vertex_shader_uid_data* uid) {
+               return GenerateVertexShaderCode(APIType::Vulkan, uid);
+             },
+             [](ShaderCompiler::SPIRVCodeVector* spv, const std::string& code) {
+               return ShaderCompiler::CompileVertexShader(spv, code.c_str(), code.length());
+             });
+  if (g_vulkan_context->SupportsGeometryShaders())
+  {
+    precompile(m_gs_cache, gs_uids, "geometry shaders",
+               [](const geometry_shader_uid_data* uid) {
+                 return GenerateGeometryShaderCode(APIType::Vulkan, uid);
+               },
+               [](ShaderCompiler::SPIRVCodeVector* spv, const std::string& code) {
+                 return ShaderCompiler::CompileGeometryShader(spv, code.c_str(), code.length());
+               });
+  }
+  precompile(m_ps_cache, ps_uids, "pixel shaders",
+             [](const pixel_shader_uid_data* uid) {
+               return GeneratePixelShaderCode(APIType::Vulkan, uid);
+             },
+             [](ShaderCompiler::SPIRVCodeVector* spv, const std::string& code) {
+               return ShaderCompiler::CompileFragmentShader(spv, code.c_str(), code.length());
+             });
+
+  SETSTAT(stats.numPixelShadersCreated, static_cast<int>(m_ps_cache.shader_map.size()));
+  SETSTAT(stats.numPixelShadersAlive, static_cast<int>(m_ps_cache.shader_map.size()));
+  SETSTAT(stats.numVertexShadersCreated, static_cast<int>(m_vs_cache.shader_map.size()));
+  SETSTAT(stats.numVertexShadersAlive, static_cast<int>(m_vs_cache.shader_map.size()));
+}
+
+void ObjectCache::PrecompilePipelines(const std::vector<PipelineInfo>& infos)
+{
+  std::unordered_set<PipelineInfo, PipelineInfoHash> unique_infos;
+  std::vector<PipelineInfo> to_create;
+  for (const PipelineInfo& info : infos)
+  {
+    if (!m_pipeline_objects.count(info) && unique_infos.insert(info).second)
+      to_create.push_back(info);
+  }
+
+  // vkCreateGraphicsPipelines is free-threaded, including access to the pipeline cache.
+  std::vector<VkPipeline> pipelines(to_create.size(), VK_NULL_HANDLE);
+  PrecompileParallel("pipelines", to_create.size(),
+                     [&](size_t i) { pipelines[i] = CreatePipeline(to_create[i]); });
+
+  for (size_t i = 0; i < to_create.size(); i++)
+    m_pipeline_objects.emplace(to_create[i], pipelines[i]);
+}
+
+VkShaderModule ObjectCache::GetUberVertexShaderForUid(const UberVertexShaderUid& uid)
+{
+  auto it = m_uber_vs_cache.find(uid);
+  if (it != m_uber_vs_cache.end())
+    return it->second;
+
+  ShaderCompiler::SPIRVCodeVector spv;
+  VkShaderModule module = VK_NULL_HANDLE;
+  ShaderCode source_code = GenerateUberVertexShaderCode(APIType::Vulkan, uid.GetUidData());
+  if (ShaderCompiler::CompileVertexShader(&spv, source_code.GetBuffer().c_str(),
+                                          source_code.GetBuffer().length()))
+  {
+    module = Util::CreateShaderModule(spv.data(), spv.size());
+  }
+
+  m_uber_vs_cache.emplace(uid, module);
+  return module;
+}
+
+VkShaderModule ObjectCache::GetUberPixelShaderForUid(const UberPixelShaderUid& uid)
+{
+  auto it = m_uber_ps_cache.find(uid);
+  if (it != m_uber_ps_cache.end())
+    return it->second;
+
+  ShaderCompiler::SPIRVCodeVector spv;
+  VkShaderModule module = VK_NULL_HANDLE;
+  ShaderCode source_code = GenerateUberPixelShaderCode(APIType::Vulkan, uid.GetUidData());
+  if (ShaderCompiler::CompileFragmentShader(&spv, source_code.GetBuffer().c_str(),
+                                            source_code.GetBuffer().length()))
+  {
+    module = Util::CreateShaderModule(spv.data(), spv.size());
+  }
+
+  m_uber_ps_cache.emplace(uid, module);
+  return module;
+}
+
 void ObjectCache::ClearSamplerCache()
 {
   for (const auto& it : m_sampler_cache)
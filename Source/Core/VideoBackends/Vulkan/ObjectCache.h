@@ -6,10 +6,15 @@
 
 #include <array>
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/LinearDiskCache.h"
@@ -19,8 +24,15 @@
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderState.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/UberShaderVertex.h"
 #include "VideoCommon/VertexShaderGen.h"
 
+namespace Common
+{
+class WorkerPool;
+}
+
 namespace Vulkan
 {
 class CommandBufferManager;
@@ -111,6 +123,28 @@ public:
   VkShaderModule GetGeometryShaderForUid(const GeometryShaderUid& uid);
   VkShaderModule GetPixelShaderForUid(const PixelShaderUid& uid);
 
+  // Ubershaders, compiled synchronously on first use. There are only a handful of these.
+  VkShaderModule GetUberVertexShaderForUid(const UberVertexShaderUid& uid);
+  VkShaderModule GetUberPixelShaderForUid(const UberPixelShaderUid& uid);
+
+  // Background compilation, only available when UseBackgroundShaderCompiling() was set at
+  // startup. The Async variants queue the compile and return VK_NULL_HANDLE until the result has
+  // been retrieved, in which case the caller should draw with the ubershaders.
+  bool IsCompilingInBackground() const { return m_compile_pool != nullptr; }
+  VkShaderModule GetVertexShaderForUidAsync(const VertexShaderUid& uid);
+  VkShaderModule GetPixelShaderForUidAsync(const PixelShaderUid& uid);
+  std::pair<VkPipeline, bool> GetPipelineWithCacheResultAsync(const PipelineInfo& info);
+
+  // Moves finished background compiles into the caches. Returns true if anything was added.
+  bool RetrieveAsyncResults();
+
+  // Compiles any of the specified shaders or pipelines which are not cached yet, spread across
+  // all cores. Used to rebuild the UID cache at startup.
+  void PrecompileShaders(const std::vector<VertexShaderUid>& vs_uids,
+                         const std::vector<GeometryShaderUid>& gs_uids,
+                         const std::vector<PixelShaderUid>& ps_uids);
+  void PrecompilePipelines(const std::vector<PipelineInfo>& infos);
+
   // Static samplers
   VkSampler GetPointSampler() const { return m_point_sampler; }
   VkSampler GetLinearSampler() const { return m_linear_sampler; }
@@ -168,6 +202,8 @@ private:
   void DestroyPipelineCache();
   void LoadShaderCaches();
   void DestroyShaderCaches();
+  void WaitForBackgroundCompiles();
+  void QueueCompileResult(std::function<void()> result);
   bool CreateDescriptorSetLayouts();
   void DestroyDescriptorSetLayouts();
   bool CreatePipelineLayouts();
@@ -190,10 +226,13 @@ private:
   {
     std::map<Uid, VkShaderModule> shader_map;
     LinearDiskCache<Uid, u32> disk_cache;
+    std::set<Uid> pending;
   };
   ShaderCache<VertexShaderUid> m_vs_cache;
   ShaderCache<GeometryShaderUid> m_gs_cache;
   ShaderCache<PixelShaderUid> m_ps_cache;
+  std::map<UberVertexShaderUid, VkShaderModule> m_uber_vs_cache;
+  std::map<UberPixelShaderUid, VkShaderModule> m_uber_ps_cache;
 
   std::unordered_map<PipelineInfo, VkPipeline, PipelineInfoHash> m_pipeline_objects;
   std::unordered_map<ComputePipelineInfo, VkPipeline, ComputePipelineInfoHash>
@@ -201,6 +240,12 @@ private:
   VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
   std::string m_pipeline_cache_filename;
 
+  // Jobs on the pool only compile; the results are applied to the caches on the video thread.
+  std::unique_ptr<Common::WorkerPool> m_compile_pool;
+  std::unordered_set<PipelineInfo, PipelineInfoHash> m_pending_pipelines;
+  std::mutex m_compile_results_lock;
+  std::vector<std::function<void()>> m_compile_results;
+
   VkSampler m_point_sampler = VK_NULL_HANDLE;
   VkSampler m_linear_sampler = VK_NULL_HANDLE;
 
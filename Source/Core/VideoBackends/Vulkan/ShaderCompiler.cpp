@@ -4,10 +4,12 @@
 
 #include "VideoBackends/Vulkan/ShaderCompiler.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <string>
 
 // glslang includes
@@ -126,7 +128,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   shader->setStringsWithLengths(&pass_source_code, &pass_source_code_length, 1);
 
   auto DumpBadShader = [&](const char* msg) {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     std::string filename = StringFromFormat(
         "%sbad_%s_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), stage_filename, counter++);
 
@@ -194,7 +196,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   // Dump source code of shaders out to file if enabled.
   if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
   {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     std::string filename = StringFromFormat("%s%s_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(),
                                             stage_filename, counter++);
 
@@ -221,6 +223,10 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
 
 bool InitializeGlslang()
 {
+  // Shaders are also compiled on the background compile threads.
+  static std::mutex init_lock;
+  std::lock_guard<std::mutex> guard(init_lock);
+
   static bool glslang_initialized = false;
   if (glslang_initialized)
     return true;
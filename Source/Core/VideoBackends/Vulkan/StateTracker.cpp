@@ -120,22 +120,48 @@ void StateTracker::LoadPipelineUIDCache()
   class PipelineInserter final : public LinearDiskCacheReader<SerializedPipelineUID, u32>
   {
   public:
-    explicit PipelineInserter(StateTracker* this_ptr_) : this_ptr(this_ptr_) {}
     void Read(const SerializedPipelineUID& key, const u32* value, u32 value_size)
     {
-      this_ptr->PrecachePipelineUID(key);
+      uids.push_back(key);
     }
 
-  private:
-    StateTracker* this_ptr;
+    std::vector<SerializedPipelineUID> uids;
   };
 
   std::string filename = g_object_cache->GetDiskCacheFileName("pipeline-uid");
-  PipelineInserter inserter(this);
+  PipelineInserter inserter;
 
   // OpenAndRead calls Close() first, which will flush all data to disk when reloading.
   // This assertion must hold true, otherwise data corruption will result.
   m_uid_cache.OpenAndRead(filename, inserter);
+  PrecachePipelineUIDs(inserter.uids);
+}
+
+void StateTracker::PrecachePipelineUIDs(const std::vector<SerializedPipelineUID>& uids)
+{
+  // All of the shaders are compiled before any of the pipelines, so that both can be spread
+  // across all cores.
+  std::vector<VertexShaderUid> vs_uids;
+  std::vector<GeometryShaderUid> gs_uids;
+  std::vector<PixelShaderUid> ps_uids;
+  for (const SerializedPipelineUID& uid : uids)
+  {
+    vs_uids.push_back(uid.vs_uid);
+    if (g_vulkan_context->SupportsGeometryShaders() && !uid.gs_uid.GetUidData()->IsPassthrough())
+      gs_uids.push_back(uid.gs_uid);
+    ps_uids.push_back(uid.ps_uid);
+  }
+  g_object_cache->PrecompileShaders(vs_uids, gs_uids, ps_uids);
+
+  std::vector<PipelineInfo> pipelines;
+  pipelines.reserve(uids.size());
+  for (const SerializedPipelineUID& uid : uids)
+  {
+    PipelineInfo pinfo = {};
+    if (GetPipelineInfoForUID(uid, &pinfo))
+      pipelines.push_back(pinfo);
+  }
+  g_object_cache->PrecompilePipelines(pipelines);
 }
 
 void StateTracker::AppendToPipelineUIDCache(const PipelineInfo& info)
@@ -154,9 +180,10 @@ void StateTracker::AppendToPipelineUIDCache(const PipelineInfo& info)
   m_uid_cache.Append(sinfo, &dummy_value, 1);
 }
 
-bool StateTracker::PrecachePipelineUID(const SerializedPipelineUID& uid)
+bool StateTracker::GetPipelineInfoForUID(const SerializedPipelineUID& uid,
+                                         PipelineInfo* out_pinfo)
 {
-  PipelineInfo pinfo = {};
+  PipelineInfo& pinfo = *out_pinfo;
 
   // Need to create the vertex declaration first, rather than deferring to when a game creates a
   // vertex loader that uses this format, since we need it to create a pipeline.
@@ -191,14 +218,6 @@ bool StateTracker::PrecachePipelineUID(const SerializedPipelineUID& uid)
   pinfo.blend_state.hex = uid.blend_state_bits;
   pinfo.primitive_topology = uid.primitive_topology;
 
-  VkPipeline pipeline = g_object_cache->GetPipeline(pinfo);
-  if (pipeline == VK_NULL_HANDLE)
-  {
-    WARN_LOG(VIDEO, "Failed to get pipeline from cached UID.");
-    return false;
-  }
-
-  // We don't need to do anything with this pipeline, just make sure it exists.
   return true;
 }
 
@@ -308,9 +327,21 @@ bool StateTracker::CheckForShaderChanges(u32 gx_primitive_type)
 
   bool changed = false;
 
-  if (vs_uid != m_vs_uid)
+  // While drawing with the ubershaders, look up the specialized shaders and pipeline again on
+  // every draw, so that they are used as soon as their compile has finished.
+  const bool async = g_object_cache->IsCompilingInBackground();
+  if (async)
+  {
+    g_object_cache->RetrieveAsyncResults();
+    m_uber_vs_uid = GetUberVertexShaderUid();
+    m_uber_ps_uid = GetUberPixelShaderUid();
+    changed = m_using_ubershaders;
+  }
+
+  if (vs_uid != m_vs_uid || (m_using_ubershaders && m_pipeline_state.vs == VK_NULL_HANDLE))
   {
-    m_pipeline_state.vs = g_object_cache->GetVertexShaderForUid(vs_uid);
+    m_pipeline_state.vs = async ? g_object_cache->GetVertexShaderForUidAsync(vs_uid) :
+                                  g_object_cache->GetVertexShaderForUid(vs_uid);
     m_vs_uid = vs_uid;
     changed = true;
   }
@@ -330,9 +361,10 @@ bool StateTracker::CheckForShaderChanges(u32 gx_primitive_type)
     }
   }
 
-  if (ps_uid != m_ps_uid)
+  if (ps_uid != m_ps_uid || (m_using_ubershaders && m_pipeline_state.ps == VK_NULL_HANDLE))
   {
-    m_pipeline_state.ps = g_object_cache->GetPixelShaderForUid(ps_uid);
+    m_pipeline_state.ps = async ? g_object_cache->GetPixelShaderForUidAsync(ps_uid) :
+                                  g_object_cache->GetPixelShaderForUid(ps_uid);
     m_ps_uid = ps_uid;
     changed = true;
   }
@@ -881,6 +913,9 @@ VkPipeline StateTracker::GetPipelineAndCacheUID(const PipelineInfo& info)
 
 bool StateTracker::UpdatePipeline()
 {
+  if (g_object_cache->IsCompilingInBackground())
+    return UpdatePipelineAsync();
+
   // We need at least a vertex and fragment shader
   if (m_pipeline_state.vs == VK_NULL_HANDLE || m_pipeline_state.ps == VK_NULL_HANDLE)
     return false;
@@ -892,6 +927,42 @@ bool StateTracker::UpdatePipeline()
   return m_pipeline_object != VK_NULL_HANDLE;
 }
 
+bool StateTracker::UpdatePipelineAsync()
+{
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (m_pipeline_state.vs != VK_NULL_HANDLE && m_pipeline_state.ps != VK_NULL_HANDLE)
+  {
+    auto result = g_object_cache->GetPipelineWithCacheResultAsync(m_pipeline_state);
+    if (!result.second)
+      AppendToPipelineUIDCache(m_pipeline_state);
+
+    pipeline = result.first;
+  }
+
+  // Fall back to the ubershaders until the specialized pipeline is ready. Their pipelines are
+  // created synchronously, as the draw would otherwise have to be dropped. There are only a few
+  // ubershader modules, and each pipeline is only created once per render state.
+  m_using_ubershaders = pipeline == VK_NULL_HANDLE;
+  if (m_using_ubershaders)
+  {
+    PipelineInfo uber_info = m_pipeline_state;
+    uber_info.vs = g_object_cache->GetUberVertexShaderForUid(m_uber_vs_uid);
+    uber_info.ps = g_object_cache->GetUberPixelShaderForUid(m_uber_ps_uid);
+    if (uber_info.vs != VK_NULL_HANDLE && uber_info.ps != VK_NULL_HANDLE)
+      pipeline = g_object_cache->GetPipeline(uber_info);
+  }
+
+  // The pipeline is looked up on every draw while using the ubershaders, so only rebind it
+  // when it has actually changed.
+  if (pipeline != m_pipeline_object)
+  {
+    m_pipeline_object = pipeline;
+    m_dirty_flags |= DIRTY_FLAG_PIPELINE_BINDING;
+  }
+
+  return m_pipeline_object != VK_NULL_HANDLE;
+}
+
 bool StateTracker::UpdateDescriptorSet()
 {
   const size_t MAX_DESCRIPTOR_WRITES = NUM_UBO_DESCRIPTOR_SET_BINDINGS +  // UBO
@@ -7,6 +7,7 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/LinearDiskCache.h"
@@ -16,6 +17,8 @@
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/UberShaderVertex.h"
 #include "VideoCommon/VertexShaderGen.h"
 
 namespace Vulkan
@@ -172,8 +175,12 @@ private:
   // The info is here so that we can store variations of a UID, e.g. blend state.
   void AppendToPipelineUIDCache(const PipelineInfo& info);
 
-  // Precaches a pipeline based on the UID information.
-  bool PrecachePipelineUID(const SerializedPipelineUID& uid);
+  // Fills in a zero-initialized pipeline description from the UID information. The shaders should
+  // already have been compiled, otherwise this compiles them on the calling thread.
+  bool GetPipelineInfoForUID(const SerializedPipelineUID& uid, PipelineInfo* pinfo);
+
+  // Precaches the pipelines based on the UID information, compiling in parallel.
+  void PrecachePipelineUIDs(const std::vector<SerializedPipelineUID>& uids);
 
   // Check that the specified viewport is within the render area.
   // If not, ends the render pass if it is a clear render pass.
@@ -184,6 +191,7 @@ private:
   VkPipeline GetPipelineAndCacheUID(const PipelineInfo& info);
 
   bool UpdatePipeline();
+  bool UpdatePipelineAsync();
   bool UpdateDescriptorSet();
 
   // Allocates storage in the uniform buffer of the specified size. If this storage cannot be
@@ -207,6 +215,11 @@ private:
   GeometryShaderUid m_gs_uid = {};
   PixelShaderUid m_ps_uid = {};
 
+  // Drawn with while the specialized shaders or pipeline are compiling in the background.
+  UberVertexShaderUid m_uber_vs_uid = {};
+  UberPixelShaderUid m_uber_ps_uid = {};
+  bool m_using_ubershaders = false;
+
   // pipeline state
   PipelineInfo m_pipeline_state = {};
   VkPipeline m_pipeline_object = VK_NULL_HANDLE;
@@ -25,6 +25,12 @@ struct PixelShaderConstants
   float4 fogf[2];
   float4 zslope;
   float4 efbscale;
+
+  // The TEV state, as read by the ubershaders. Only kept up to date while shaders are compiled
+  // in the background.
+  uint4 uberstages[16];
+  uint4 uberstate;
+  uint4 uberflags;
 };
 
 struct VertexShaderConstants
@@ -46,6 +52,12 @@ struct VertexShaderConstants
   float4 posttransformmatrices[64];
   float4 pixelcentercorrection;
   float4 viewport;
+
+  // The XF state, as read by the ubershaders. Only kept up to date while shaders are compiled
+  // in the background.
+  uint4 uberxfstate;
+  uint4 uberlitchannels;
+  uint4 ubertexgens[8];
 };
 
 struct GeometryShaderConstants
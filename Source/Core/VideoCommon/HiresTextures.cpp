@@ -6,17 +6,23 @@
 
 #include <SOIL/SOIL.h>
 #include <algorithm>
+#include <array>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
 
+#include "Common/Align.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/Flag.h"
@@ -27,15 +33,33 @@
 #include "Common/Swap.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
+#include "Common/WorkerPool.h"
 #include "Core/ConfigManager.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
+#include "png.h"
+
+struct CacheEntry
+{
+  std::shared_ptr<HiresTexture> texture;
+  size_t size;
+  std::list<std::string>::iterator lru_position;
+};
 
 static std::unordered_map<std::string, std::string> s_textureMap;
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+// The cache, its LRU list, the set of textures being loaded and the stats are guarded by
+// s_textureCacheMutex. Textures are never loaded while holding it.
+static std::unordered_map<std::string, CacheEntry> s_textureCache;
+static std::list<std::string> s_textureCacheLRU;  // most recently used first
+static size_t s_textureCacheSize = 0;
+static size_t s_textureCacheBudget = 0;
+static std::unordered_set<std::string> s_texturesLoading;
+static std::condition_variable s_textureLoaded;
+static HiresTexture::Stats s_stats;
 static std::mutex s_textureCacheMutex;
-static std::mutex s_textureCacheAquireMutex;  // for high priority access
 static Common::Flag s_textureCacheAbortLoading;
+// SOIL keeps its error state in globals, so it can only decode one image at a time.
+static std::mutex s_soilMutex;
 static bool s_check_native_format;
 static bool s_check_new_format;
 
@@ -43,6 +67,53 @@ static std::thread s_prefetcher;
 
 static const std::string s_format_prefix = "tex1_";
 
+// Custom texture archives, as written by HiresTexture::PackArchive, hold all textures of a pack
+// with their mip levels in a single file, so that they can be used straight from a mapping.
+static const u32 ARCHIVE_MAGIC = 0x4B505444;  // "DTPK"
+static const u32 ARCHIVE_VERSION = 1;
+static const size_t ARCHIVE_ALIGNMENT = 64;
+static const std::string s_archive_extension = ".dtp";
+
+struct ArchiveHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+  u32 names_size;
+  u64 entries_offset;
+  u64 names_offset;
+};
+
+// Sorted by name_hash, so that a texture can be found by binary search.
+struct ArchiveEntry
+{
+  u64 name_hash;
+  u32 name_offset;
+  u32 name_size;
+  u64 texture_offset;
+};
+
+struct ArchiveTexture
+{
+  u32 format;
+  u32 num_levels;
+};
+
+struct ArchiveLevel
+{
+  u32 width;
+  u32 height;
+  u32 row_length;
+  u32 padding;
+  u64 data_offset;
+  u64 data_size;
+};
+
+static std::shared_ptr<File::MappedFile> s_archive;
+static const ArchiveEntry* s_archive_entries = nullptr;
+static u32 s_archive_num_entries = 0;
+static const char* s_archive_names = nullptr;
+
 HiresTexture::Level::Level()
 #if defined(_MSC_VER) && _MSC_VER <= 1800
     : data(nullptr)
@@ -52,48 +123,163 @@ HiresTexture::Level::Level()
 {
 }
 
-void HiresTexture::Init()
+static Common::WorkerPool& GetLoaderPool()
 {
-  s_check_native_format = false;
-  s_check_new_format = false;
+  static Common::WorkerPool pool("Custom texture loader");
+  return pool;
+}
 
-  Update();
+static size_t GetTextureSize(const HiresTexture& texture)
+{
+  size_t size = 0;
+  for (const HiresTexture::Level& level : texture.m_levels)
+    size += level.data_size;
+  return size;
 }
 
-void HiresTexture::Shutdown()
+static void RemoveFromCache(std::unordered_map<std::string, CacheEntry>::iterator iter)
 {
-  if (s_prefetcher.joinable())
+  s_textureCacheSize -= iter->second.size;
+  s_textureCacheLRU.erase(iter->second.lru_position);
+  s_textureCache.erase(iter);
+}
+
+static void ClearCache()
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  s_textureCache.clear();
+  s_textureCacheLRU.clear();
+  s_textureCacheSize = 0;
+}
+
+// Textures the game asked for evict the least recently used ones if needed, while prefetched
+// textures only take up free space and start out as the first to be evicted.
+static bool InsertIntoCache(const std::string& base_filename,
+                            const std::shared_ptr<HiresTexture>& texture, bool requested)
+{
+  const size_t size = GetTextureSize(*texture);
+  if (requested)
   {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
+    while (!s_textureCacheLRU.empty() && s_textureCacheSize + size > s_textureCacheBudget)
+    {
+      RemoveFromCache(s_textureCache.find(s_textureCacheLRU.back()));
+      s_stats.evictions++;
+    }
+  }
+  else if (s_textureCacheSize + size > s_textureCacheBudget)
+  {
+    return false;
   }
 
-  s_textureMap.clear();
-  s_textureCache.clear();
+  const auto lru_position =
+      s_textureCacheLRU.insert(requested ? s_textureCacheLRU.begin() : s_textureCacheLRU.end(),
+                               base_filename);
+  s_textureCache[base_filename] = {texture, size, lru_position};
+  s_textureCacheSize += size;
+  return true;
 }
 
-void HiresTexture::Update()
+static u64 HashTextureName(const std::string& name)
 {
-  if (s_prefetcher.joinable())
+  return XXH64(name.data(), name.size(), 0);
+}
+
+static const ArchiveEntry* FindInArchive(const std::string& name)
+{
+  if (!s_archive)
+    return nullptr;
+
+  const u64 hash = HashTextureName(name);
+  const ArchiveEntry* end = s_archive_entries + s_archive_num_entries;
+  auto iter = std::lower_bound(
+      s_archive_entries, end, hash,
+      [](const ArchiveEntry& entry, u64 name_hash) { return entry.name_hash < name_hash; });
+  for (; iter != end && iter->name_hash == hash; ++iter)
   {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
+    if (name.compare(0, std::string::npos, s_archive_names + iter->name_offset, iter->name_size) ==
+        0)
+    {
+      return iter;
+    }
   }
+  return nullptr;
+}
 
-  if (!g_ActiveConfig.bHiresTextures)
+static bool HasTexture(const std::string& name)
+{
+  return s_textureMap.find(name) != s_textureMap.end() || FindInArchive(name);
+}
+
+void HiresTexture::CloseArchive()
+{
+  s_archive.reset();
+  s_archive_entries = nullptr;
+  s_archive_num_entries = 0;
+  s_archive_names = nullptr;
+}
+
+bool HiresTexture::OpenArchive(const std::string& filename)
+{
+  CloseArchive();
+
+  if (!File::Exists(filename))
+    return false;
+
+  auto archive = std::make_shared<File::MappedFile>();
+  if (!archive->Open(filename))
+    return false;
+
+  const u8* data = archive->GetData();
+  const u64 size = archive->GetSize();
+  ArchiveHeader header;
+  if (size < sizeof(header))
   {
-    s_textureMap.clear();
-    s_textureCache.clear();
-    return;
+    ERROR_LOG(VIDEO, "Custom texture archive %s is truncated", filename.c_str());
+    return false;
   }
+  std::memcpy(&header, data, sizeof(header));
 
-  if (!g_ActiveConfig.bCacheHiresTextures)
+  if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION ||
+      header.entries_offset % alignof(ArchiveEntry) != 0 || header.entries_offset > size ||
+      header.num_entries > (size - header.entries_offset) / sizeof(ArchiveEntry) ||
+      header.names_offset > size || header.names_size > size - header.names_offset)
   {
-    s_textureCache.clear();
+    ERROR_LOG(VIDEO, "Custom texture archive %s is invalid", filename.c_str());
+    return false;
   }
 
-  const std::string& game_id = SConfig::GetInstance().GetGameID();
-  const std::string texture_directory = GetTextureDirectory(game_id);
+  const ArchiveEntry* entries = reinterpret_cast<const ArchiveEntry*>(data + header.entries_offset);
+  const char* names = reinterpret_cast<const char*>(data + header.names_offset);
+  for (u32 i = 0; i < header.num_entries; ++i)
+  {
+    const ArchiveEntry& entry = entries[i];
+    if (u64(entry.name_offset) + entry.name_size > header.names_size)
+    {
+      ERROR_LOG(VIDEO, "Custom texture archive %s is invalid", filename.c_str());
+      return false;
+    }
+
+    if (std::string(names + entry.name_offset, entry.name_size).compare(0, s_format_prefix.size(),
+                                                                       s_format_prefix) == 0)
+    {
+      s_check_new_format = true;
+    }
+    else
+    {
+      s_check_native_format = true;
+    }
+  }
+
+  s_archive = std::move(archive);
+  s_archive_entries = entries;
+  s_archive_num_entries = header.num_entries;
+  s_archive_names = names;
+  INFO_LOG(VIDEO, "Using %u custom textures from %s", header.num_entries, filename.c_str());
+  return true;
+}
+
+static void ScanTextureDirectory(const std::string& texture_directory, const std::string& game_id)
+{
   std::vector<std::string> extensions{
       ".png", ".bmp", ".tga", ".dds",
       ".jpg"  // Why not? Could be useful for large photo-like textures
@@ -121,100 +307,169 @@ void HiresTexture::Update()
       s_check_new_format = true;
     }
   }
+}
+
+void HiresTexture::Init()
+{
+  s_check_native_format = false;
+  s_check_new_format = false;
+
+  Update();
+}
+
+void HiresTexture::Shutdown()
+{
+  if (s_prefetcher.joinable())
+  {
+    s_textureCacheAbortLoading.Set();
+    s_prefetcher.join();
+  }
+
+  s_textureMap.clear();
+  ClearCache();
+  CloseArchive();
+  s_stats = {};
+}
+
+void HiresTexture::Update()
+{
+  if (s_prefetcher.joinable())
+  {
+    s_textureCacheAbortLoading.Set();
+    s_prefetcher.join();
+  }
+
+  if (!g_ActiveConfig.bHiresTextures)
+  {
+    s_textureMap.clear();
+    ClearCache();
+    CloseArchive();
+    return;
+  }
+
+  if (!g_ActiveConfig.bCacheHiresTextures)
+  {
+    ClearCache();
+  }
+
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+
+  // Loose files take precedence over the archive, so that packs can be patched without repacking.
+  OpenArchive(GetArchivePath(game_id));
+  ScanTextureDirectory(GetTextureDirectory(game_id), game_id);
 
   if (g_ActiveConfig.bCacheHiresTextures)
   {
+    std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+
     // remove cached but deleted textures
     auto iter = s_textureCache.begin();
     while (iter != s_textureCache.end())
     {
-      if (s_textureMap.find(iter->first) == s_textureMap.end())
-      {
-        iter = s_textureCache.erase(iter);
-      }
-      else
-      {
-        iter++;
-      }
+      auto next = std::next(iter);
+      if (!HasTexture(iter->first))
+        RemoveFromCache(iter);
+      iter = next;
     }
 
+    size_t sys_mem = Common::MemPhysical();
+    size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
+    // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other
+    // cases
+    s_textureCacheBudget =
+        (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+    lk.unlock();
+
     s_textureCacheAbortLoading.Clear();
     s_prefetcher = std::thread(Prefetch);
   }
 }
 
+std::shared_ptr<HiresTexture> HiresTexture::LoadTimed(const std::string& base_filename,
+                                                      u32 width, u32 height)
+{
+  const u64 start_time = Common::Timer::GetTimeUs();
+  std::shared_ptr<HiresTexture> texture(Load(base_filename, width, height));
+  const u64 load_time = Common::Timer::GetTimeUs() - start_time;
+
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  s_stats.loads++;
+  s_stats.load_time += load_time;
+  return texture;
+}
+
 void HiresTexture::Prefetch()
 {
   Common::SetCurrentThreadName("Prefetcher");
 
-  size_t size_sum = 0;
-  size_t sys_mem = Common::MemPhysical();
-  size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
-  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  size_t max_mem =
-      (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
-  u32 starttime = Common::Timer::GetTimeMs();
+  std::vector<std::string> base_filenames;
   for (const auto& entry : s_textureMap)
   {
-    const std::string& base_filename = entry.first;
+    if (entry.first.find("_mip") == std::string::npos)
+      base_filenames.push_back(entry.first);
+  }
+  for (u32 i = 0; i < s_archive_num_entries; ++i)
+  {
+    std::string name(s_archive_names + s_archive_entries[i].name_offset,
+                     s_archive_entries[i].name_size);
+    if (s_textureMap.find(name) == s_textureMap.end())
+      base_filenames.push_back(std::move(name));
+  }
 
-    if (base_filename.find("_mip") == std::string::npos)
+  Common::Flag budget_reached;
+  u32 starttime = Common::Timer::GetTimeMs();
+  GetLoaderPool().ParallelFor(base_filenames.size(), [&](size_t i) {
+    if (s_textureCacheAbortLoading.IsSet() || budget_reached.IsSet())
+      return;
+
+    const std::string& base_filename = base_filenames[i];
     {
-      {
-        // try to get this mutex first, so the video thread is allow to get the real mutex faster
-        std::unique_lock<std::mutex> lk(s_textureCacheAquireMutex);
-      }
-      std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+      std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+      if (s_textureCache.count(base_filename) || !s_texturesLoading.insert(base_filename).second)
+        return;
+    }
 
-      auto iter = s_textureCache.find(base_filename);
-      if (iter == s_textureCache.end())
-      {
-        // unlock while loading a texture. This may result in a race condition where we'll load a
-        // texture twice,
-        // but it reduces the stuttering a lot. Notice: The loading library _must_ be thread safe
-        // now.
-        // But bad luck, SOIL isn't, so TODO: remove SOIL usage here and use libpng directly
-        // Also TODO: remove s_textureCacheAquireMutex afterwards. It won't be needed as the main
-        // mutex will be locked rarely
-        // lk.unlock();
-        std::unique_ptr<HiresTexture> texture = Load(base_filename, 0, 0);
-        // lk.lock();
-        if (texture)
-        {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
-        }
-      }
-      if (iter != s_textureCache.end())
+    std::shared_ptr<HiresTexture> texture = LoadTimed(base_filename, 0, 0);
+
+    {
+      std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+      s_texturesLoading.erase(base_filename);
+      // A texture requested by the game in the meantime may have been loaded already.
+      if (texture && !s_textureCache.count(base_filename))
       {
-        for (const Level& l : iter->second->m_levels)
-        {
-          size_sum += l.data_size;
-        }
+        if (InsertIntoCache(base_filename, texture, false))
+          s_stats.prefetched++;
+        else
+          budget_reached.Set();
       }
     }
+    s_textureLoaded.notify_all();
+  });
 
-    if (s_textureCacheAbortLoading.IsSet())
-    {
-      return;
-    }
+  if (s_textureCacheAbortLoading.IsSet())
+    return;
 
-    if (size_sum > max_mem)
-    {
-      g_Config.bCacheHiresTextures = false;
+  u32 stoptime = Common::Timer::GetTimeMs();
+  size_t size_sum;
+  {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    size_sum = s_textureCacheSize;
+  }
 
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      return;
-    }
+  if (budget_reached.IsSet())
+  {
+    OSD::AddMessage(StringFromFormat("Custom Textures prefetching stopped after %.1f MB, the rest "
+                                     "will be loaded on demand",
+                                     size_sum / (1024.0 * 1024.0)),
+                    10000);
+  }
+  else
+  {
+    OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
+                                     size_sum / (1024.0 * 1024.0),
+                                     (stoptime - starttime) / 1000.0),
+                    10000);
   }
-  u32 stoptime = Common::Timer::GetTimeMs();
-  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
-                                   size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0),
-                  10000);
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
@@ -233,7 +488,7 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
                                 0;
     name = StringFromFormat("%s_%08x_%i", SConfig::GetInstance().GetGameID().c_str(),
                             (u32)(tex_hash ^ tlut_hash), (u16)format);
-    if (s_textureMap.find(name) != s_textureMap.end())
+    if (HasTexture(name))
     {
       if (g_ActiveConfig.bConvertHiresTextures)
         convert = true;
@@ -360,11 +615,11 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
     }
 
     // try to match a wildcard template
-    if (!dump && s_textureMap.find(basename + "_*" + formatname) != s_textureMap.end())
+    if (!dump && HasTexture(basename + "_*" + formatname))
       return basename + "_*" + formatname;
 
     // else generate the complete texture
-    if (dump || s_textureMap.find(fullname) != s_textureMap.end())
+    if (dump || HasTexture(fullname))
       return fullname;
   }
 
@@ -393,32 +648,60 @@ std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t tex
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
 
-  std::lock_guard<std::mutex> lk2(s_textureCacheAquireMutex);
-  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  if (!HasTexture(base_filename))
+    return nullptr;
+
+  if (!g_ActiveConfig.bCacheHiresTextures)
+    return LoadTimed(base_filename, width, height);
+
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+
+  // If the prefetcher is loading this texture already, waiting for it is quicker than loading it
+  // a second time.
+  s_textureLoaded.wait(lk, [&base_filename] { return !s_texturesLoading.count(base_filename); });
 
   auto iter = s_textureCache.find(base_filename);
   if (iter != s_textureCache.end())
   {
-    return iter->second;
+    s_textureCacheLRU.splice(s_textureCacheLRU.begin(), s_textureCacheLRU,
+                             iter->second.lru_position);
+    s_stats.hits++;
+    return iter->second.texture;
   }
 
-  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  s_stats.misses++;
+  s_texturesLoading.insert(base_filename);
+  lk.unlock();
 
-  if (ptr && g_ActiveConfig.bCacheHiresTextures)
-  {
-    s_textureCache[base_filename] = ptr;
-  }
+  std::shared_ptr<HiresTexture> ptr = LoadTimed(base_filename, width, height);
+
+  lk.lock();
+  s_texturesLoading.erase(base_filename);
+  if (ptr)
+    InsertIntoCache(base_filename, ptr, true);
+  lk.unlock();
+  s_textureLoaded.notify_all();
 
   return ptr;
 }
 
+HiresTexture::Stats HiresTexture::GetStats()
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  Stats stats = s_stats;
+  stats.textures_cached = static_cast<u32>(s_textureCache.size());
+  stats.bytes_cached = s_textureCacheSize;
+  stats.budget = s_textureCacheBudget;
+  return stats;
+}
+
 std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
                                                  u32 height)
 {
   // We need to have a level 0 custom texture to even consider loading.
   auto filename_iter = s_textureMap.find(base_filename);
   if (filename_iter == s_textureMap.end())
-    return nullptr;
+    return LoadFromArchive(base_filename);
 
   // Try to load level 0 (and any mipmaps) from a DDS file.
   // If this fails, it's fine, we'll just load level0 again using SOIL.
@@ -522,14 +805,224 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   return ret;
 }
 
+std::unique_ptr<HiresTexture> HiresTexture::LoadFromArchive(const std::string& base_filename)
+{
+  const ArchiveEntry* entry = FindInArchive(base_filename);
+  if (!entry)
+    return nullptr;
+
+  const u8* data = s_archive->GetData();
+  const u64 size = s_archive->GetSize();
+  ArchiveTexture texture;
+  if (entry->texture_offset > size - sizeof(texture))
+  {
+    ERROR_LOG(VIDEO, "Custom texture %s is out of the archive bounds", base_filename.c_str());
+    return nullptr;
+  }
+  std::memcpy(&texture, data + entry->texture_offset, sizeof(texture));
+
+  const u64 levels_offset = entry->texture_offset + sizeof(texture);
+  if (texture.format > static_cast<u32>(HostTextureFormat::DXT5) || texture.num_levels == 0 ||
+      texture.num_levels > (size - levels_offset) / sizeof(ArchiveLevel))
+  {
+    ERROR_LOG(VIDEO, "Custom texture %s in the archive is invalid", base_filename.c_str());
+    return nullptr;
+  }
+
+  // Can't use make_unique due to private constructor.
+  std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
+  ret->m_archive = s_archive;
+  for (u32 i = 0; i < texture.num_levels; ++i)
+  {
+    ArchiveLevel archive_level;
+    std::memcpy(&archive_level, data + levels_offset + i * sizeof(ArchiveLevel),
+                sizeof(archive_level));
+    if (archive_level.data_offset > size ||
+        archive_level.data_size > size - archive_level.data_offset)
+    {
+      ERROR_LOG(VIDEO, "Custom texture %s is out of the archive bounds", base_filename.c_str());
+      return nullptr;
+    }
+
+    // The data stays mapped for as long as the texture holds on to the archive.
+    Level level;
+    level.data = ImageDataPointer(const_cast<u8*>(data + archive_level.data_offset), [](u8*) {});
+    level.format = static_cast<HostTextureFormat>(texture.format);
+    level.width = archive_level.width;
+    level.height = archive_level.height;
+    level.row_length = archive_level.row_length;
+    level.data_size = archive_level.data_size;
+    ret->m_levels.push_back(std::move(level));
+  }
+
+  return ret;
+}
+
+static void WritePadding(File::IOFile& file, size_t alignment)
+{
+  static const std::array<u8, ARCHIVE_ALIGNMENT> zeros{};
+  const u64 position = file.Tell();
+  file.WriteBytes(zeros.data(), Common::AlignUp(position, alignment) - position);
+}
+
+bool HiresTexture::PackArchive(const std::string& game_id)
+{
+  const std::string texture_directory = GetTextureDirectory(game_id);
+  const std::string archive_filename = texture_directory + s_archive_extension;
+
+  CloseArchive();
+  s_textureMap.clear();
+  ScanTextureDirectory(texture_directory, game_id);
+
+  struct PackedTexture
+  {
+    u64 name_hash;
+    std::string name;
+    u64 offset;
+  };
+  std::vector<PackedTexture> textures;
+  for (const auto& entry : s_textureMap)
+  {
+    if (entry.first.find("_mip") == std::string::npos)
+      textures.push_back({HashTextureName(entry.first), entry.first, 0});
+  }
+  std::sort(textures.begin(), textures.end(), [](const PackedTexture& a, const PackedTexture& b) {
+    return std::tie(a.name_hash, a.name) < std::tie(b.name_hash, b.name);
+  });
+
+  // Another instance may have the old archive mapped, and truncating it in place would crash that
+  // one. A rename leaves the old file intact for as long as it stays mapped.
+  const std::string temp_filename = archive_filename + ".tmp";
+  File::IOFile file(temp_filename, "wb");
+  if (!file)
+  {
+    ERROR_LOG(VIDEO, "Failed to create custom texture archive %s", temp_filename.c_str());
+    s_textureMap.clear();
+    return false;
+  }
+
+  // The header is written last, once all offsets are known.
+  ArchiveHeader header = {};
+  file.WriteBytes(&header, sizeof(header));
+
+  u64 data_size = 0;
+  for (PackedTexture& packed : textures)
+  {
+    // DDS files keep their block compression, everything else is decoded to RGBA8.
+    std::unique_ptr<HiresTexture> texture = Load(packed.name, 0, 0);
+    if (!texture)
+    {
+      WARN_LOG(VIDEO, "Skipping custom texture %s, which failed to load", packed.name.c_str());
+      continue;
+    }
+
+    WritePadding(file, ARCHIVE_ALIGNMENT);
+    packed.offset = file.Tell();
+
+    const ArchiveTexture archive_texture = {static_cast<u32>(texture->GetFormat()),
+                                            static_cast<u32>(texture->m_levels.size())};
+    file.WriteBytes(&archive_texture, sizeof(archive_texture));
+
+    u64 data_offset = Common::AlignUp(packed.offset + sizeof(archive_texture) +
+                                          texture->m_levels.size() * sizeof(ArchiveLevel),
+                                      ARCHIVE_ALIGNMENT);
+    for (const Level& level : texture->m_levels)
+    {
+      const ArchiveLevel archive_level = {level.width,  level.height,    level.row_length, 0,
+                                          data_offset, level.data_size};
+      file.WriteBytes(&archive_level, sizeof(archive_level));
+      data_offset = Common::AlignUp(data_offset + level.data_size, ARCHIVE_ALIGNMENT);
+    }
+
+    for (const Level& level : texture->m_levels)
+    {
+      WritePadding(file, ARCHIVE_ALIGNMENT);
+      file.WriteBytes(level.data.get(), level.data_size);
+      data_size += level.data_size;
+    }
+  }
+  s_textureMap.clear();
+
+  textures.erase(std::remove_if(textures.begin(), textures.end(),
+                                [](const PackedTexture& packed) { return packed.offset == 0; }),
+                 textures.end());
+
+  header.magic = ARCHIVE_MAGIC;
+  header.version = ARCHIVE_VERSION;
+  header.num_entries = static_cast<u32>(textures.size());
+  header.names_offset = file.Tell();
+  std::vector<ArchiveEntry> entries;
+  for (const PackedTexture& packed : textures)
+  {
+    entries.push_back({packed.name_hash, header.names_size, static_cast<u32>(packed.name.size()),
+                       packed.offset});
+    file.WriteBytes(packed.name.data(), packed.name.size());
+    header.names_size += static_cast<u32>(packed.name.size());
+  }
+
+  WritePadding(file, alignof(ArchiveEntry));
+  header.entries_offset = file.Tell();
+  file.WriteArray(entries.data(), entries.size());
+
+  file.Seek(0, SEEK_SET);
+  file.WriteBytes(&header, sizeof(header));
+  if (!file.Close())
+  {
+    ERROR_LOG(VIDEO, "Failed to write custom texture archive %s", temp_filename.c_str());
+    File::Delete(temp_filename);
+    return false;
+  }
+  if (!File::Rename(temp_filename, archive_filename))
+  {
+    ERROR_LOG(VIDEO, "Failed to replace custom texture archive %s", archive_filename.c_str());
+    File::Delete(temp_filename);
+    return false;
+  }
+
+  NOTICE_LOG(VIDEO, "Packed %zu custom textures (%.1f MB) into %s", textures.size(),
+             data_size / (1024.0 * 1024.0), archive_filename.c_str());
+  return true;
+}
+
+bool HiresTexture::LoadPNGTexture(Level& level, const std::vector<u8>& buffer)
+{
+  png_image image = {};
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_memory(&image, buffer.data(), buffer.size()))
+    return false;
+
+  image.format = PNG_FORMAT_RGBA;
+  const size_t data_size = PNG_IMAGE_SIZE(image);
+  ImageDataPointer data(new u8[data_size], [](u8* ptr) { delete[] ptr; });
+  if (!png_image_finish_read(&image, nullptr, data.get(), 0, nullptr))
+  {
+    png_image_free(&image);
+    return false;
+  }
+
+  level.width = image.width;
+  level.height = image.height;
+  level.format = HostTextureFormat::RGBA8;
+  level.data = std::move(data);
+  level.row_length = level.width;
+  level.data_size = data_size;
+  return true;
+}
+
 bool HiresTexture::LoadTexture(Level& level, const std::vector<u8>& buffer)
 {
+  // Unlike SOIL, libpng can decode several images in parallel.
+  if (buffer.size() >= 8 && png_sig_cmp(buffer.data(), 0, 8) == 0)
+    return LoadPNGTexture(level, buffer);
+
   int channels;
   int width;
   int height;
 
+  std::unique_lock<std::mutex> lk(s_soilMutex);
   u8* data = SOIL_load_image_from_memory(buffer.data(), static_cast<int>(buffer.size()), &width,
                                          &height, &channels, SOIL_LOAD_RGBA);
+  lk.unlock();
   if (!data)
     return false;
 
@@ -543,6 +1036,18 @@ bool HiresTexture::LoadTexture(Level& level, const std::vector<u8>& buffer)
   return true;
 }
 
+std::string HiresTexture::GetArchivePath(const std::string& game_id)
+{
+  const std::string archive =
+      File::GetUserPath(D_HIRESTEXTURES_IDX) + game_id + s_archive_extension;
+
+  // If there's no archive with the region-specific ID, look for a 3-character region-free one
+  if (!File::Exists(archive))
+    return File::GetUserPath(D_HIRESTEXTURES_IDX) + game_id.substr(0, 3) + s_archive_extension;
+
+  return archive;
+}
+
 std::string HiresTexture::GetTextureDirectory(const std::string& game_id)
 {
   const std::string texture_directory = File::GetUserPath(D_HIRESTEXTURES_IDX) + game_id;
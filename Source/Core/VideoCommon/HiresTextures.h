@@ -11,8 +11,16 @@
 #include "Common/CommonTypes.h"
 #include "VideoCommon/VideoCommon.h"
 
+namespace File
+{
+class MappedFile;
+}
+
 class HiresTexture
 {
+  // Opens and loads from archives without a running game.
+  friend class HiresTextureTest;
+
 public:
 #if defined(_MSC_VER) && _MSC_VER <= 1800
   using ImageDataPointer = u8*;
@@ -20,9 +28,24 @@ public:
   using ImageDataPointer = std::unique_ptr<u8, void (*)(unsigned char*)>;
 #endif
 
+  struct Stats
+  {
+    u32 textures_cached = 0;
+    size_t bytes_cached = 0;
+    size_t budget = 0;
+    u32 prefetched = 0;
+    // Requested textures that were found in the cache, or had to be loaded on demand.
+    u32 hits = 0;
+    u32 misses = 0;
+    u32 evictions = 0;
+    u32 loads = 0;
+    u64 load_time = 0;  // microseconds
+  };
+
   static void Init();
   static void Update();
   static void Shutdown();
+  static Stats GetStats();
 
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
@@ -34,6 +57,10 @@ public:
 
   static u32 CalculateMipCount(u32 width, u32 height);
 
+  // Packs the custom textures of a game into a single archive next to their directory, which is
+  // then preferred over scanning the loose files. Not to be used while a game is running.
+  static bool PackArchive(const std::string& game_id);
+
   ~HiresTexture();
 
   HostTextureFormat GetFormat() const;
@@ -53,12 +80,22 @@ public:
 private:
   static std::unique_ptr<HiresTexture> Load(const std::string& base_filename, u32 width,
                                             u32 height);
+  static std::unique_ptr<HiresTexture> LoadFromArchive(const std::string& base_filename);
+  static bool OpenArchive(const std::string& filename);
+  static void CloseArchive();
+  static std::shared_ptr<HiresTexture> LoadTimed(const std::string& base_filename, u32 width,
+                                                 u32 height);
   static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
+  static bool LoadPNGTexture(Level& level, const std::vector<u8>& buffer);
   static void Prefetch();
 
   static std::string GetTextureDirectory(const std::string& game_id);
+  static std::string GetArchivePath(const std::string& game_id);
 
   HiresTexture() {}
+
+  // Keeps the archive mapped while the levels point into it.
+  std::shared_ptr<File::MappedFile> m_archive;
 };
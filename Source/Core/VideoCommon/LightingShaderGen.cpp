@@ -208,3 +208,105 @@ void GetLightingShaderUid(LightingUidData& uid_data)
     }
   }
 }
+
+void WriteUberLightingFunction(ShaderCode& object)
+{
+  object.Write("int4 CalculateLighting(uint index, uint attnfunc, uint diffusefunc, float3 pos, "
+               "float3 normal)\n"
+               "{\n"
+               "\tfloat3 ldir, cosAttn, distAttn;\n"
+               "\tfloat dist, dist2, attn;\n"
+               "\tif (attnfunc == %uu)\n"
+               "\t{\n"
+               "\t\tldir = normalize(" I_LIGHTS "[index].pos.xyz - pos.xyz);\n"
+               "\t\tattn = (dot(normal, ldir) >= 0.0) ? max(0.0, dot(normal, " I_LIGHTS
+               "[index].dir.xyz)) : 0.0;\n"
+               "\t\tcosAttn = " I_LIGHTS "[index].cosatt.xyz;\n"
+               "\t\tdistAttn = (diffusefunc == %uu) ? " I_LIGHTS "[index].distatt.xyz : normalize("
+               I_LIGHTS "[index].distatt.xyz);\n"
+               "\t\tattn = max(0.0f, dot(cosAttn, float3(1.0, attn, attn*attn))) / dot(distAttn, "
+               "float3(1.0, attn, attn*attn));\n"
+               "\t}\n"
+               "\telse if (attnfunc == %uu)\n"
+               "\t{\n"
+               "\t\tldir = " I_LIGHTS "[index].pos.xyz - pos.xyz;\n"
+               "\t\tdist2 = dot(ldir, ldir);\n"
+               "\t\tdist = sqrt(dist2);\n"
+               "\t\tldir = ldir / dist;\n"
+               "\t\tattn = max(0.0, dot(ldir, " I_LIGHTS "[index].dir.xyz));\n"
+               "\t\tattn = max(0.0, " I_LIGHTS "[index].cosatt.x + " I_LIGHTS
+               "[index].cosatt.y*attn + " I_LIGHTS "[index].cosatt.z*attn*attn) / dot(" I_LIGHTS
+               "[index].distatt.xyz, float3(1.0,dist,dist2));\n"
+               "\t}\n"
+               "\telse\n"
+               "\t{\n"
+               "\t\tldir = normalize(" I_LIGHTS "[index].pos.xyz - pos.xyz);\n"
+               "\t\tattn = 1.0;\n"
+               "\t\tif (length(ldir) == 0.0)\n"
+               "\t\t\tldir = normal;\n"
+               "\t}\n"
+               "\tif (diffusefunc == %uu)\n"
+               "\t\treturn int4(round(attn * float4(" I_LIGHTS "[index].color)));\n"
+               "\tfloat diffuse = dot(ldir, normal);\n"
+               "\tif (diffusefunc != %uu)\n"
+               "\t\tdiffuse = max(0.0, diffuse);\n"
+               "\treturn int4(round(attn * diffuse * float4(" I_LIGHTS "[index].color)));\n"
+               "}\n\n",
+               LIGHTATTN_SPEC, LIGHTDIF_NONE, LIGHTATTN_SPOT, LIGHTDIF_NONE, LIGHTDIF_SIGN);
+}
+
+// Same as GenerateLightingShaderCode, but with the LitChannel registers read from uniforms.
+// components is still static, as it decides which vertex colors exist.
+void GenerateUberLightingShaderCode(ShaderCode& object, int components, const char* inColorName,
+                                    const char* dest)
+{
+  static const char* const color_regs[] = {I_UBER_LITCHANNELS ".x", I_UBER_LITCHANNELS ".y"};
+  static const char* const alpha_regs[] = {I_UBER_LITCHANNELS ".z", I_UBER_LITCHANNELS ".w"};
+
+  for (unsigned int j = 0; j < 2; j++)
+  {
+    object.Write("if (" I_UBER_XFSTATE ".x > %uu)\n{\n", j);
+    object.Write("uint colorreg = %s;\n"
+                 "uint alphareg = %s;\n",
+                 color_regs[j], alpha_regs[j]);
+
+    if (components & (VB_HAS_COL0 << j))
+      object.Write("int4 vertcolor = int4(round(%s%d * 255.0));\n", inColorName, j);
+    else if (components & VB_HAS_COL0)
+      object.Write("int4 vertcolor = int4(round(%s0 * 255.0));\n", inColorName);
+    else
+      object.Write("int4 vertcolor = int4(255, 255, 255, 255);\n");
+
+    // Bit 0 is matsource, bit 1 enablelighting and bit 6 ambsource.
+    object.Write("int4 mat = ((colorreg & 1u) != 0u) ? vertcolor : %s[%d];\n", I_MATERIALS, j + 2);
+    object.Write("mat.w = ((alphareg & 1u) != 0u) ? vertcolor.w : %s[%d].w;\n", I_MATERIALS,
+                 j + 2);
+    object.Write("int4 lacc = int4(255, 255, 255, 255);\n");
+    object.Write("if ((colorreg & 2u) != 0u)\n"
+                 "\tlacc.xyz = ((colorreg & 64u) != 0u) ? vertcolor.xyz : %s[%d].xyz;\n",
+                 I_MATERIALS, j);
+    object.Write("if ((alphareg & 2u) != 0u)\n"
+                 "\tlacc.w = ((alphareg & 64u) != 0u) ? vertcolor.w : %s[%d].w;\n",
+                 I_MATERIALS, j);
+
+    static const char* const lit_channels[][2] = {{"colorreg", "xyz"}, {"alphareg", "w"}};
+    for (const auto& chan : lit_channels)
+    {
+      object.Write("if ((%s & 2u) != 0u)\n"
+                   "{\n"
+                   "\tuint lightmask = ((%s >> 2) & 15u) | ((%s >> 7) & 240u);\n"
+                   "\tfor (uint i = 0u; i < 8u; i++)\n"
+                   "\t{\n"
+                   "\t\tif ((lightmask & (1u << i)) != 0u)\n"
+                   "\t\t\tlacc.%s += CalculateLighting(i, (%s >> 9) & 3u, (%s >> 7) & 3u, "
+                   "pos.xyz, _norm0).%s;\n"
+                   "\t}\n"
+                   "}\n",
+                   chan[0], chan[0], chan[0], chan[1], chan[0], chan[0], chan[1]);
+    }
+
+    object.Write("lacc = clamp(lacc, 0, 255);\n");
+    object.Write("%s%d = float4((mat * (lacc + (lacc >> 7))) >> 8) / 255.0;\n", dest, j);
+    object.Write("}\n");
+  }
+}
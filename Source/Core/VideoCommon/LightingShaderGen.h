@@ -47,3 +47,9 @@ static const char s_lighting_struct[] = "struct Light {\n"
 void GenerateLightingShaderCode(ShaderCode& object, const LightingUidData& uid_data, int components,
                                 u32 numColorChans, const char* inColorName, const char* dest);
 void GetLightingShaderUid(LightingUidData& uid_data);
+
+// The ubershader versions of the above, which read the channel setup from I_UBER_LITCHANNELS.
+// The helper function has to be written before main().
+void WriteUberLightingFunction(ShaderCode& object);
+void GenerateUberLightingShaderCode(ShaderCode& object, int components, const char* inColorName,
+                                    const char* dest);
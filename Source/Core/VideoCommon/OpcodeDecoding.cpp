@@ -163,10 +163,14 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
     {
     case GX_NOP:
       totalCycles += 6;  // Hm, this means that we scan over nop streams pretty slowly...
+      if (!is_preprocess)
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_NOP]);
       break;
 
     case GX_UNKNOWN_RESET:
       totalCycles += 6;  // Datel software uses this command
+      if (!is_preprocess)
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_OTHER]);
       DEBUG_LOG(VIDEO, "GX Reset?: %08x", cmd_byte);
       break;
 
@@ -179,7 +183,10 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
       u32 value = src.Read<u32>();
       LoadCPReg(sub_cmd, value, is_preprocess);
       if (!is_preprocess)
+      {
         INCSTAT(stats.thisFrame.numCPLoads);
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_LOAD_CP_REG]);
+      }
     }
     break;
 
@@ -198,6 +205,7 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
         LoadXFReg(transfer_size, xf_address, src);
 
         INCSTAT(stats.thisFrame.numXFLoads);
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_LOAD_XF_REG]);
       }
       src.Skip<u32>(transfer_size);
     }
@@ -222,7 +230,10 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
       if (is_preprocess)
         PreprocessIndexedXF(src.Read<u32>(), refarray);
       else
+      {
         LoadIndexedXF(src.Read<u32>(), refarray);
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_LOAD_INDX]);
+      }
       break;
 
     case GX_CMD_CALL_DL:
@@ -231,6 +242,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
         goto end;
       u32 address = src.Read<u32>();
       u32 count = src.Read<u32>();
+      if (!is_preprocess)
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_CALL_DL]);
 
       if (in_display_list)
       {
@@ -250,11 +263,15 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
     case GX_CMD_UNKNOWN_METRICS:  // zelda 4 swords calls it and checks the metrics registers after
                                   // that
       totalCycles += 6;
+      if (!is_preprocess)
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_OTHER]);
       DEBUG_LOG(VIDEO, "GX 0x44: %08x", cmd_byte);
       break;
 
     case GX_CMD_INVL_VC:  // Invalidate Vertex Cache
       totalCycles += 6;
+      if (!is_preprocess)
+        INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_OTHER]);
       DEBUG_LOG(VIDEO, "Invalidate (vertex cache?)");
       break;
 
@@ -274,6 +291,7 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
         {
           LoadBPReg(bp_cmd);
           INCSTAT(stats.thisFrame.numBPLoads);
+          INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_LOAD_BP_REG]);
         }
       }
       break;
@@ -295,6 +313,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
           goto end;
 
         src.Skip(bytes);
+        if (!is_preprocess)
+          INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_DRAW_PRIMITIVES]);
 
         // 4 GPU ticks per vertex, 3 CPU ticks per GPU tick
         totalCycles += num_vertices * 4 * 3 + 6;
@@ -308,6 +328,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
                   opcodeStart, is_preprocess ? "yes" : "no");
         s_bFifoErrorSeen = true;
         totalCycles += 1;
+        if (!is_preprocess)
+          INCSTAT(stats.totals.numOpcodes[Statistics::OPCODE_OTHER]);
       }
       break;
     }
@@ -9,6 +9,7 @@
 #include "Common/CommonTypes.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/UberShaderPixel.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
@@ -99,6 +100,80 @@ void PixelShaderManager::SetConstants()
     dirty = true;
     s_bViewPortChanged = false;
   }
+
+  if (g_ActiveConfig.UseBackgroundShaderCompiling())
+    SetUberShaderConstants();
+}
+
+void PixelShaderManager::SetUberShaderConstants()
+{
+  // The ubershaders read the registers which the specialized shaders bake into their uids.
+  // They change far more often than the constants, so rather than tracking every register
+  // write, repack them on each draw and only mark the buffer dirty on a change.
+  uint4 stages[16] = {};
+  const u32 num_stages = bpmem.genMode.numtevstages + 1;
+  for (u32 i = 0; i < num_stages; i++)
+  {
+    const u32 order = (bpmem.tevorders[i / 2].hex >> (12 * (i & 1))) & 0x3FF;
+    const u32 ksel = (bpmem.tevksel[i / 2].hex >> (4 + 10 * (i & 1))) & 0x3FF;
+    stages[i][0] = bpmem.combiners[i].colorC.hex & 0xFFFFFF;
+    stages[i][1] = bpmem.combiners[i].alphaC.hex & 0xFFFFFF;
+    stages[i][2] = bpmem.tevind[i].hex;
+    stages[i][3] = order | (ksel << 10);
+  }
+
+  u32 swap_tables = 0;
+  for (u32 i = 0; i < 4; i++)
+  {
+    swap_tables |= ((bpmem.tevksel[i * 2].hex & 0xF) | ((bpmem.tevksel[i * 2 + 1].hex & 0xF) << 4))
+                   << (8 * i);
+  }
+  uint4 state = {bpmem.genMode.hex, bpmem.tevindref.hex, swap_tables, bpmem.alpha_test.hex};
+
+  // Same conditions as in GetPixelShaderUid.
+  const AlphaTest::TEST_RESULT pretest = bpmem.alpha_test.TestResult();
+  const bool rgba6_format =
+      bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24 && !g_ActiveConfig.bForceTrueColor;
+  u32 flags = 0;
+  if (pretest == AlphaTest::UNDETERMINED ||
+      (pretest == AlphaTest::FAIL && bpmem.UseLateDepthTest()))
+  {
+    flags |= UBER_FLAG_ALPHA_TEST;
+    if (bpmem.UseEarlyDepthTest() && bpmem.zmode.updateenable &&
+        !g_ActiveConfig.backend_info.bSupportsEarlyZ && !bpmem.genMode.zfreeze)
+    {
+      flags |= UBER_FLAG_ZCOMPLOC_HACK;
+    }
+  }
+  if (bpmem.genMode.zfreeze)
+    flags |= UBER_FLAG_ZFREEZE;
+  if (bpmem.UseEarlyDepthTest())
+    flags |= UBER_FLAG_EARLY_ZTEST;
+  if (bpmem.UseLateDepthTest())
+    flags |= UBER_FLAG_LATE_ZTEST;
+  if (rgba6_format)
+    flags |= UBER_FLAG_RGBA6;
+  if (rgba6_format && bpmem.blendmode.dither)
+    flags |= UBER_FLAG_DITHER;
+  if (bpmem.dstalpha.enable && bpmem.blendmode.alphaupdate &&
+      bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24)
+  {
+    flags |= UBER_FLAG_DSTALPHA;
+  }
+
+  const u32 fog = bpmem.fog.c_proj_fsel.fsel | (bpmem.fog.c_proj_fsel.proj << 3) |
+                  (bpmem.fogRange.Base.Enabled << 4);
+  uint4 uber_flags = {fog, bpmem.ztex2.op, flags, 0};
+
+  if (memcmp(stages, constants.uberstages, sizeof(stages)) != 0 ||
+      memcmp(state, constants.uberstate, sizeof(state)) != 0 ||
+      memcmp(uber_flags, constants.uberflags, sizeof(uber_flags)) != 0)
+  {
+    memcpy(constants.uberstages, stages, sizeof(stages));
+    memcpy(constants.uberstate, state, sizeof(state));
+    memcpy(constants.uberflags, uber_flags, sizeof(uber_flags));
+    dirty = true;
+  }
 }
 
 void PixelShaderManager::SetTevColor(int index, int component, s32 value)
@@ -45,4 +45,7 @@ public:
 
   static bool s_bFogRangeAdjustChanged;
   static bool s_bViewPortChanged;
+
+private:
+  static void SetUberShaderConstants();
 };
@@ -265,6 +265,9 @@ inline const char* GetInterpolationQualifier(bool msaa, bool ssaa,
 #define I_FOGF "cfogf"
 #define I_ZSLOPE "czslope"
 #define I_EFBSCALE "cefbscale"
+#define I_UBER_STAGES "cuberstage"
+#define I_UBER_STATE "cuberstate"
+#define I_UBER_FLAGS "cuberflags"
 
 #define I_POSNORMALMATRIX "cpnmtx"
 #define I_PROJECTION "cproj"
@@ -276,6 +279,9 @@ inline const char* GetInterpolationQualifier(bool msaa, bool ssaa,
 #define I_POSTTRANSFORMMATRICES "cpostmtx"
 #define I_PIXELCENTERCORRECTION "cpixelcenter"
 #define I_VIEWPORT_SIZE "cviewport"
+#define I_UBER_XFSTATE "cuberxf"
+#define I_UBER_LITCHANNELS "cuberlit"
+#define I_UBER_TEXGENS "cubertexgen"
 
 #define I_STEREOPARAMS "cstereo"
 #define I_LINEPTPARAMS "clinept"
@@ -291,3 +297,8 @@ static const char s_shader_uniforms[] = "\tfloat4 " I_POSNORMALMATRIX "[6];\n"
                                         "\tfloat4 " I_POSTTRANSFORMMATRICES "[64];\n"
                                         "\tfloat4 " I_PIXELCENTERCORRECTION ";\n"
                                         "\tfloat2 " I_VIEWPORT_SIZE ";\n";
+
+// Appended to s_shader_uniforms by the ubershaders.
+static const char s_uber_shader_uniforms[] = "\tuint4 " I_UBER_XFSTATE ";\n"
+                                             "\tuint4 " I_UBER_LITCHANNELS ";\n"
+                                             "\tuint4 " I_UBER_TEXGENS "[8];\n";
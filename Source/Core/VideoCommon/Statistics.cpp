@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "Common/StringUtil.h"
+#include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
@@ -48,6 +49,7 @@ std::string Statistics::ToString()
   str += StringFromFormat("Textures created: %i\n", stats.numTexturesCreated);
   str += StringFromFormat("Textures uploaded: %i\n", stats.numTexturesUploaded);
   str += StringFromFormat("Textures alive: %i\n", stats.numTexturesAlive);
+  str += StringFromFormat("Texture hashes skipped: %i\n", stats.thisFrame.numTextureHashesSkipped);
   str += StringFromFormat("pshaders created: %i\n", stats.numPixelShadersCreated);
   str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
   str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
@@ -69,6 +71,19 @@ std::string Statistics::ToString()
   str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
   str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
 
+  if (g_ActiveConfig.bHiresTextures)
+  {
+    const HiresTexture::Stats hires = HiresTexture::GetStats();
+    str += StringFromFormat("Custom textures cached: %u (%.1f / %.1f MB)\n", hires.textures_cached,
+                            hires.bytes_cached / (1024.0 * 1024.0),
+                            hires.budget / (1024.0 * 1024.0));
+    str += StringFromFormat("Custom textures prefetched: %u, evicted: %u\n", hires.prefetched,
+                            hires.evictions);
+    str += StringFromFormat("Custom texture hits: %u, misses: %u\n", hires.hits, hires.misses);
+    str += StringFromFormat("Custom texture load time: %.2f ms avg\n",
+                            hires.loads ? hires.load_time / 1000.0 / hires.loads : 0.0);
+  }
+
   std::string vertex_list = VertexLoaderManager::VertexLoadersToString();
 
   // TODO : at some point text1 just becomes too huge and overflows, we can't even read the added
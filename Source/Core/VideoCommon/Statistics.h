@@ -4,10 +4,27 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 
+#include "Common/CommonTypes.h"
+
 struct Statistics
 {
+  // Command classes counted by OpcodeDecoder::Run.
+  enum OpcodeClass
+  {
+    OPCODE_NOP,
+    OPCODE_LOAD_CP_REG,
+    OPCODE_LOAD_XF_REG,
+    OPCODE_LOAD_INDX,
+    OPCODE_CALL_DL,
+    OPCODE_LOAD_BP_REG,
+    OPCODE_DRAW_PRIMITIVES,
+    OPCODE_OTHER,
+    NUM_OPCODE_CLASSES
+  };
+
   int numPixelShadersCreated;
   int numPixelShadersAlive;
   int numVertexShadersCreated;
@@ -61,8 +78,24 @@ struct Statistics
     int numVerticesLoaded;
     int tevPixelsIn;
     int tevPixelsOut;
+
+    int numTextureHashesSkipped;
   };
   ThisFrame thisFrame, prevFrame;
+
+  // Running totals that are never cleared by ResetFrame(). Swaps do not necessarily line up with
+  // the frames of a FIFO log, so the FifoPlayer benchmark samples and diffs these instead.
+  struct Totals
+  {
+    u64 numOpcodes[NUM_OPCODE_CLASSES];
+    u64 numVerticesLoaded;
+    // Nanoseconds, only accumulated while collectTimings is set.
+    u64 vertexLoaderTime;
+    u64 textureDecodeTime;
+  };
+  Totals totals;
+  bool collectTimings;
+
   void ResetFrame();
   static void SwapDL();
 
@@ -72,6 +105,33 @@ struct Statistics
 
 extern Statistics stats;
 
+// Adds the lifetime of the object to a Totals time counter if timings are being collected.
+class ScopedStatTimer
+{
+public:
+  explicit ScopedStatTimer(u64& counter) : m_counter(counter), m_enabled(stats.collectTimings)
+  {
+    if (m_enabled)
+      m_start = std::chrono::steady_clock::now();
+  }
+  ~ScopedStatTimer()
+  {
+    if (m_enabled)
+    {
+      m_counter += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - m_start)
+                       .count();
+    }
+  }
+  ScopedStatTimer(const ScopedStatTimer&) = delete;
+  ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+private:
+  u64& m_counter;
+  bool m_enabled;
+  std::chrono::steady_clock::time_point m_start;
+};
+
 #define STATISTICS
 
 #ifdef STATISTICS
@@ -105,6 +105,7 @@ void TextureCacheBase::Invalidate()
   }
   textures_by_address.clear();
   textures_by_hash.clear();
+  tracked_hashes.clear();
 
   for (auto& rt : texture_pool)
   {
@@ -495,6 +496,31 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::ReturnEntry(unsigned int st
   return entry;
 }
 
+// Used by TextureCacheBase::Load
+u64 TextureCacheBase::GetTextureMemoryHash(u32 address, const u8* src_data, u32 size)
+{
+  if (!g_ActiveConfig.bTextureWriteTracking || !Memory::IsWriteTrackingAvailable())
+    return GetHash64(src_data, size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+
+  auto iter = tracked_hashes.find(address);
+  if (iter != tracked_hashes.end() && iter->second.size == size &&
+      !Memory::HasBeenWritten(address, size, iter->second.write_token))
+  {
+    INCSTAT(stats.thisFrame.numTextureHashesSkipped);
+    return iter->second.hash;
+  }
+
+  // Start tracking before hashing, so that a write in between causes another rehash later on
+  // rather than a stale hash.
+  const u64 write_token = Memory::TrackWrites(address, size);
+  const u64 hash = GetHash64(src_data, size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+  if (write_token != 0)
+    tracked_hashes[address] = {size, hash, write_token};
+  else if (iter != tracked_hashes.end())
+    tracked_hashes.erase(iter);
+  return hash;
+}
+
 void TextureCacheBase::BindTextures()
 {
   for (size_t i = 0; i < bound_textures.size(); ++i)
@@ -599,8 +625,10 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
         address);
     return nullptr;
   }
-  else
+  else if (from_tmem)
     base_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+  else
+    base_hash = GetTextureMemoryHash(address, src_data, texture_size);
 
   u32 palette_size = 0;
   if (isPaletteTexture)
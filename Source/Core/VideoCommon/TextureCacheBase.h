@@ -236,10 +236,22 @@ private:
 
   TCacheEntryBase* ReturnEntry(unsigned int stage, TCacheEntryBase* entry);
 
+  // Hashes texture data in RAM. With write tracking, the hash is only recomputed after the memory
+  // has been written.
+  u64 GetTextureMemoryHash(u32 address, const u8* src_data, u32 size);
+
   TexAddrCache textures_by_address;
   TexHashCache textures_by_hash;
   TexPool texture_pool;
 
+  struct TrackedHash
+  {
+    u32 size;
+    u64 hash;
+    u64 write_token;
+  };
+  std::unordered_map<u32, TrackedHash> tracked_hashes;
+
   // Backup configuration values
   struct BackupConfig
   {
@@ -105,3 +105,7 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
 /* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int texformat,
                             const u8* tlut, TlutFormat tlutfmt);
+/* The reference C implementation from TextureDecoder_Generic, built on all architectures so that
+ * the optimized decoders can be checked against it. */
+void _TexDecoder_DecodeImplGeneric(u32* dst, const u8* src, int width, int height, int texformat,
+                                   const u8* tlut, TlutFormat tlutfmt);
@@ -10,6 +10,7 @@
 #include "Common/Swap.h"
 
 #include "VideoCommon/LookUpTables.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/TextureDecoder_Util.h"
 #include "VideoCommon/sfont.inc"
@@ -366,6 +367,7 @@ static void TexDecoder_DrawOverlay(u8* dst, int width, int height, int texformat
 void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, int texformat, const u8* tlut,
                        TlutFormat tlutfmt)
 {
+  ScopedStatTimer timer(stats.totals.textureDecodeTime);
   _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
 
   if (TexFmt_Overlay_Enable)
@@ -716,6 +718,8 @@ void TexDecoder_DecodeTexelRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* sr
 void TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* src_gb, int width,
                                     int height)
 {
+  ScopedStatTimer timer(stats.totals.textureDecodeTime);
+
   // TODO for someone who cares: Make this less slow!
   for (int y = 0; y < height; ++y)
   {
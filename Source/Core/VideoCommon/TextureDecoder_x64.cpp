@@ -1403,6 +1403,277 @@ static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int h
   }
 }
 
+// Decodes a whole palette up front, so that the AVX2 decoders only need a table lookup per texel.
+static void DecodePalette(u32* palette, const u8* tlut_, TlutFormat tlutfmt, int count)
+{
+  const u16* tlut = (u16*)tlut_;
+  for (int i = 0; i < count; i++)
+  {
+    switch (tlutfmt)
+    {
+    case GX_TL_IA8:
+      palette[i] = DecodePixel_IA8(tlut[i]);
+      break;
+    case GX_TL_RGB565:
+      palette[i] = DecodePixel_RGB565(Common::swap16(tlut[i]));
+      break;
+    case GX_TL_RGB5A3:
+      palette[i] = DecodePixel_RGB5A3(Common::swap16(tlut[i]));
+      break;
+    default:
+      palette[i] = 0;
+      break;
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          int texformat, const u8* tlut, TlutFormat tlutfmt,
+                                          int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[16];
+  DecodePalette(palette, tlut, tlutfmt, 16);
+  const __m256i palette_lo = _mm256_load_si256((const __m256i*)palette);
+  const __m256i palette_hi = _mm256_load_si256((const __m256i*)(palette + 8));
+  const __m128i mask_x0f = _mm_set1_epi8(0x0f);
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        u32 row;
+        std::memcpy(&row, src + 4 * xStep, sizeof(row));
+
+        // Split each byte into its two indices, the high nibble coming first.
+        const __m128i packed = _mm_cvtsi32_si128(row);
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask_x0f);
+        const __m128i lo = _mm_and_si128(packed, mask_x0f);
+        const __m256i index = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(hi, lo));
+
+        // The permutes only look at the low 3 bits, bit 3 selects between the two halves.
+        const __m256i color = _mm256_castps_si256(
+            _mm256_blendv_ps(_mm256_castsi256_ps(_mm256_permutevar8x32_epi32(palette_lo, index)),
+                             _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(palette_hi, index)),
+                             _mm256_castsi256_ps(_mm256_slli_epi32(index, 28))));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), color);
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          int texformat, const u8* tlut, TlutFormat tlutfmt,
+                                          int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[256];
+  DecodePalette(palette, tlut, tlutfmt, 256);
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i index =
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+        const __m256i color = _mm256_i32gather_epi32((const int*)palette, index, 4);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), color);
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_IA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                           int texformat, const u8* tlut, TlutFormat tlutfmt,
+                                           int Wsteps4, int Wsteps8)
+{
+  // Each texel is stored as (A, I) and decodes to (I, I, I, A).
+  const __m256i mask_lo = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(6, 7, 7, 7, 4, 5, 5, 5, 2, 3, 3, 3, 0, 1, 1, 1));
+  const __m256i mask_hi = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(14, 15, 15, 15, 12, 13, 13, 13, 10, 11, 11, 11, 8, 9, 9, 9));
+
+  for (int y = 0; y < height; y += 4)
+  {
+    const u8* block = src + 32 * (y / 4) * Wsteps4;
+    int x = 0;
+
+    // Two blocks at a time, so that each row of 8 texels is a single store.
+    for (; x + 8 <= width; x += 8, block += 64)
+    {
+      const __m256i a = _mm256_loadu_si256((const __m256i*)block);
+      const __m256i b = _mm256_loadu_si256((const __m256i*)(block + 32));
+      const __m256i rows01 = _mm256_permute2x128_si256(a, b, 0x20);
+      const __m256i rows23 = _mm256_permute2x128_si256(a, b, 0x31);
+
+      _mm256_storeu_si256((__m256i*)(dst + (y + 0) * width + x),
+                          _mm256_shuffle_epi8(rows01, mask_lo));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 1) * width + x),
+                          _mm256_shuffle_epi8(rows01, mask_hi));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 2) * width + x),
+                          _mm256_shuffle_epi8(rows23, mask_lo));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 3) * width + x),
+                          _mm256_shuffle_epi8(rows23, mask_hi));
+    }
+
+    if (x < width)
+    {
+      const __m256i texels = _mm256_loadu_si256((const __m256i*)block);
+      const __m256i lo = _mm256_shuffle_epi8(texels, mask_lo);
+      const __m256i hi = _mm256_shuffle_epi8(texels, mask_hi);
+      _mm_storeu_si128((__m128i*)(dst + (y + 0) * width + x), _mm256_castsi256_si128(lo));
+      _mm_storeu_si128((__m128i*)(dst + (y + 1) * width + x), _mm256_castsi256_si128(hi));
+      _mm_storeu_si128((__m128i*)(dst + (y + 2) * width + x), _mm256_extracti128_si256(lo, 1));
+      _mm_storeu_si128((__m128i*)(dst + (y + 3) * width + x), _mm256_extracti128_si256(hi, 1));
+    }
+  }
+}
+
+// Decodes 8 byteswapped RGB5A3 texels, zero extended to 32 bits.
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB5A3x8_AVX2(__m256i val)
+{
+  const __m256i mask_x1f = _mm256_set1_epi32(0x1f);
+  const __m256i mask_x0f = _mm256_set1_epi32(0x0f);
+
+  // RGB555, with alpha = 0xFF
+  const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(val, 10), mask_x1f);
+  const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(val, 5), mask_x1f);
+  const __m256i b5 = _mm256_and_si256(val, mask_x1f);
+  const __m256i r8 = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+  const __m256i g8 = _mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2));
+  const __m256i b8 = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+  const __m256i rgb555 = _mm256_or_si256(
+      _mm256_or_si256(r8, _mm256_slli_epi32(g8, 8)),
+      _mm256_or_si256(_mm256_slli_epi32(b8, 16), _mm256_set1_epi32(0xFF000000)));
+
+  // RGBA4443
+  const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), _mm256_set1_epi32(0x07));
+  const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(val, 8), mask_x0f);
+  const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(val, 4), mask_x0f);
+  const __m256i b4 = _mm256_and_si256(val, mask_x0f);
+  const __m256i a8 = _mm256_or_si256(
+      _mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)), _mm256_srli_epi32(a3, 1));
+  const __m256i rgb4 = _mm256_or_si256(_mm256_or_si256(r4, _mm256_slli_epi32(g4, 8)),
+                                       _mm256_slli_epi32(b4, 16));
+  const __m256i rgba4443 = _mm256_or_si256(_mm256_or_si256(rgb4, _mm256_slli_epi32(rgb4, 4)),
+                                           _mm256_slli_epi32(a8, 24));
+
+  const __m256i is_rgb555 = _mm256_srai_epi32(_mm256_slli_epi32(val, 16), 31);
+  return _mm256_blendv_epi8(rgba4443, rgb555, is_rgb555);
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB5A3_AVX2(u32* dst, const u8* src, int width, int height,
+                                              int texformat, const u8* tlut, TlutFormat tlutfmt,
+                                              int Wsteps4, int Wsteps8)
+{
+  const __m256i swap16 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+
+  for (int y = 0; y < height; y += 4)
+  {
+    const u8* block = src + 32 * (y / 4) * Wsteps4;
+    int x = 0;
+
+    // Two blocks at a time, so that each row of 8 texels is a single store.
+    for (; x + 8 <= width; x += 8, block += 64)
+    {
+      const __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)block), swap16);
+      const __m256i b =
+          _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(block + 32)), swap16);
+      // Interleave the rows of both blocks: (a0 b0 a1 b1) and (a2 b2 a3 b3).
+      const __m256i rows01 = _mm256_permute4x64_epi64(_mm256_permute2x128_si256(a, b, 0x20),
+                                                      _MM_SHUFFLE(3, 1, 2, 0));
+      const __m256i rows23 = _mm256_permute4x64_epi64(_mm256_permute2x128_si256(a, b, 0x31),
+                                                      _MM_SHUFFLE(3, 1, 2, 0));
+
+      _mm256_storeu_si256(
+          (__m256i*)(dst + (y + 0) * width + x),
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(rows01))));
+      _mm256_storeu_si256(
+          (__m256i*)(dst + (y + 1) * width + x),
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(rows01, 1))));
+      _mm256_storeu_si256(
+          (__m256i*)(dst + (y + 2) * width + x),
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(rows23))));
+      _mm256_storeu_si256(
+          (__m256i*)(dst + (y + 3) * width + x),
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(rows23, 1))));
+    }
+
+    if (x < width)
+    {
+      const __m256i texels =
+          _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)block), swap16);
+      const __m256i rows01 =
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(texels)));
+      const __m256i rows23 =
+          DecodeRGB5A3x8_AVX2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(texels, 1)));
+      _mm_storeu_si128((__m128i*)(dst + (y + 0) * width + x), _mm256_castsi256_si128(rows01));
+      _mm_storeu_si128((__m128i*)(dst + (y + 1) * width + x), _mm256_extracti128_si256(rows01, 1));
+      _mm_storeu_si128((__m128i*)(dst + (y + 2) * width + x), _mm256_castsi256_si128(rows23));
+      _mm_storeu_si128((__m128i*)(dst + (y + 3) * width + x), _mm256_extracti128_si256(rows23, 1));
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGBA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                             int texformat, const u8* tlut, TlutFormat tlutfmt,
+                                             int Wsteps4, int Wsteps8)
+{
+  // Same shuffle as the SSSE3 decoder, after interleaving the AR and GB halves of a block.
+  const __m256i mask0312 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(12, 15, 13, 14, 8, 11, 9, 10, 4, 7, 5, 6, 0, 3, 1, 2));
+
+  for (int y = 0; y < height; y += 4)
+  {
+    const u8* block = src + 64 * (y / 4) * Wsteps4;
+    int x = 0;
+
+    // Two blocks at a time, so that each row of 8 texels is a single store.
+    for (; x + 8 <= width; x += 8, block += 128)
+    {
+      const __m256i ar_a = _mm256_loadu_si256((const __m256i*)block);
+      const __m256i gb_a = _mm256_loadu_si256((const __m256i*)(block + 32));
+      const __m256i ar_b = _mm256_loadu_si256((const __m256i*)(block + 64));
+      const __m256i gb_b = _mm256_loadu_si256((const __m256i*)(block + 96));
+
+      const __m256i ar01 = _mm256_permute2x128_si256(ar_a, ar_b, 0x20);
+      const __m256i gb01 = _mm256_permute2x128_si256(gb_a, gb_b, 0x20);
+      const __m256i ar23 = _mm256_permute2x128_si256(ar_a, ar_b, 0x31);
+      const __m256i gb23 = _mm256_permute2x128_si256(gb_a, gb_b, 0x31);
+
+      _mm256_storeu_si256((__m256i*)(dst + (y + 0) * width + x),
+                          _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar01, gb01), mask0312));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 1) * width + x),
+                          _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar01, gb01), mask0312));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 2) * width + x),
+                          _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar23, gb23), mask0312));
+      _mm256_storeu_si256((__m256i*)(dst + (y + 3) * width + x),
+                          _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar23, gb23), mask0312));
+    }
+
+    if (x < width)
+    {
+      const __m256i ar = _mm256_loadu_si256((const __m256i*)block);
+      const __m256i gb = _mm256_loadu_si256((const __m256i*)(block + 32));
+      const __m256i rows02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask0312);
+      const __m256i rows13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask0312);
+      _mm_storeu_si128((__m128i*)(dst + (y + 0) * width + x), _mm256_castsi256_si128(rows02));
+      _mm_storeu_si128((__m128i*)(dst + (y + 1) * width + x), _mm256_castsi256_si128(rows13));
+      _mm_storeu_si128((__m128i*)(dst + (y + 2) * width + x), _mm256_extracti128_si256(rows02, 1));
+      _mm_storeu_si128((__m128i*)(dst + (y + 3) * width + x), _mm256_extracti128_si256(rows13, 1));
+    }
+  }
+}
+
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int texformat,
                             const u8* tlut, TlutFormat tlutfmt)
 {
@@ -1412,7 +1683,11 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int
   switch (texformat)
   {
   case GX_TF_C4:
-    TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case GX_TF_I4:
@@ -1432,7 +1707,11 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int
     break;
 
   case GX_TF_C8:
-    TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case GX_TF_IA4:
@@ -1440,7 +1719,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int
     break;
 
   case GX_TF_IA8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_IA8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                     Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_IA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                       Wsteps8);
     else
@@ -1459,7 +1741,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int
     break;
 
   case GX_TF_RGB5A3:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGB5A3_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                        Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGB5A3_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                          Wsteps8);
     else
@@ -1468,7 +1753,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, int
     break;
 
   case GX_TF_RGBA8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGBA8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                       Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGBA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                         Wsteps8);
     else
@@ -0,0 +1,742 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/UberShaderPixel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/DriverDetails.h"
+#include "VideoCommon/LightingShaderGen.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+UberPixelShaderUid GetUberPixelShaderUid()
+{
+  UberPixelShaderUid out;
+  pixel_ubershader_uid_data* uid_data = out.GetUidData<pixel_ubershader_uid_data>();
+  memset(uid_data, 0, sizeof(*uid_data));
+
+  // Same as in GetPixelShaderUid, as these decide whether the shader writes the depth.
+  const bool forced_early_z =
+      g_ActiveConfig.backend_info.bSupportsEarlyZ && bpmem.UseEarlyDepthTest() &&
+      (g_ActiveConfig.bFastDepthCalc || bpmem.alpha_test.TestResult() == AlphaTest::UNDETERMINED) &&
+      !(bpmem.zmode.testenable && bpmem.genMode.zfreeze);
+  const bool per_pixel_depth =
+      (bpmem.ztex2.op != ZTEXTURE_DISABLE && bpmem.UseLateDepthTest()) ||
+      (!g_ActiveConfig.bFastDepthCalc && bpmem.zmode.testenable && !forced_early_z) ||
+      (bpmem.zmode.testenable && bpmem.genMode.zfreeze);
+  const bool use_dst_alpha = bpmem.dstalpha.enable && bpmem.blendmode.alphaupdate &&
+                             bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24;
+
+  uid_data->num_texgens = bpmem.genMode.numtexgens;
+  uid_data->early_depth = forced_early_z;
+  uid_data->per_pixel_depth = per_pixel_depth;
+  uid_data->per_pixel_lighting = g_ActiveConfig.bEnablePixelLighting;
+  if (uid_data->per_pixel_lighting)
+  {
+    uid_data->components =
+        (VertexLoaderManager::g_current_components & (VB_HAS_COL0 | VB_HAS_COL1)) >> VB_COL_SHIFT;
+  }
+  uid_data->bounding_box = g_ActiveConfig.BBoxUseFragmentShaderImplementation() &&
+                           g_ActiveConfig.bBBoxEnable && BoundingBox::active;
+  uid_data->fast_depth_calc = g_ActiveConfig.bFastDepthCalc;
+  uid_data->msaa = g_ActiveConfig.iMultisamples > 1;
+  uid_data->ssaa = g_ActiveConfig.iMultisamples > 1 && g_ActiveConfig.bSSAA;
+  uid_data->stereo = g_ActiveConfig.iStereoMode > 0;
+  uid_data->uses_dual_source =
+      g_ActiveConfig.backend_info.bSupportsDualSourceBlend &&
+      (!DriverDetails::HasBug(DriverDetails::BUG_BROKEN_DUAL_SOURCE_BLENDING) || use_dst_alpha);
+
+  return out;
+}
+
+static void WriteSampleFunction(ShaderCode& out, APIType api_type)
+{
+  // Samplers can't be indexed dynamically before GLSL 4.00.
+  out.Write("int4 sampleTexture(uint texmap, float2 uv, float layer)\n"
+            "{\n"
+            "\tswitch (texmap)\n"
+            "\t{\n");
+  for (int i = 0; i < 8; i++)
+  {
+    if (api_type == APIType::Vulkan)
+    {
+      out.Write("\tcase %du:\n"
+                "\t\treturn iround(255.0 * texture(samp%d, float3(uv * " I_TEXDIMS
+                "[%d].xy, layer)));\n",
+                i, i, i);
+    }
+    else
+    {
+      out.Write("\tcase %du:\n"
+                "\t\treturn iround(255.0 * texture(samp[%d], float3(uv * " I_TEXDIMS
+                "[%d].xy, layer)));\n",
+                i, i, i);
+    }
+  }
+  out.Write("\t}\n"
+            "\treturn int4(0, 0, 0, 0);\n"
+            "}\n\n");
+}
+
+static void WriteHelperFunctions(ShaderCode& out)
+{
+  // The swap tables are packed into I_UBER_STATE.z, 8 bits each.
+  out.Write("int4 swizzle(uint table, int4 color)\n"
+            "{\n"
+            "\tuint swap = (" I_UBER_STATE ".z >> (8u * table)) & 255u;\n"
+            "\treturn int4(color[swap & 3u], color[(swap >> 2) & 3u], color[(swap >> 4) & 3u],\n"
+            "\t            color[(swap >> 6) & 3u]);\n"
+            "}\n\n");
+
+  // 255, 223, 191, 159, 128, 96, 64, 32 for the fixed fractions.
+  out.Write("int konstFraction(uint sel)\n"
+            "{\n"
+            "\treturn (sel < 4u) ? 255 - 32 * int(sel) : 32 * (8 - int(sel));\n"
+            "}\n\n");
+
+  out.Write("int3 selectKonstColor(uint sel)\n"
+            "{\n"
+            "\tif (sel < 8u)\n"
+            "\t\treturn int3(1, 1, 1) * konstFraction(sel);\n"
+            "\telse if (sel < 12u)\n"
+            "\t\treturn int3(0, 0, 0);\n"
+            "\telse if (sel < 16u)\n"
+            "\t\treturn " I_KCOLORS "[sel - 12u].rgb;\n"
+            "\telse\n"
+            "\t\treturn int3(1, 1, 1) * " I_KCOLORS "[sel & 3u][(sel - 16u) >> 2];\n"
+            "}\n\n");
+
+  out.Write("int selectKonstAlpha(uint sel)\n"
+            "{\n"
+            "\tif (sel < 8u)\n"
+            "\t\treturn konstFraction(sel);\n"
+            "\telse if (sel < 16u)\n"
+            "\t\treturn 0;\n"
+            "\telse\n"
+            "\t\treturn " I_KCOLORS "[sel & 3u][(sel - 16u) >> 2];\n"
+            "}\n\n");
+
+  out.Write("int3 selectColorInput(uint sel, int4 regs[4], int4 tex, int4 ras, int4 konst)\n"
+            "{\n"
+            "\tif (sel < 12u)\n"
+            "\t{\n"
+            "\t\tint4 value = (sel < 8u) ? regs[sel >> 1] : ((sel < 10u) ? tex : ras);\n"
+            "\t\treturn ((sel & 1u) == 0u) ? value.rgb : value.aaa;\n"
+            "\t}\n"
+            "\telse if (sel == 12u)\n"
+            "\t\treturn int3(255, 255, 255);\n"
+            "\telse if (sel == 13u)\n"
+            "\t\treturn int3(128, 128, 128);\n"
+            "\telse if (sel == 14u)\n"
+            "\t\treturn konst.rgb;\n"
+            "\telse\n"
+            "\t\treturn int3(0, 0, 0);\n"
+            "}\n\n");
+
+  out.Write("int selectAlphaInput(uint sel, int4 regs[4], int4 tex, int4 ras, int4 konst)\n"
+            "{\n"
+            "\tif (sel < 4u)\n"
+            "\t\treturn regs[sel].a;\n"
+            "\telse if (sel == 4u)\n"
+            "\t\treturn tex.a;\n"
+            "\telse if (sel == 5u)\n"
+            "\t\treturn ras.a;\n"
+            "\telse if (sel == 6u)\n"
+            "\t\treturn konst.a;\n"
+            "\telse\n"
+            "\t\treturn 0;\n"
+            "}\n\n");
+
+  // See WriteTevRegular in PixelShaderGen.cpp for the lerp and rounding details.
+  for (const char* type : {"int3", "int"})
+  {
+    const bool alpha = strcmp(type, "int") == 0;
+    out.Write("%s tevRegular(%s a, %s b, %s c, %s d, uint bias, uint op, uint shift)\n"
+              "{\n"
+              "\tint left = (shift == 1u) ? 1 : ((shift == 2u) ? 2 : 0);\n"
+              "\tint right = (shift == 3u) ? 1 : 0;\n"
+              "\tint bias_value = (bias == 1u) ? 128 : ((bias == 2u) ? -128 : 0);\n"
+              "\tint lerp_bias = ((shift == 3u) == %s) ? ((op == 0u) ? 128 : 127) : 0;\n"
+              "\t%s lerp = ((((a << 8) + (b - a) * (c + (c >> 7))) << left) + lerp_bias) >> 8;\n"
+              "\t%s dscaled = (d + bias_value) << left;\n"
+              "\treturn ((op == 0u) ? (dscaled + lerp) : (dscaled - lerp)) >> right;\n"
+              "}\n\n",
+              type, type, type, type, type, alpha ? "true" : "false", type, type);
+  }
+
+  out.Write("int3 tevCompareColor(int4 a, int4 b, int3 c, uint mode)\n"
+            "{\n"
+            "\tint3 comp16 = int3(1, 256, 0), comp24 = int3(1, 256, 256*256);\n"
+            "\tswitch (mode)\n"
+            "\t{\n"
+            "\tcase 0u: return (a.r > b.r) ? c : int3(0,0,0);\n"
+            "\tcase 1u: return (a.r == b.r) ? c : int3(0,0,0);\n"
+            "\tcase 2u: return (idot(a.rgb, comp16) > idot(b.rgb, comp16)) ? c : int3(0,0,0);\n"
+            "\tcase 3u: return (idot(a.rgb, comp16) == idot(b.rgb, comp16)) ? c : int3(0,0,0);\n"
+            "\tcase 4u: return (idot(a.rgb, comp24) > idot(b.rgb, comp24)) ? c : int3(0,0,0);\n"
+            "\tcase 5u: return (idot(a.rgb, comp24) == idot(b.rgb, comp24)) ? c : int3(0,0,0);\n"
+            "\tcase 6u: return max(sign(a.rgb - b.rgb), int3(0,0,0)) * c;\n"
+            "\tdefault: return (int3(1,1,1) - sign(abs(a.rgb - b.rgb))) * c;\n"
+            "\t}\n"
+            "}\n\n");
+
+  out.Write("int tevCompareAlpha(int4 a, int4 b, int c, uint mode)\n"
+            "{\n"
+            "\tint3 comp16 = int3(1, 256, 0), comp24 = int3(1, 256, 256*256);\n"
+            "\tswitch (mode)\n"
+            "\t{\n"
+            "\tcase 0u: return (a.r > b.r) ? c : 0;\n"
+            "\tcase 1u: return (a.r == b.r) ? c : 0;\n"
+            "\tcase 2u: return (idot(a.rgb, comp16) > idot(b.rgb, comp16)) ? c : 0;\n"
+            "\tcase 3u: return (idot(a.rgb, comp16) == idot(b.rgb, comp16)) ? c : 0;\n"
+            "\tcase 4u: return (idot(a.rgb, comp24) > idot(b.rgb, comp24)) ? c : 0;\n"
+            "\tcase 5u: return (idot(a.rgb, comp24) == idot(b.rgb, comp24)) ? c : 0;\n"
+            "\tcase 6u: return (a.a > b.a) ? c : 0;\n"
+            "\tdefault: return (a.a == b.a) ? c : 0;\n"
+            "\t}\n"
+            "}\n\n");
+
+  out.Write("bool alphaCompare(int a, int ref, uint comp)\n"
+            "{\n"
+            "\tswitch (comp)\n"
+            "\t{\n"
+            "\tcase 0u: return false;\n"
+            "\tcase 1u: return a < ref;\n"
+            "\tcase 2u: return a == ref;\n"
+            "\tcase 3u: return a <= ref;\n"
+            "\tcase 4u: return a > ref;\n"
+            "\tcase 5u: return a != ref;\n"
+            "\tcase 6u: return a >= ref;\n"
+            "\tdefault: return true;\n"
+            "\t}\n"
+            "}\n\n");
+}
+
+ShaderCode GenerateUberPixelShaderCode(APIType api_type, const pixel_ubershader_uid_data* uid_data)
+{
+  ShaderCode out;
+  const u32 num_texgens = uid_data->num_texgens;
+  const bool per_pixel_depth = uid_data->per_pixel_depth;
+  const bool use_dual_source = uid_data->uses_dual_source;
+
+  out.Write("// Pixel UberShader for %u texgens%s%s\n", num_texgens,
+            uid_data->early_depth ? ", early-depth" : "",
+            per_pixel_depth ? ", per-pixel depth" : "");
+
+  out.Write("int idot(int3 x, int3 y)\n"
+            "{\n"
+            "\tint3 tmp = x * y;\n"
+            "\treturn tmp.x + tmp.y + tmp.z;\n"
+            "}\n");
+
+  out.Write("int idot(int4 x, int4 y)\n"
+            "{\n"
+            "\tint4 tmp = x * y;\n"
+            "\treturn tmp.x + tmp.y + tmp.z + tmp.w;\n"
+            "}\n\n");
+
+  out.Write("int  iround(float  x) { return int (round(x)); }\n"
+            "int2 iround(float2 x) { return int2(round(x)); }\n"
+            "int3 iround(float3 x) { return int3(round(x)); }\n"
+            "int4 iround(float4 x) { return int4(round(x)); }\n\n");
+
+  if (api_type == APIType::Vulkan)
+  {
+    for (int i = 0; i < 8; i++)
+      out.Write("SAMPLER_BINDING(%d) uniform sampler2DArray samp%d;\n", i, i);
+  }
+  else
+  {
+    out.Write("SAMPLER_BINDING(0) uniform sampler2DArray samp[8];\n");
+  }
+  out.Write("\n");
+
+  out.Write("UBO_BINDING(std140, 1) uniform PSBlock {\n"
+            "\tint4 " I_COLORS "[4];\n"
+            "\tint4 " I_KCOLORS "[4];\n"
+            "\tint4 " I_ALPHA ";\n"
+            "\tfloat4 " I_TEXDIMS "[8];\n"
+            "\tint4 " I_ZBIAS "[2];\n"
+            "\tint4 " I_INDTEXSCALE "[2];\n"
+            "\tint4 " I_INDTEXMTX "[6];\n"
+            "\tint4 " I_FOGCOLOR ";\n"
+            "\tint4 " I_FOGI ";\n"
+            "\tfloat4 " I_FOGF "[2];\n"
+            "\tfloat4 " I_ZSLOPE ";\n"
+            "\tfloat4 " I_EFBSCALE ";\n"
+            "\tuint4 " I_UBER_STAGES "[16];\n"
+            "\tuint4 " I_UBER_STATE ";\n"
+            "\tuint4 " I_UBER_FLAGS ";\n"
+            "};\n");
+
+  if (uid_data->per_pixel_lighting)
+  {
+    // Has to match the vertex ubershader's block.
+    out.Write("%s", s_lighting_struct);
+    out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+    out.Write(s_shader_uniforms);
+    out.Write(s_uber_shader_uniforms);
+    out.Write("};\n");
+  }
+
+  if (uid_data->bounding_box)
+  {
+    out.Write("SSBO_BINDING(0) buffer BBox {\n"
+              "\tint4 bbox_data;\n"
+              "};\n");
+  }
+
+  out.Write("struct VS_OUTPUT {\n");
+  GenerateVSOutputMembers(out, api_type, num_texgens, uid_data->per_pixel_lighting, "");
+  out.Write("};\n");
+
+  if (uid_data->early_depth)
+    out.Write("FORCE_EARLY_Z; \n");
+
+  if (use_dual_source)
+  {
+    if (DriverDetails::HasBug(DriverDetails::BUG_BROKEN_FRAGMENT_SHADER_INDEX_DECORATION))
+    {
+      out.Write("FRAGMENT_OUTPUT_LOCATION(0) out vec4 ocol0;\n");
+      out.Write("FRAGMENT_OUTPUT_LOCATION(1) out vec4 ocol1;\n");
+    }
+    else
+    {
+      out.Write("FRAGMENT_OUTPUT_LOCATION_INDEXED(0, 0) out vec4 ocol0;\n");
+      out.Write("FRAGMENT_OUTPUT_LOCATION_INDEXED(0, 1) out vec4 ocol1;\n");
+    }
+  }
+  else
+  {
+    out.Write("FRAGMENT_OUTPUT_LOCATION(0) out vec4 ocol0;\n");
+  }
+
+  if (per_pixel_depth)
+    out.Write("#define depth gl_FragDepth\n");
+
+  const char* qualifier = GetInterpolationQualifier(uid_data->msaa, uid_data->ssaa);
+  const bool use_block =
+      g_ActiveConfig.backend_info.bSupportsGeometryShaders || api_type == APIType::Vulkan;
+  if (use_block)
+  {
+    out.Write("VARYING_LOCATION(0) in VertexData {\n");
+    GenerateVSOutputMembers(out, api_type, num_texgens, uid_data->per_pixel_lighting,
+                            GetInterpolationQualifier(uid_data->msaa, uid_data->ssaa, true, true));
+    if (uid_data->stereo)
+      out.Write("\tflat int layer;\n");
+    out.Write("};\n");
+  }
+  else
+  {
+    out.Write("%s in float4 colors_0;\n", qualifier);
+    out.Write("%s in float4 colors_1;\n", qualifier);
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("%s in float3 uv%u;\n", qualifier, i);
+    out.Write("%s in float4 clipPos;\n", qualifier);
+    if (uid_data->per_pixel_lighting)
+    {
+      out.Write("%s in float3 Normal;\n", qualifier);
+      out.Write("%s in float3 WorldPos;\n", qualifier);
+    }
+  }
+  out.Write("\n");
+
+  WriteSampleFunction(out, api_type);
+  WriteHelperFunctions(out);
+  if (uid_data->per_pixel_lighting)
+    WriteUberLightingFunction(out);
+
+  out.Write("void main()\n{\n");
+  if (use_block)
+  {
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("\tfloat3 uv%u = tex%u;\n", i, i);
+  }
+  out.Write("\tfloat4 rawpos = gl_FragCoord;\n");
+  out.Write("\tfloat layer_index = %s;\n", uid_data->stereo ? "float(layer)" : "0.0");
+
+  // The number of texgens is part of the uid, everything else is read from the uniforms.
+  out.Write("\tuint num_stages = ((" I_UBER_STATE ".x >> 10) & 15u) + 1u;\n"
+            "\tuint num_indstages = (" I_UBER_STATE ".x >> 16) & 7u;\n"
+            "\tuint flags = " I_UBER_FLAGS ".z;\n\n");
+
+  out.Write("\tint4 regs[4];\n"
+            "\tregs[0] = " I_COLORS "[0];\n"
+            "\tregs[1] = " I_COLORS "[1];\n"
+            "\tregs[2] = " I_COLORS "[2];\n"
+            "\tregs[3] = " I_COLORS "[3];\n"
+            "\tint4 rastemp = int4(0, 0, 0, 0), textemp = int4(0, 0, 0, 0), "
+            "konsttemp = int4(0, 0, 0, 0);\n"
+            "\tint alphabump = 0;\n"
+            "\tint3 tevcoord = int3(0, 0, 0);\n"
+            "\tint2 wrappedcoord = int2(0, 0), tempcoord = int2(0, 0);\n\n");
+
+  out.Write("\tfloat4 col0 = colors_0;\n");
+  out.Write("\tfloat4 col1 = colors_1;\n");
+
+  if (uid_data->per_pixel_lighting)
+  {
+    out.Write("\tfloat3 _norm0 = normalize(Normal.xyz);\n\n");
+    out.Write("\tfloat3 pos = WorldPos;\n");
+    GenerateUberLightingShaderCode(out, uid_data->components << VB_COL_SHIFT, "colors_", "col");
+  }
+
+  // HACK to handle cases where the tex gen is not enabled, as in the specialized shaders
+  out.Write("\tint2 fixpoint_uv[%u];\n", std::max(num_texgens, 1u));
+  if (num_texgens == 0)
+    out.Write("\tfixpoint_uv[0] = int2(0, 0);\n");
+  for (u32 i = 0; i < num_texgens; ++i)
+  {
+    out.Write("\tfixpoint_uv[%u] = int2((uv%u.z == 0.0 ? uv%u.xy : uv%u.xy / uv%u.z) * " I_TEXDIMS
+              "[%u].zw);\n",
+              i, i, i, i, i, i);
+  }
+  out.Write("\n");
+
+  // Sample all enabled indirect stages, used by a TEV stage or not
+  out.Write("\tint3 indtex[4];\n");
+  for (u32 i = 0; i < 4; ++i)
+  {
+    out.Write("\tif (num_indstages > %uu)\n"
+              "\t{\n"
+              "\t\tuint texcoord = (" I_UBER_STATE ".y >> %uu) & 7u;\n"
+              "\t\tuint texmap = (" I_UBER_STATE ".y >> %uu) & 7u;\n"
+              "\t\tif (texcoord < %uu)\n"
+              "\t\t\ttempcoord = fixpoint_uv[texcoord] >> " I_INDTEXSCALE "[%u].%s;\n"
+              "\t\telse\n"
+              "\t\t\ttempcoord = int2(0, 0);\n"
+              "\t\tindtex[%u] = sampleTexture(texmap, float2(tempcoord), layer_index).abg;\n"
+              "\t}\n"
+              "\telse\n"
+              "\t{\n"
+              "\t\tindtex[%u] = int3(0, 0, 0);\n"
+              "\t}\n",
+              i, 6 * i + 3, 6 * i, num_texgens, i / 2, (i & 1) ? "zw" : "xy", i, i);
+  }
+  out.Write("\n");
+
+  out.Write("\tfor (uint stage = 0u; stage < num_stages; stage++)\n"
+            "\t{\n"
+            "\t\tuint cc = " I_UBER_STAGES "[stage].x;\n"
+            "\t\tuint ac = " I_UBER_STAGES "[stage].y;\n"
+            "\t\tuint tevind = " I_UBER_STAGES "[stage].z;\n"
+            "\t\tuint order = " I_UBER_STAGES "[stage].w;\n"
+            "\t\tuint texmap = order & 7u;\n"
+            "\t\tuint texcoord = (order >> 3) & 7u;\n"
+            "\t\tbool has_texcoord = texcoord < %uu;\n"
+            "\t\tif (!has_texcoord)\n"
+            "\t\t\ttexcoord = 0u;\n\n",
+            num_texgens);
+
+  // Indirect stage, see WriteStage in PixelShaderGen.cpp
+  out.Write("\t\tuint bt = tevind & 3u;\n"
+            "\t\tbool has_indstage = bt < num_indstages;\n"
+            "\t\tif (has_indstage)\n"
+            "\t\t{\n"
+            "\t\t\tuint fmt = (tevind >> 2) & 3u;\n"
+            "\t\t\tuint bias = (tevind >> 4) & 7u;\n"
+            "\t\t\tuint bs = (tevind >> 7) & 3u;\n"
+            "\t\t\tuint mid = (tevind >> 9) & 15u;\n"
+            "\t\t\tuint sw = (tevind >> 13) & 7u;\n"
+            "\t\t\tuint tw = (tevind >> 16) & 7u;\n"
+            "\t\t\tint3 indcoord = indtex[bt];\n"
+            "\t\t\tif (bs != 0u)\n"
+            "\t\t\t\talphabump = indcoord[bs - 1u] & ((fmt == 1u) ? 224 : ((fmt == 2u) ? 240 : "
+            "248));\n"
+            "\t\t\tint2 indtevtrans = int2(0, 0);\n"
+            "\t\t\tif (mid != 0u)\n"
+            "\t\t\t{\n"
+            "\t\t\t\tint3 indtevcrd = indcoord & ((fmt == 0u) ? 255 : (31 >> int(fmt - 1u)));\n"
+            "\t\t\t\tint bias_add = (fmt == 0u) ? -128 : 1;\n"
+            "\t\t\t\tif ((bias & 1u) != 0u)\n"
+            "\t\t\t\t\tindtevcrd.x += bias_add;\n"
+            "\t\t\t\tif ((bias & 2u) != 0u)\n"
+            "\t\t\t\t\tindtevcrd.y += bias_add;\n"
+            "\t\t\t\tif ((bias & 4u) != 0u)\n"
+            "\t\t\t\t\tindtevcrd.z += bias_add;\n\n"
+            "\t\t\t\tint mtxidx = -1;\n"
+            "\t\t\t\tif (mid <= 3u)\n"
+            "\t\t\t\t{\n"
+            "\t\t\t\t\tmtxidx = 2 * int(mid - 1u);\n"
+            "\t\t\t\t\tindtevtrans = int2(idot(" I_INDTEXMTX "[mtxidx].xyz, indtevcrd), idot(" I_INDTEXMTX
+            "[mtxidx + 1].xyz, indtevcrd)) >> 3;\n"
+            "\t\t\t\t}\n"
+            "\t\t\t\telse if (mid >= 5u && mid <= 7u && has_texcoord)\n"
+            "\t\t\t\t{\n"
+            "\t\t\t\t\tmtxidx = 2 * int(mid - 5u);\n"
+            "\t\t\t\t\tindtevtrans = int2(fixpoint_uv[texcoord] * indtevcrd.xx) >> 8;\n"
+            "\t\t\t\t}\n"
+            "\t\t\t\telse if (mid >= 9u && mid <= 11u && has_texcoord)\n"
+            "\t\t\t\t{\n"
+            "\t\t\t\t\tmtxidx = 2 * int(mid - 9u);\n"
+            "\t\t\t\t\tindtevtrans = int2(fixpoint_uv[texcoord] * indtevcrd.yy) >> 8;\n"
+            "\t\t\t\t}\n\n"
+            "\t\t\t\tif (mtxidx >= 0)\n"
+            "\t\t\t\t{\n"
+            "\t\t\t\t\tint scale = " I_INDTEXMTX "[mtxidx].w;\n"
+            "\t\t\t\t\tif (scale >= 0)\n"
+            "\t\t\t\t\t\tindtevtrans >>= scale;\n"
+            "\t\t\t\t\telse\n"
+            "\t\t\t\t\t\tindtevtrans <<= (0 - scale);\n"
+            "\t\t\t\t}\n"
+            "\t\t\t}\n\n"
+            "\t\t\t// The wrap sizes are 256 << 7 down to 16 << 7, then 0.\n"
+            "\t\t\tint2 uv = fixpoint_uv[texcoord];\n"
+            "\t\t\tif (sw == 0u)\n"
+            "\t\t\t\twrappedcoord.x = uv.x;\n"
+            "\t\t\telse if (sw >= 6u)\n"
+            "\t\t\t\twrappedcoord.x = 0;\n"
+            "\t\t\telse\n"
+            "\t\t\t\twrappedcoord.x = uv.x & ((32768 >> int(sw - 1u)) - 1);\n"
+            "\t\t\tif (tw == 0u)\n"
+            "\t\t\t\twrappedcoord.y = uv.y;\n"
+            "\t\t\telse if (tw >= 6u)\n"
+            "\t\t\t\twrappedcoord.y = 0;\n"
+            "\t\t\telse\n"
+            "\t\t\t\twrappedcoord.y = uv.y & ((32768 >> int(tw - 1u)) - 1);\n\n"
+            "\t\t\tif (((tevind >> 20) & 1u) != 0u)\n"
+            "\t\t\t\ttevcoord.xy += wrappedcoord + indtevtrans;\n"
+            "\t\t\telse\n"
+            "\t\t\t\ttevcoord.xy = wrappedcoord + indtevtrans;\n\n"
+            "\t\t\t// Emulate s24 overflows\n"
+            "\t\t\ttevcoord.xy = (tevcoord.xy << 8) >> 8;\n"
+            "\t\t}\n\n");
+
+  // Rasterized color, texture and konstant inputs
+  out.Write("\t\tuint colorchan = (order >> 7) & 7u;\n"
+            "\t\tint4 ras;\n"
+            "\t\tif (colorchan == 0u)\n"
+            "\t\t\tras = iround(col0 * 255.0);\n"
+            "\t\telse if (colorchan == 1u)\n"
+            "\t\t\tras = iround(col1 * 255.0);\n"
+            "\t\telse if (colorchan == 5u)\n"
+            "\t\t\tras = int4(1, 1, 1, 1) * alphabump;\n"
+            "\t\telse if (colorchan == 6u)\n"
+            "\t\t\tras = int4(1, 1, 1, 1) * (alphabump | (alphabump >> 5));\n"
+            "\t\telse\n"
+            "\t\t\tras = int4(0, 0, 0, 0);\n"
+            "\t\trastemp = swizzle(ac & 3u, ras);\n\n"
+            "\t\tif (((order >> 6) & 1u) != 0u)\n"
+            "\t\t{\n"
+            "\t\t\tif (!has_indstage)\n"
+            "\t\t\t\ttevcoord.xy = has_texcoord ? fixpoint_uv[texcoord] : int2(0, 0);\n"
+            "\t\t\ttextemp = swizzle((ac >> 2) & 3u, sampleTexture(texmap, float2(tevcoord.xy), "
+            "layer_index));\n"
+            "\t\t}\n"
+            "\t\telse\n"
+            "\t\t{\n"
+            "\t\t\ttextemp = int4(255, 255, 255, 255);\n"
+            "\t\t}\n\n"
+            "\t\tkonsttemp = int4(selectKonstColor((order >> 10) & 31u), "
+            "selectKonstAlpha((order >> 15) & 31u));\n\n");
+
+  // Combiners
+  out.Write("\t\tint4 tevin_a = int4(selectColorInput((cc >> 12) & 15u, regs, textemp, rastemp, "
+            "konsttemp), selectAlphaInput((ac >> 13) & 7u, regs, textemp, rastemp, konsttemp)) & "
+            "255;\n"
+            "\t\tint4 tevin_b = int4(selectColorInput((cc >> 8) & 15u, regs, textemp, rastemp, "
+            "konsttemp), selectAlphaInput((ac >> 10) & 7u, regs, textemp, rastemp, konsttemp)) & "
+            "255;\n"
+            "\t\tint4 tevin_c = int4(selectColorInput((cc >> 4) & 15u, regs, textemp, rastemp, "
+            "konsttemp), selectAlphaInput((ac >> 7) & 7u, regs, textemp, rastemp, konsttemp)) & "
+            "255;\n"
+            "\t\tint4 tevin_d = int4(selectColorInput(cc & 15u, regs, textemp, rastemp, "
+            "konsttemp), selectAlphaInput((ac >> 4) & 7u, regs, textemp, rastemp, konsttemp));\n\n");
+
+  out.Write("\t\tint3 color;\n"
+            "\t\tuint color_bias = (cc >> 16) & 3u;\n"
+            "\t\tuint color_op = (cc >> 18) & 1u;\n"
+            "\t\tuint color_shift = (cc >> 20) & 3u;\n"
+            "\t\tif (color_bias != %uu)\n"
+            "\t\t\tcolor = tevRegular(tevin_a.rgb, tevin_b.rgb, tevin_c.rgb, tevin_d.rgb, "
+            "color_bias, color_op, color_shift);\n"
+            "\t\telse\n"
+            "\t\t\tcolor = tevin_d.rgb + tevCompareColor(tevin_a, tevin_b, tevin_c.rgb, "
+            "(color_shift << 1) | color_op);\n"
+            "\t\tif (((cc >> 19) & 1u) != 0u)\n"
+            "\t\t\tcolor = clamp(color, int3(0,0,0), int3(255,255,255));\n"
+            "\t\telse\n"
+            "\t\t\tcolor = clamp(color, int3(-1024,-1024,-1024), int3(1023,1023,1023));\n\n",
+            TEVBIAS_COMPARE);
+
+  out.Write("\t\tint alpha;\n"
+            "\t\tuint alpha_bias = (ac >> 16) & 3u;\n"
+            "\t\tuint alpha_op = (ac >> 18) & 1u;\n"
+            "\t\tuint alpha_shift = (ac >> 20) & 3u;\n"
+            "\t\tif (alpha_bias != %uu)\n"
+            "\t\t\talpha = tevRegular(tevin_a.a, tevin_b.a, tevin_c.a, tevin_d.a, alpha_bias, "
+            "alpha_op, alpha_shift);\n"
+            "\t\telse\n"
+            "\t\t\talpha = tevin_d.a + tevCompareAlpha(tevin_a, tevin_b, tevin_c.a, "
+            "(alpha_shift << 1) | alpha_op);\n"
+            "\t\tif (((ac >> 19) & 1u) != 0u)\n"
+            "\t\t\talpha = clamp(alpha, 0, 255);\n"
+            "\t\telse\n"
+            "\t\t\talpha = clamp(alpha, -1024, 1023);\n\n"
+            "\t\tregs[(cc >> 22) & 3u].rgb = color;\n"
+            "\t\tregs[(ac >> 22) & 3u].a = alpha;\n"
+            "\t}\n\n",
+            TEVBIAS_COMPARE);
+
+  // The results of the last stage are put onto the screen, regardless of the used destination
+  out.Write("\tint4 prev;\n"
+            "\tprev.rgb = regs[(" I_UBER_STAGES "[num_stages - 1u].x >> 22) & 3u].rgb;\n"
+            "\tprev.a = regs[(" I_UBER_STAGES "[num_stages - 1u].y >> 22) & 3u].a;\n"
+            "\tprev = prev & 255;\n\n");
+
+  // Alpha test, see WriteAlphaTest in PixelShaderGen.cpp
+  out.Write("\tif ((flags & %uu) != 0u)\n"
+            "\t{\n"
+            "\t\tuint alpha_test = " I_UBER_STATE ".w;\n"
+            "\t\tbool comp0 = alphaCompare(prev.a, " I_ALPHA ".r, (alpha_test >> 16) & 7u);\n"
+            "\t\tbool comp1 = alphaCompare(prev.a, " I_ALPHA ".g, (alpha_test >> 19) & 7u);\n"
+            "\t\tuint logic = (alpha_test >> 22) & 3u;\n"
+            "\t\tbool passed;\n"
+            "\t\tif (logic == 0u)\n"
+            "\t\t\tpassed = comp0 && comp1;\n"
+            "\t\telse if (logic == 1u)\n"
+            "\t\t\tpassed = comp0 || comp1;\n"
+            "\t\telse if (logic == 2u)\n"
+            "\t\t\tpassed = comp0 != comp1;\n"
+            "\t\telse\n"
+            "\t\t\tpassed = comp0 == comp1;\n\n",
+            UBER_FLAG_ALPHA_TEST);
+  if (DriverDetails::HasBug(DriverDetails::BUG_BROKEN_NEGATED_BOOLEAN))
+    out.Write("\t\tif (passed == false)\n");
+  else
+    out.Write("\t\tif (!passed)\n");
+  out.Write("\t\t{\n"
+            "\t\t\tocol0 = float4(0.0, 0.0, 0.0, 0.0);\n");
+  if (use_dual_source)
+    out.Write("\t\t\tocol1 = float4(0.0, 0.0, 0.0, 0.0);\n");
+  if (per_pixel_depth)
+    out.Write("\t\t\tdepth = %s;\n", (api_type == APIType::Vulkan) ? "0.0" : "1.0");
+  out.Write("\t\t\tif ((flags & %uu) == 0u)\n"
+            "\t\t\t{\n"
+            "\t\t\t\tdiscard;\n"
+            "\t\t\t\treturn;\n"
+            "\t\t\t}\n"
+            "\t\t}\n"
+            "\t}\n\n",
+            UBER_FLAG_ZCOMPLOC_HACK);
+
+  // Depth
+  out.Write("\tint zCoord;\n"
+            "\tif ((flags & %uu) != 0u)\n"
+            "\t{\n"
+            "\t\tfloat2 screenpos = rawpos.xy * " I_EFBSCALE ".xy;\n",
+            UBER_FLAG_ZFREEZE);
+  if (api_type == APIType::OpenGL)
+    out.Write("\t\tscreenpos.y = %i.0 - screenpos.y;\n", EFB_HEIGHT);
+  out.Write("\t\tzCoord = int(" I_ZSLOPE ".z + " I_ZSLOPE ".x * screenpos.x + " I_ZSLOPE
+            ".y * screenpos.y);\n"
+            "\t}\n"
+            "\telse\n"
+            "\t{\n");
+  if (!uid_data->fast_depth_calc)
+  {
+    out.Write("\t\tzCoord = " I_ZBIAS "[1].x + int((clipPos.z / clipPos.w) * float(" I_ZBIAS
+              "[1].y));\n");
+  }
+  else if (api_type == APIType::Vulkan)
+  {
+    out.Write("\t\tzCoord = int((1.0 - rawpos.z) * 16777216.0);\n");
+  }
+  else
+  {
+    out.Write("\t\tzCoord = int(rawpos.z * 16777216.0);\n");
+  }
+  out.Write("\t}\n"
+            "\tzCoord = clamp(zCoord, 0, 0xFFFFFF);\n\n");
+
+  const char* depth_write = (api_type == APIType::Vulkan) ?
+                                "depth = 1.0 - float(zCoord) / 16777216.0;\n" :
+                                "depth = float(zCoord) / 16777216.0;\n";
+  if (per_pixel_depth)
+    out.Write("\tif ((flags & %uu) != 0u)\n\t\t%s", UBER_FLAG_EARLY_ZTEST, depth_write);
+
+  out.Write("\tuint ztex_op = " I_UBER_FLAGS ".y;\n"
+            "\tif (ztex_op != %uu)\n"
+            "\t{\n"
+            "\t\tzCoord = idot(" I_ZBIAS "[0].xyzw, textemp.xyzw) + " I_ZBIAS "[1].w + "
+            "((ztex_op == %uu) ? zCoord : 0);\n"
+            "\t\tzCoord = zCoord & 0xFFFFFF;\n"
+            "\t}\n",
+            ZTEXTURE_DISABLE, ZTEXTURE_ADD);
+
+  if (per_pixel_depth)
+    out.Write("\tif ((flags & %uu) != 0u)\n\t\t%s", UBER_FLAG_LATE_ZTEST, depth_write);
+  out.Write("\n");
+
+  out.Write("\tif ((flags & %uu) != 0u)\n"
+            "\t{\n"
+            "\t\tint2 dither = int2(rawpos.xy) & 1;\n"
+            "\t\tprev.rgb = (prev.rgb - (prev.rgb >> 6)) + abs(dither.y * 3 - dither.x * 2);\n"
+            "\t}\n\n",
+            UBER_FLAG_DITHER);
+
+  // Fog, see WriteFog in PixelShaderGen.cpp
+  out.Write("\tuint fog_fsel = " I_UBER_FLAGS ".x & 7u;\n"
+            "\tif (fog_fsel != 0u)\n"
+            "\t{\n"
+            "\t\tfloat ze;\n"
+            "\t\tif (((" I_UBER_FLAGS ".x >> 3) & 1u) == 0u)\n"
+            "\t\t\tze = (" I_FOGF "[1].x * 16777216.0) / float(" I_FOGI ".y - (zCoord >> " I_FOGI
+            ".w));\n"
+            "\t\telse\n"
+            "\t\t\tze = " I_FOGF "[1].x * float(zCoord) / 16777216.0;\n\n"
+            "\t\tif (((" I_UBER_FLAGS ".x >> 4) & 1u) != 0u)\n"
+            "\t\t{\n"
+            "\t\t\tfloat x_adjust = (2.0 * (rawpos.x / " I_FOGF "[0].y)) - 1.0 - " I_FOGF
+            "[0].x;\n"
+            "\t\t\tx_adjust = sqrt(x_adjust * x_adjust + " I_FOGF "[0].z * " I_FOGF "[0].z) / " I_FOGF
+            "[0].z;\n"
+            "\t\t\tze *= x_adjust;\n"
+            "\t\t}\n\n"
+            "\t\tfloat fog = clamp(ze - " I_FOGF "[1].z, 0.0, 1.0);\n"
+            "\t\tif (fog_fsel == 4u)\n"
+            "\t\t\tfog = 1.0 - exp2(-8.0 * fog);\n"
+            "\t\telse if (fog_fsel == 5u)\n"
+            "\t\t\tfog = 1.0 - exp2(-8.0 * fog * fog);\n"
+            "\t\telse if (fog_fsel == 6u)\n"
+            "\t\t\tfog = exp2(-8.0 * (1.0 - fog));\n"
+            "\t\telse if (fog_fsel == 7u)\n"
+            "\t\t\tfog = exp2(-8.0 * (1.0 - fog) * (1.0 - fog));\n\n"
+            "\t\tint ifog = iround(fog * 256.0);\n"
+            "\t\tprev.rgb = (prev.rgb * (256 - ifog) + " I_FOGCOLOR ".rgb * ifog) >> 8;\n"
+            "\t}\n\n");
+
+  // Colors will be blended against the 8-bit alpha from ocol1 and
+  // the 6-bit alpha from ocol0 will be written to the framebuffer
+  out.Write("\tif ((flags & %uu) != 0u)\n"
+            "\t\tocol0.rgb = float3(prev.rgb >> 2) / 63.0;\n"
+            "\telse\n"
+            "\t\tocol0.rgb = float3(prev.rgb) / 255.0;\n"
+            "\tif ((flags & %uu) != 0u)\n"
+            "\t\tocol0.a = float(" I_ALPHA ".a >> 2) / 63.0;\n"
+            "\telse\n"
+            "\t\tocol0.a = float(prev.a >> 2) / 63.0;\n",
+            UBER_FLAG_RGBA6, UBER_FLAG_DSTALPHA);
+  if (use_dual_source)
+    out.Write("\tocol1.a = float(prev.a) / 255.0;\n");
+
+  if (uid_data->bounding_box)
+  {
+    out.Write("\tif(bbox_data[0] > int(rawpos.x)) atomicMin(bbox_data[0], int(rawpos.x));\n"
+              "\tif(bbox_data[1] < int(rawpos.x)) atomicMax(bbox_data[1], int(rawpos.x));\n"
+              "\tif(bbox_data[2] > int(rawpos.y)) atomicMin(bbox_data[2], int(rawpos.y));\n"
+              "\tif(bbox_data[3] < int(rawpos.y)) atomicMax(bbox_data[3], int(rawpos.y));\n");
+  }
+
+  out.Write("}\n");
+
+  return out;
+}
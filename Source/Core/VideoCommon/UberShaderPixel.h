@@ -0,0 +1,53 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ShaderGenCommon.h"
+
+enum class APIType;
+
+// The pixel ubershader runs the TEV stages in a loop, reading their configuration from the
+// I_UBER_* constants instead of having it baked in. Only the state which changes the shader's
+// interface is part of the uid, so very few of them are needed. Draws fall back to them while
+// the specialized shaders are compiled in the background. Only GLSL is generated.
+
+// Bits of I_UBER_FLAGS.z, for the state which the pixel shader uid derives from several registers.
+enum : u32
+{
+  UBER_FLAG_ALPHA_TEST = 1 << 0,
+  UBER_FLAG_ZCOMPLOC_HACK = 1 << 1,
+  UBER_FLAG_ZFREEZE = 1 << 2,
+  UBER_FLAG_EARLY_ZTEST = 1 << 3,
+  UBER_FLAG_LATE_ZTEST = 1 << 4,
+  UBER_FLAG_RGBA6 = 1 << 5,
+  UBER_FLAG_DITHER = 1 << 6,
+  UBER_FLAG_DSTALPHA = 1 << 7,
+};
+
+#pragma pack(1)
+struct pixel_ubershader_uid_data
+{
+  u32 NumValues() const { return sizeof(pixel_ubershader_uid_data); }
+  u32 num_texgens : 4;
+  u32 early_depth : 1;
+  u32 per_pixel_depth : 1;
+  u32 per_pixel_lighting : 1;
+  u32 components : 2;  // Only the color bits, for per-pixel lighting
+  u32 bounding_box : 1;
+  u32 fast_depth_calc : 1;
+  u32 msaa : 1;
+  u32 ssaa : 1;
+  u32 stereo : 1;
+  u32 uses_dual_source : 1;
+  u32 pad : 17;
+};
+#pragma pack()
+
+typedef ShaderUid<pixel_ubershader_uid_data> UberPixelShaderUid;
+
+UberPixelShaderUid GetUberPixelShaderUid();
+ShaderCode GenerateUberPixelShaderCode(APIType api_type,
+                                       const pixel_ubershader_uid_data* uid_data);
@@ -0,0 +1,370 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/UberShaderVertex.h"
+
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/LightingShaderGen.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+UberVertexShaderUid GetUberVertexShaderUid()
+{
+  UberVertexShaderUid out;
+  vertex_ubershader_uid_data* uid_data = out.GetUidData<vertex_ubershader_uid_data>();
+  memset(uid_data, 0, sizeof(*uid_data));
+
+  uid_data->components = VertexLoaderManager::g_current_components;
+  uid_data->num_texgens = xfmem.numTexGen.numTexGens;
+  uid_data->per_pixel_lighting = g_ActiveConfig.bEnablePixelLighting;
+  uid_data->msaa = g_ActiveConfig.iMultisamples > 1;
+  uid_data->ssaa = g_ActiveConfig.iMultisamples > 1 && g_ActiveConfig.bSSAA;
+  uid_data->vertex_rounding =
+      g_ActiveConfig.bVertexRounding && g_ActiveConfig.iEFBScale != SCALE_1X;
+
+  return out;
+}
+
+static void WriteTexgen(ShaderCode& out, const vertex_ubershader_uid_data* uid_data, u32 i)
+{
+  const u32 components = uid_data->components;
+
+  // See the texgen loop in GenerateVertexShaderCode, the bits are those of TexMtxInfo.
+  out.Write("{\n"
+            "uint texMtxInfo = " I_UBER_TEXGENS "[%u].x;\n"
+            "uint postMtxInfo = " I_UBER_TEXGENS "[%u].y;\n"
+            "uint sourcerow = (texMtxInfo >> 7) & 31u;\n"
+            "float4 coord = float4(0.0, 0.0, 1.0, 1.0);\n",
+            i, i);
+
+  out.Write("if (sourcerow == %uu)\n"
+            "\tcoord.xyz = rawpos.xyz;\n",
+            XF_SRCGEOM_INROW);
+  if (components & VB_HAS_NRM0)
+    out.Write("else if (sourcerow == %uu)\n\tcoord.xyz = rawnorm0.xyz;\n", XF_SRCNORMAL_INROW);
+  if (components & VB_HAS_NRM1)
+    out.Write("else if (sourcerow == %uu)\n\tcoord.xyz = rawnorm1.xyz;\n", XF_SRCBINORMAL_T_INROW);
+  if (components & VB_HAS_NRM2)
+    out.Write("else if (sourcerow == %uu)\n\tcoord.xyz = rawnorm2.xyz;\n", XF_SRCBINORMAL_B_INROW);
+  for (u32 uv = 0; uv < 8; ++uv)
+  {
+    if (components & (VB_HAS_UV0 << uv))
+    {
+      out.Write("else if (sourcerow == %uu)\n\tcoord = float4(tex%u.x, tex%u.y, 1.0, 1.0);\n",
+                XF_SRCTEX0_INROW + uv, uv, uv);
+    }
+  }
+
+  // Input form of AB11 sets z element to 1.0
+  out.Write("if (((texMtxInfo >> 2) & 1u) == %uu)\n"
+            "\tcoord.z = 1.0;\n\n",
+            XF_TEXINPUT_AB11);
+
+  out.Write("uint texgentype = (texMtxInfo >> 4) & 7u;\n"
+            "if (texgentype == %uu)\n"
+            "{\n"
+            "\tuint source = (texMtxInfo >> 12) & 7u;\n",
+            XF_TEXGEN_EMBOSS_MAP);
+  if (components & (VB_HAS_NRM1 | VB_HAS_NRM2))
+  {
+    out.Write("\tuint light = (texMtxInfo >> 15) & 7u;\n"
+              "\tfloat3 ldir = normalize(" I_LIGHTS "[light].pos.xyz - pos.xyz);\n"
+              "\ttexcoords[%u] = texcoords[source] + float3(dot(ldir, _norm1), dot(ldir, _norm2), "
+              "0.0);\n",
+              i);
+  }
+  else
+  {
+    out.Write("\ttexcoords[%u] = texcoords[source];\n", i);
+  }
+  out.Write("}\n"
+            "else if (texgentype == %uu)\n"
+            "{\n"
+            "\ttexcoords[%u] = float3(o.colors_0.x, o.colors_0.y, 1.0);\n"
+            "}\n"
+            "else if (texgentype == %uu)\n"
+            "{\n"
+            "\ttexcoords[%u] = float3(o.colors_1.x, o.colors_1.y, 1.0);\n"
+            "}\n"
+            "else\n"
+            "{\n"
+            "\tbool stq = ((texMtxInfo >> 1) & 1u) == %uu;\n",
+            XF_TEXGEN_COLOR_STRGBC0, i, XF_TEXGEN_COLOR_STRGBC1, i, XF_TEXPROJ_STQ);
+
+  if (components & (VB_HAS_TEXMTXIDX0 << i))
+  {
+    out.Write("\tint tmp = int(tex%u.z);\n"
+              "\ttexcoords[%u] = float3(dot(coord, " I_TRANSFORMMATRICES
+              "[tmp]), dot(coord, " I_TRANSFORMMATRICES "[tmp+1]), stq ? dot(coord, " I_TRANSFORMMATRICES
+              "[tmp+2]) : 1.0);\n",
+              i, i);
+  }
+  else
+  {
+    out.Write("\ttexcoords[%u] = float3(dot(coord, " I_TEXMATRICES "[%u]), dot(coord, " I_TEXMATRICES
+              "[%u]), stq ? dot(coord, " I_TEXMATRICES "[%u]) : 1.0);\n",
+              i, 3 * i, 3 * i + 1, 3 * i + 2);
+  }
+
+  out.Write("\tif (" I_UBER_XFSTATE ".y != 0u)\n"
+            "\t{\n"
+            "\t\tuint base = postMtxInfo & 63u;\n"
+            "\t\tfloat4 P0 = " I_POSTTRANSFORMMATRICES "[base];\n"
+            "\t\tfloat4 P1 = " I_POSTTRANSFORMMATRICES "[(base + 1u) & 63u];\n"
+            "\t\tfloat4 P2 = " I_POSTTRANSFORMMATRICES "[(base + 2u) & 63u];\n"
+            "\t\tif (((postMtxInfo >> 8) & 1u) != 0u)\n"
+            "\t\t\ttexcoords[%u] = normalize(texcoords[%u]);\n"
+            "\t\ttexcoords[%u] = float3(dot(P0.xyz, texcoords[%u]) + P0.w, dot(P1.xyz, "
+            "texcoords[%u]) + P1.w, dot(P2.xyz, texcoords[%u]) + P2.w);\n"
+            "\t}\n\n",
+            i, i, i, i, i, i);
+
+  // The q == 0 special case, see GenerateVertexShaderCode
+  out.Write("\tif (texcoords[%u].z == 0.0)\n"
+            "\t\ttexcoords[%u].xy = clamp(texcoords[%u].xy / 2.0, float2(-1.0, -1.0), "
+            "float2(1.0, 1.0));\n"
+            "}\n"
+            "}\n",
+            i, i, i);
+}
+
+ShaderCode GenerateUberVertexShaderCode(APIType api_type,
+                                        const vertex_ubershader_uid_data* uid_data)
+{
+  ShaderCode out;
+  const u32 components = uid_data->components;
+  const u32 num_texgens = uid_data->num_texgens;
+  const bool per_pixel_lighting = uid_data->per_pixel_lighting;
+  const bool use_block =
+      g_ActiveConfig.backend_info.bSupportsGeometryShaders || api_type == APIType::Vulkan;
+
+  out.Write("// Vertex UberShader\n\n");
+  out.Write("%s", s_lighting_struct);
+
+  // Has to match the pixel ubershader's block.
+  out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+  out.Write(s_shader_uniforms);
+  out.Write(s_uber_shader_uniforms);
+  out.Write("};\n");
+
+  out.Write("struct VS_OUTPUT {\n");
+  GenerateVSOutputMembers(out, api_type, num_texgens, per_pixel_lighting, "");
+  out.Write("};\n");
+
+  out.Write("ATTRIBUTE_LOCATION(%d) in float4 rawpos;\n", SHADER_POSITION_ATTRIB);
+  if (components & VB_HAS_POSMTXIDX)
+    out.Write("ATTRIBUTE_LOCATION(%d) in uint4 posmtx;\n", SHADER_POSMTX_ATTRIB);
+  if (components & VB_HAS_NRM0)
+    out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm0;\n", SHADER_NORM0_ATTRIB);
+  if (components & VB_HAS_NRM1)
+    out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm1;\n", SHADER_NORM1_ATTRIB);
+  if (components & VB_HAS_NRM2)
+    out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm2;\n", SHADER_NORM2_ATTRIB);
+  if (components & VB_HAS_COL0)
+    out.Write("ATTRIBUTE_LOCATION(%d) in float4 color0;\n", SHADER_COLOR0_ATTRIB);
+  if (components & VB_HAS_COL1)
+    out.Write("ATTRIBUTE_LOCATION(%d) in float4 color1;\n", SHADER_COLOR1_ATTRIB);
+  for (int i = 0; i < 8; ++i)
+  {
+    u32 hastexmtx = (components & (VB_HAS_TEXMTXIDX0 << i));
+    if ((components & (VB_HAS_UV0 << i)) || hastexmtx)
+    {
+      out.Write("ATTRIBUTE_LOCATION(%d) in float%d tex%d;\n", SHADER_TEXTURE0_ATTRIB + i,
+                hastexmtx ? 3 : 2, i);
+    }
+  }
+
+  const char* qualifier = GetInterpolationQualifier(uid_data->msaa, uid_data->ssaa);
+  if (use_block)
+  {
+    out.Write("VARYING_LOCATION(0) out VertexData {\n");
+    GenerateVSOutputMembers(out, api_type, num_texgens, per_pixel_lighting,
+                            GetInterpolationQualifier(uid_data->msaa, uid_data->ssaa, true, false));
+    out.Write("} vs;\n");
+  }
+  else
+  {
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("%s out float3 uv%u;\n", qualifier, i);
+    out.Write("%s out float4 clipPos;\n", qualifier);
+    if (per_pixel_lighting)
+    {
+      out.Write("%s out float3 Normal;\n", qualifier);
+      out.Write("%s out float3 WorldPos;\n", qualifier);
+    }
+    out.Write("%s out float4 colors_0;\n", qualifier);
+    out.Write("%s out float4 colors_1;\n", qualifier);
+  }
+  out.Write("\n");
+
+  WriteUberLightingFunction(out);
+
+  out.Write("void main()\n{\n");
+  out.Write("VS_OUTPUT o;\n");
+
+  // transforms, same as in the specialized shaders
+  if (components & VB_HAS_POSMTXIDX)
+  {
+    out.Write("int posidx = int(posmtx.r);\n");
+    out.Write("float4 pos = float4(dot(" I_TRANSFORMMATRICES
+              "[posidx], rawpos), dot(" I_TRANSFORMMATRICES
+              "[posidx+1], rawpos), dot(" I_TRANSFORMMATRICES "[posidx+2], rawpos), 1);\n");
+
+    if (components & VB_HAS_NRMALL)
+    {
+      out.Write("int normidx = posidx & 31;\n");
+      out.Write("float3 N0 = " I_NORMALMATRICES "[normidx].xyz, N1 = " I_NORMALMATRICES
+                "[normidx+1].xyz, N2 = " I_NORMALMATRICES "[normidx+2].xyz;\n");
+    }
+
+    if (components & VB_HAS_NRM0)
+      out.Write("float3 _norm0 = normalize(float3(dot(N0, rawnorm0), dot(N1, rawnorm0), dot(N2, "
+                "rawnorm0)));\n");
+    if (components & VB_HAS_NRM1)
+      out.Write(
+          "float3 _norm1 = float3(dot(N0, rawnorm1), dot(N1, rawnorm1), dot(N2, rawnorm1));\n");
+    if (components & VB_HAS_NRM2)
+      out.Write(
+          "float3 _norm2 = float3(dot(N0, rawnorm2), dot(N1, rawnorm2), dot(N2, rawnorm2));\n");
+  }
+  else
+  {
+    out.Write("float4 pos = float4(dot(" I_POSNORMALMATRIX "[0], rawpos), dot(" I_POSNORMALMATRIX
+              "[1], rawpos), dot(" I_POSNORMALMATRIX "[2], rawpos), 1.0);\n");
+    if (components & VB_HAS_NRM0)
+      out.Write("float3 _norm0 = normalize(float3(dot(" I_POSNORMALMATRIX
+                "[3].xyz, rawnorm0), dot(" I_POSNORMALMATRIX
+                "[4].xyz, rawnorm0), dot(" I_POSNORMALMATRIX "[5].xyz, rawnorm0)));\n");
+    if (components & VB_HAS_NRM1)
+      out.Write("float3 _norm1 = float3(dot(" I_POSNORMALMATRIX
+                "[3].xyz, rawnorm1), dot(" I_POSNORMALMATRIX
+                "[4].xyz, rawnorm1), dot(" I_POSNORMALMATRIX "[5].xyz, rawnorm1));\n");
+    if (components & VB_HAS_NRM2)
+      out.Write("float3 _norm2 = float3(dot(" I_POSNORMALMATRIX
+                "[3].xyz, rawnorm2), dot(" I_POSNORMALMATRIX
+                "[4].xyz, rawnorm2), dot(" I_POSNORMALMATRIX "[5].xyz, rawnorm2));\n");
+  }
+
+  // The emboss texgen may use either binormal, whichever of them is present.
+  if (!(components & VB_HAS_NRM0))
+    out.Write("float3 _norm0 = float3(0.0, 0.0, 0.0);\n");
+  if ((components & VB_HAS_NRM2) && !(components & VB_HAS_NRM1))
+    out.Write("float3 _norm1 = float3(0.0, 0.0, 0.0);\n");
+  if ((components & VB_HAS_NRM1) && !(components & VB_HAS_NRM2))
+    out.Write("float3 _norm2 = float3(0.0, 0.0, 0.0);\n");
+
+  out.Write("o.pos = float4(dot(" I_PROJECTION "[0], pos), dot(" I_PROJECTION
+            "[1], pos), dot(" I_PROJECTION "[2], pos), dot(" I_PROJECTION "[3], pos));\n");
+
+  // The number of color channels is I_UBER_XFSTATE.x
+  out.Write("if (" I_UBER_XFSTATE ".x == 0u)\n");
+  if (components & VB_HAS_COL0)
+    out.Write("\to.colors_0 = color0;\n");
+  else
+    out.Write("\to.colors_0 = float4(1.0, 1.0, 1.0, 1.0);\n");
+
+  GenerateUberLightingShaderCode(out, components, "color", "o.colors_");
+
+  out.Write("if (" I_UBER_XFSTATE ".x < 2u)\n");
+  if (components & VB_HAS_COL1)
+    out.Write("\to.colors_1 = color1;\n");
+  else
+    out.Write("\to.colors_1 = o.colors_0;\n");
+
+  // transform texcoords
+  if (num_texgens > 0)
+  {
+    out.Write("float3 texcoords[%u];\n", num_texgens);
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("texcoords[%u] = float3(0.0, 0.0, 0.0);\n", i);
+    for (u32 i = 0; i < num_texgens; ++i)
+      WriteTexgen(out, uid_data, i);
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("o.tex%u = texcoords[%u];\n", i, i);
+  }
+
+  // clipPos/w needs to be done in pixel shader, not here
+  out.Write("o.clipPos = o.pos;\n");
+
+  if (per_pixel_lighting)
+  {
+    out.Write("o.Normal = _norm0;\n");
+    out.Write("o.WorldPos = pos.xyz;\n");
+
+    if (components & VB_HAS_COL0)
+      out.Write("o.colors_0 = color0;\n");
+
+    if (components & VB_HAS_COL1)
+      out.Write("o.colors_1 = color1;\n");
+  }
+
+  // The depth and viewport handling below is the same as in GenerateVertexShaderCode.
+  if (g_ActiveConfig.backend_info.bSupportsDepthClamp)
+  {
+    out.Write("float clipDepth = o.pos.z * (1.0 - 1e-7);\n");
+    out.Write("o.clipDist0 = clipDepth + o.pos.w;\n");  // Near: z < -w
+    out.Write("o.clipDist1 = -clipDepth;\n");           // Far: z > 0
+  }
+
+  out.Write("o.pos.z = o.pos.w * " I_PIXELCENTERCORRECTION ".w - "
+            "o.pos.z * " I_PIXELCENTERCORRECTION ".z;\n");
+
+  if (!g_ActiveConfig.backend_info.bSupportsClipControl)
+    out.Write("o.pos.z = o.pos.z * 2.0 - o.pos.w;\n");
+
+  out.Write("o.pos.xy *= sign(" I_PIXELCENTERCORRECTION ".xy * float2(1.0, -1.0));\n");
+  out.Write("o.pos.xy = o.pos.xy - o.pos.w * " I_PIXELCENTERCORRECTION ".xy;\n");
+
+  if (uid_data->vertex_rounding)
+  {
+    out.Write("if (o.pos.w == 1.0f)\n");
+    out.Write("{\n");
+    out.Write("\tfloat ss_pixel_x = ((o.pos.x + 1.0f) * (" I_VIEWPORT_SIZE ".x * 0.5f));\n");
+    out.Write("\tfloat ss_pixel_y = ((o.pos.y + 1.0f) * (" I_VIEWPORT_SIZE ".y * 0.5f));\n");
+    out.Write("\tss_pixel_x = round(ss_pixel_x);\n");
+    out.Write("\tss_pixel_y = round(ss_pixel_y);\n");
+    out.Write("\to.pos.x = ((ss_pixel_x / (" I_VIEWPORT_SIZE ".x * 0.5f)) - 1.0f);\n");
+    out.Write("\to.pos.y = ((ss_pixel_y / (" I_VIEWPORT_SIZE ".y * 0.5f)) - 1.0f);\n");
+    out.Write("}\n");
+  }
+
+  if (use_block)
+  {
+    AssignVSOutputMembers(out, "vs", "o", num_texgens, per_pixel_lighting);
+  }
+  else
+  {
+    for (u32 i = 0; i < num_texgens; ++i)
+      out.Write("uv%u.xyz = o.tex%u;\n", i, i);
+    out.Write("clipPos = o.clipPos;\n");
+    if (per_pixel_lighting)
+    {
+      out.Write("Normal = o.Normal;\n");
+      out.Write("WorldPos = o.WorldPos;\n");
+    }
+    out.Write("colors_0 = o.colors_0;\n");
+    out.Write("colors_1 = o.colors_1;\n");
+  }
+
+  if (g_ActiveConfig.backend_info.bSupportsDepthClamp)
+  {
+    out.Write("gl_ClipDistance[0] = o.clipDist0;\n");
+    out.Write("gl_ClipDistance[1] = o.clipDist1;\n");
+  }
+
+  // Vulkan NDC space has Y pointing down (right-handed NDC space).
+  if (api_type == APIType::Vulkan)
+    out.Write("gl_Position = float4(o.pos.x, -o.pos.y, o.pos.z, o.pos.w);\n");
+  else
+    out.Write("gl_Position = o.pos;\n");
+  out.Write("}\n");
+
+  return out;
+}
@@ -0,0 +1,33 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ShaderGenCommon.h"
+
+enum class APIType;
+
+// The vertex ubershader reads the lighting and texgen configuration from the I_UBER_* constants.
+// The vertex components stay in the uid, as they decide the shader's inputs.
+
+#pragma pack(1)
+struct vertex_ubershader_uid_data
+{
+  u32 NumValues() const { return sizeof(vertex_ubershader_uid_data); }
+  u32 components : 23;
+  u32 num_texgens : 4;
+  u32 per_pixel_lighting : 1;
+  u32 msaa : 1;
+  u32 ssaa : 1;
+  u32 vertex_rounding : 1;
+  u32 pad : 1;
+};
+#pragma pack()
+
+typedef ShaderUid<vertex_ubershader_uid_data> UberVertexShaderUid;
+
+UberVertexShaderUid GetUberVertexShaderUid();
+ShaderCode GenerateUberVertexShaderCode(APIType api_type,
+                                        const vertex_ubershader_uid_data* uid_data);
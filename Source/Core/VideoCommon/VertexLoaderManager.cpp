@@ -271,7 +271,11 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
+  {
+    ScopedStatTimer timer(stats.totals.vertexLoaderTime);
+    count = loader->RunVertices(src, dst, count);
+  }
+  ADDSTAT(stats.totals.numVerticesLoaded, count);
 
   IndexGenerator::AddIndices(primitive, count);
 
@@ -997,6 +997,33 @@ void VertexShaderManager::SetConstants()
 
   if (g_ActiveConfig.iMotionSicknessSkybox == 2 && g_is_skybox)
     LockSkybox();
+
+  if (g_ActiveConfig.UseBackgroundShaderCompiling())
+    SetUberShaderConstants();
+}
+
+void VertexShaderManager::SetUberShaderConstants()
+{
+  // Repacked on each draw like the pixel ubershader state, see PixelShaderManager.
+  uint4 xfstate = {xfmem.numChan.numColorChans, xfmem.dualTexTrans.enabled, 0, 0};
+  uint4 litchannels = {xfmem.color[0].hex, xfmem.color[1].hex, xfmem.alpha[0].hex,
+                       xfmem.alpha[1].hex};
+  uint4 texgens[8] = {};
+  for (u32 i = 0; i < xfmem.numTexGen.numTexGens; i++)
+  {
+    texgens[i][0] = xfmem.texMtxInfo[i].hex;
+    texgens[i][1] = xfmem.postMtxInfo[i].hex;
+  }
+
+  if (memcmp(xfstate, constants.uberxfstate, sizeof(xfstate)) != 0 ||
+      memcmp(litchannels, constants.uberlitchannels, sizeof(litchannels)) != 0 ||
+      memcmp(texgens, constants.ubertexgens, sizeof(texgens)) != 0)
+  {
+    memcpy(constants.uberxfstate, xfstate, sizeof(xfstate));
+    memcpy(constants.uberlitchannels, litchannels, sizeof(litchannels));
+    memcpy(constants.ubertexgens, texgens, sizeof(texgens));
+    dirty = true;
+  }
 }
 
 //#pragma optimize("", off)
@@ -68,6 +68,9 @@ public:
   static float4 constants_eye_projection[2][4];
   static bool m_layer_on_top;
   static bool dirty;
+
+private:
+  static void SetUberShaderConstants();
 };
 
 void ScaleRequestedToRendered(EFBRectangle* requested, EFBRectangle* rendered);
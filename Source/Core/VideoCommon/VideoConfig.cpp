@@ -51,6 +51,7 @@ VideoConfig::VideoConfig()
   backend_info.bSupportsMultithreading = false;
   backend_info.bSupportsInternalResolutionFrameDumps = false;
   backend_info.bSupportsST3CTextures = false;
+  backend_info.bSupportsBackgroundShaderCompiling = false;
 
   bEnableValidationLayer = false;
   bBackendMultithreading = true;
@@ -168,6 +169,7 @@ void VideoConfig::Load(const std::string& ini_file)
   settings->Get("UseXFB", &bUseXFB, false);
   settings->Get("UseRealXFB", &bUseRealXFB, false);
   settings->Get("SafeTextureCacheColorSamples", &iSafeTextureCache_ColorSamples, 128);
+  settings->Get("TextureWriteTracking", &bTextureWriteTracking, false);
   settings->Get("ShowFPS", &bShowFPS, false);
   settings->Get("ShowNetPlayPing", &bShowNetPlayPing, false);
   settings->Get("ShowNetPlayMessages", &bShowNetPlayMessages, false);
@@ -211,6 +213,7 @@ void VideoConfig::Load(const std::string& ini_file)
   settings->Get("BackendMultithreading", &bBackendMultithreading, true);
   settings->Get("CommandBufferExecuteInterval", &iCommandBufferExecuteInterval, 100);
   settings->Get("ShaderCache", &bShaderCache, true);
+  settings->Get("BackgroundShaderCompiling", &bBackgroundShaderCompiling, false);
 
   settings->Get("SWZComploc", &bZComploc, true);
   settings->Get("SWZFreeze", &bZFreeze, true);
@@ -388,6 +391,7 @@ void VideoConfig::GameIniLoad()
   CHECK_SETTING("Video_Settings", "UseXFB", bUseXFB);
   CHECK_SETTING("Video_Settings", "UseRealXFB", bUseRealXFB);
   CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+  CHECK_SETTING("Video_Settings", "TextureWriteTracking", bTextureWriteTracking);
   CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
   CHECK_SETTING("Video_Settings", "ConvertHiresTextures", bConvertHiresTextures);
   CHECK_SETTING("Video_Settings", "CacheHiresTextures", bCacheHiresTextures);
@@ -427,6 +431,7 @@ void VideoConfig::GameIniLoad()
   CHECK_SETTING("Video_Settings", "DisableFog", bDisableFog);
   CHECK_SETTING("Video_Settings", "BackendMultithreading", bBackendMultithreading);
   CHECK_SETTING("Video_Settings", "CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
+  CHECK_SETTING("Video_Settings", "BackgroundShaderCompiling", bBackgroundShaderCompiling);
 
   CHECK_SETTING("Video_Enhancements", "ForceFiltering", bForceFiltering);
   CHECK_SETTING("Video_Enhancements", "MaxAnisotropy",
@@ -682,6 +687,7 @@ void VideoConfig::Save(const std::string& ini_file)
   settings->Set("UseXFB", bUseXFB);
   settings->Set("UseRealXFB", bUseRealXFB);
   settings->Set("SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+  settings->Set("TextureWriteTracking", bTextureWriteTracking);
   settings->Set("ShowFPS", bShowFPS);
   settings->Set("ShowNetPlayPing", bShowNetPlayPing);
   settings->Set("ShowNetPlayMessages", bShowNetPlayMessages);
@@ -719,6 +725,7 @@ void VideoConfig::Save(const std::string& ini_file)
   settings->Set("BackendMultithreading", bBackendMultithreading);
   settings->Set("CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
   settings->Set("ShaderCache", bShaderCache);
+  settings->Set("BackgroundShaderCompiling", bBackgroundShaderCompiling);
 
   settings->Set("SWZComploc", bZComploc);
   settings->Set("SWZFreeze", bZFreeze);
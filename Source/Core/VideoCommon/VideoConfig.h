@@ -86,6 +86,8 @@ struct VideoConfig final
   bool bUseXFB;
   bool bUseRealXFB;
   bool bShaderCache;
+  // Compile new shaders on worker threads, drawing with the ubershaders in the meantime.
+  bool bBackgroundShaderCompiling;
 
   // Enhancements
   int iMultisamples;
@@ -140,6 +142,8 @@ struct VideoConfig final
   bool bSkipEFBCopyToRam;
   bool bCopyEFBScaled;
   int iSafeTextureCache_ColorSamples;
+  // Only rehash textures in RAM after the CPU wrote to their pages. Needs fastmem.
+  bool bTextureWriteTracking;
   int iPhackvalue[3];
   std::string sPhackvalue[2];
   float fAspectRatioHackW, fAspectRatioHackH;
@@ -333,6 +337,7 @@ struct VideoConfig final
     bool bSupportsInternalResolutionFrameDumps;
     bool bSupportsGPUTextureDecoding;
     bool bSupportsST3CTextures;
+    bool bSupportsBackgroundShaderCompiling;
   } backend_info;
 
   // Utility
@@ -354,6 +359,10 @@ struct VideoConfig final
   {
     return backend_info.bSupportsGPUTextureDecoding && bEnableGPUTextureDecoding;
   }
+  bool UseBackgroundShaderCompiling() const
+  {
+    return backend_info.bSupportsBackgroundShaderCompiling && bBackgroundShaderCompiling;
+  }
 };
 
 extern VideoConfig g_Config;
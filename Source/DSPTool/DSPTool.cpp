@@ -2,13 +2,22 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+
 #include "Common/Common.h"
+#include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
+#include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Swap.h"
 #include "Core/DSP/DSPCodeUtil.h"
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPDisassembler.h"
 #include "Core/DSP/DSPHost.h"
 #include "Core/DSP/DSPTables.h"
+#include "Core/DSP/Jit/DSPEmitter.h"
 
 // Stub out the dsplib host stuff, since this is just a simple cmdline tools.
 u8 DSP::Host::ReadHostMemory(u32 addr)
@@ -112,6 +121,84 @@ static void CodesToHeader(const std::vector<u16>* codes, const std::vector<std::
   header.append("};\n");
 }
 
+// The DSP runs at 81 MHz on the GameCube.
+constexpr u64 DSP_CLOCK_RATE = 81000000;
+
+static void LoadBenchmarkRom(u16* rom, const std::string& filename, u32 size_in_bytes)
+{
+  std::string bytes;
+  if (!File::ReadFileToString(filename, bytes) || bytes.size() != size_in_bytes)
+  {
+    printf("WARNING: Could not load %s, using an empty ROM.\n", filename.c_str());
+    std::fill(rom, rom + size_in_bytes / 2, 0);
+    return;
+  }
+
+  const u16* words = reinterpret_cast<const u16*>(bytes.c_str());
+  for (u32 i = 0; i < size_in_bytes / 2; ++i)
+    rom[i] = Common::swap16(words[i]);
+}
+
+// Runs a ucode dump (as written by DumpDSPCode) from its reset vector for the given amount of
+// emulated time, and reports how fast the core got through it. No mail and no DMA is serviced,
+// so this mostly measures the ucode's startup and main loops.
+static bool RunBenchmark(const std::string& input_name, u32 ms, bool interpreter)
+{
+  std::string binary_code;
+  std::vector<u16> code;
+  if (!File::ReadFileToString(input_name, binary_code))
+    return false;
+  DSP::BinaryStringBEToCode(binary_code, code);
+  if (code.empty() || code.size() > DSP::DSP_IRAM_SIZE)
+  {
+    printf("Benchmark: The ucode must have between 1 and %u instructions.\n",
+           static_cast<u32>(DSP::DSP_IRAM_SIZE));
+    return false;
+  }
+
+  DSP::DSPInitOptions opts;
+  const std::string rom_path = File::GetSysDirectory() + GC_SYS_DIR DIR_SEP;
+  LoadBenchmarkRom(opts.irom_contents.data(), rom_path + DSP_IROM, DSP::DSP_IROM_BYTE_SIZE);
+  LoadBenchmarkRom(opts.coef_contents.data(), rom_path + DSP_COEF, DSP::DSP_COEF_BYTE_SIZE);
+  opts.core_type = DSP::DSPInitOptions::CORE_INTERPRETER;
+#ifdef _M_X86
+  if (!interpreter)
+    opts.core_type = DSP::DSPInitOptions::CORE_JIT;
+#endif
+
+  if (!DSP::DSPCore_Init(opts))
+    return false;
+
+  Common::UnWriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+  std::copy(code.begin(), code.end(), DSP::g_dsp.iram);
+  Common::WriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+  if (DSP::g_dsp_jit)
+    DSP::g_dsp_jit->ClearIRAM();
+
+  DSP::DSPCore_Reset();
+  DSP::g_dsp.pc = 0;
+  DSP::g_dsp.cr &= ~DSP::CR_HALT;
+
+  const u64 total_cycles = DSP_CLOCK_RATE * ms / 1000;
+  const auto start = std::chrono::steady_clock::now();
+  for (u64 done = 0; done < total_cycles;)
+  {
+    const int cycles = static_cast<int>(std::min<u64>(total_cycles - done, 0x1000));
+    DSP::DSPCore_RunCycles(cycles);
+    done += cycles;
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("%s: %" PRIu64 " cycles in %.3f s, %.1f million cycles per second (%.1f%% of real "
+         "hardware)\n",
+         DSP::g_dsp_jit ? "JIT" : "Interpreter", total_cycles, seconds,
+         total_cycles / seconds / 1000000, total_cycles / seconds / DSP_CLOCK_RATE * 100);
+
+  DSP::DSPCore_Shutdown();
+  return true;
+}
+
 // Usage:
 // Disassemble a file:
 //   dsptool -d -o asdf.txt asdf.bin
@@ -123,6 +210,8 @@ static void CodesToHeader(const std::vector<u16>* codes, const std::vector<std::
 //   dsptool [-f] -h asdf.h asdf.txt
 // Print results from DSPSpy register dump
 //   dsptool -p dsp_dump0.bin
+// Run a ucode dump for 1000 ms of emulated time and report the speed of the JIT
+//   dsptool -b 1000 DSP_UC_12345678.bin
 int main(int argc, const char* argv[])
 {
   if (argc == 1 || (argc == 2 && (!strcmp(argv[1], "--help") || (!strcmp(argv[1], "-?")))))
@@ -141,6 +230,9 @@ int main(int argc, const char* argv[])
     printf("-pm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values)\n");
     printf("-psm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values/disable "
            "SR output)\n");
+    printf("-b <MS> <UCODE DUMP>: Run a ucode dump with the JIT for MS milliseconds of DSP time and "
+           "print the speed\n");
+    printf("-bi <MS> <UCODE DUMP>: Same as -b, using the interpreter\n");
 
     return 0;
   }
@@ -150,7 +242,9 @@ int main(int argc, const char* argv[])
   std::string output_name;
 
   bool disassemble = false, compare = false, multiple = false, outputSize = false, force = false,
-       print_results = false, print_results_prodhack = false, print_results_srhack = false;
+       print_results = false, print_results_prodhack = false, print_results_srhack = false,
+       benchmark = false, benchmark_interpreter = false;
+  u32 benchmark_ms = 0;
   for (int i = 1; i < argc; i++)
   {
     if (!strcmp(argv[i], "-d"))
@@ -185,6 +279,12 @@ int main(int argc, const char* argv[])
       print_results_srhack = true;
       print_results_prodhack = true;
     }
+    else if (!strcmp(argv[i], "-b") || !strcmp(argv[i], "-bi"))
+    {
+      benchmark = true;
+      benchmark_interpreter = !strcmp(argv[i], "-bi");
+      benchmark_ms = i + 1 < argc ? static_cast<u32>(strtoul(argv[++i], nullptr, 10)) : 0;
+    }
     else
     {
       if (!input_name.empty())
@@ -221,6 +321,16 @@ int main(int argc, const char* argv[])
     return 0;
   }
 
+  if (benchmark)
+  {
+    if (input_name.empty() || benchmark_ms == 0)
+    {
+      printf("Benchmark: Must specify a duration and a ucode dump.\n");
+      return 1;
+    }
+    return RunBenchmark(input_name, benchmark_ms, benchmark_interpreter) ? 0 : 1;
+  }
+
   if (print_results)
   {
     std::string dumpfile, results;
@@ -0,0 +1,64 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <mbedtls/aes.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+
+namespace
+{
+constexpr std::array<u8, 16> KEY = {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7,
+                                     0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c}};
+constexpr std::array<u8, 16> IV = {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+                                    0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f}};
+
+std::vector<u8> MakeCipherText(size_t size)
+{
+  std::vector<u8> plain(size);
+  for (size_t i = 0; i < size; ++i)
+    plain[i] = static_cast<u8>(i * 7 + (i >> 8));
+
+  std::array<u8, 16> iv = IV;
+  return Common::AES::Encrypt(KEY.data(), iv.data(), plain.data(), plain.size());
+}
+}  // namespace
+
+TEST(AES, DecryptCBCMatchesMbedtls)
+{
+  mbedtls_aes_context ctx;
+  mbedtls_aes_setkey_dec(&ctx, KEY.data(), 128);
+
+  // Covers both the batched blocks and the leftover single blocks.
+  for (size_t size : {16, 48, 128, 144, 0x7C00})
+  {
+    const std::vector<u8> cipher = MakeCipherText(size);
+
+    std::array<u8, 16> iv = IV;
+    std::vector<u8> expected(size);
+    mbedtls_aes_crypt_cbc(&ctx, MBEDTLS_AES_DECRYPT, size, iv.data(), cipher.data(),
+                          expected.data());
+
+    std::vector<u8> actual(size);
+    Common::AES::DecryptCBC(&ctx, IV.data(), cipher.data(), actual.data(), size);
+    EXPECT_EQ(expected, actual) << "size " << size;
+  }
+}
+
+TEST(AES, DecryptCBCInPlace)
+{
+  mbedtls_aes_context ctx;
+  mbedtls_aes_setkey_dec(&ctx, KEY.data(), 128);
+
+  std::vector<u8> buffer = MakeCipherText(0x400);
+  std::vector<u8> expected(buffer.size());
+  Common::AES::DecryptCBC(&ctx, IV.data(), buffer.data(), expected.data(), buffer.size());
+
+  Common::AES::DecryptCBC(&ctx, IV.data(), buffer.data(), buffer.data(), buffer.size());
+  EXPECT_EQ(expected, buffer);
+}
@@ -0,0 +1,129 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+std::vector<u8> RandomBytes(size_t size)
+{
+  // The output of mt19937 is fully specified, unlike that of the distributions.
+  std::mt19937 rng(1234);
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+    byte = static_cast<u8>(rng() >> 24);
+  return data;
+}
+
+// Restores the default hash function once a test is done with it.
+class ScopedHashFunction
+{
+public:
+  explicit ScopedHashFunction(HashFunction function) { m_supported = SetHash64Function(function); }
+  ~ScopedHashFunction() { SetHash64Function(); }
+  bool IsSupported() const { return m_supported; }
+private:
+  bool m_supported;
+};
+
+u64 HashWith(HashFunction function, const u8* src, u32 len, u32 samples)
+{
+  ScopedHashFunction scoped(function);
+  return GetHash64(src, len, samples);
+}
+}
+
+// Custom textures are named after these hashes, so they must never change.
+TEST(Hash, HiresTextureHashIsStable)
+{
+  const std::vector<u8> data = RandomBytes(4099);
+  EXPECT_EQ(0x481c600c2b236a79ULL, GetHashHiresTexture(data.data(), 4099));
+  EXPECT_EQ(0x0817583081d8e1c3ULL, GetHashHiresTexture(data.data(), 4096, 64));
+  EXPECT_EQ(0xce9387a1017d697cULL, GetHashHiresTexture(data.data(), 13));
+}
+
+TEST(Hash, StripedMatchesGeneric)
+{
+  const std::vector<u8> data = RandomBytes(0x10000 + 63);
+  const u32 lengths[] = {0, 1, 7, 8, 63, 64, 65, 127, 128, 1024, 1087, 4096, 0x10000 + 63};
+  const u32 samples[] = {0, 1, 8, 64, 128, 100000};
+
+  // Also covers the SSE2 version where AVX2 is available.
+  const bool has_avx2 = cpu_info.bAVX2;
+  for (bool avx2 : {false, has_avx2})
+  {
+    cpu_info.bAVX2 = avx2;
+    for (u32 len : lengths)
+    {
+      for (u32 sample_count : samples)
+      {
+        EXPECT_EQ(HashWith(HashFunction::StripedGeneric, data.data(), len, sample_count),
+                  HashWith(HashFunction::Striped, data.data(), len, sample_count))
+            << "length " << len << ", samples " << sample_count << ", AVX2 " << avx2;
+      }
+    }
+  }
+  cpu_info.bAVX2 = has_avx2;
+}
+
+TEST(Hash, StripedNoticesEveryByte)
+{
+  ScopedHashFunction scoped(HashFunction::Striped);
+  std::vector<u8> data = RandomBytes(1000);
+  const u64 hash = GetHash64(data.data(), 1000, 0);
+
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] ^= 0x10;
+    EXPECT_NE(hash, GetHash64(data.data(), 1000, 0)) << "byte " << i;
+    data[i] ^= 0x10;
+  }
+  EXPECT_NE(hash, GetHash64(data.data(), 999, 0));
+}
+
+// Throughput per hash function and size, not a test. Run it with
+// --gtest_also_run_disabled_tests.
+TEST(Hash, DISABLED_Benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const struct
+  {
+    HashFunction function;
+    const char* name;
+  } functions[] = {{HashFunction::MurmurHash3, "MurmurHash3"},
+                   {HashFunction::CRC32, "CRC32"},
+                   {HashFunction::Striped, "Striped"},
+                   {HashFunction::StripedGeneric, "Striped (generic)"}};
+  const u32 sizes[] = {1024, 32 * 1024, 1024 * 1024};
+  const u32 total_bytes = 256 * 1024 * 1024;
+
+  const std::vector<u8> data = RandomBytes(sizes[2]);
+  for (const auto& function : functions)
+  {
+    ScopedHashFunction scoped(function.function);
+    if (!scoped.IsSupported())
+      continue;
+
+    for (u32 size : sizes)
+    {
+      u64 sink = 0;
+      const Clock::time_point start = Clock::now();
+      for (u32 i = 0; i < total_bytes / size; ++i)
+        sink += GetHash64(data.data(), size, 0);
+      const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      std::printf("[ BENCH    ] %s, %u bytes: %.2f GB/s (%llx)\n", function.name, size,
+                  total_bytes / seconds / 1e9, static_cast<unsigned long long>(sink));
+    }
+  }
+}
@@ -0,0 +1,43 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/WorkerPool.h"
+
+TEST(WorkerPool, PushRunsEveryJob)
+{
+  Common::WorkerPool pool("WorkerPoolTest", 4);
+  std::atomic<int> counter{0};
+
+  for (int i = 0; i < 1000; ++i)
+    pool.Push([&counter] { ++counter; });
+  pool.WaitForIdle();
+
+  EXPECT_EQ(1000, counter);
+}
+
+TEST(WorkerPool, ParallelForVisitsEveryIndexOnce)
+{
+  Common::WorkerPool pool("WorkerPoolTest", 4);
+  std::vector<std::atomic<int>> visits(10000);
+
+  pool.ParallelFor(visits.size(), [&visits](size_t i) { ++visits[i]; });
+
+  for (const std::atomic<int>& count : visits)
+    EXPECT_EQ(1, count);
+}
+
+TEST(WorkerPool, NestedParallelFor)
+{
+  Common::WorkerPool pool("WorkerPoolTest", 2);
+  std::atomic<int> counter{0};
+
+  pool.ParallelFor(8, [&](size_t) { pool.ParallelFor(8, [&](size_t) { ++counter; }); });
+
+  EXPECT_EQ(64, counter);
+}
@@ -0,0 +1,147 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+// The mixing functions have SIMD paths for 8 samples at a time, which must give the same results
+// as the plain loops below, including for -32768 samples, volumes >= 0x8000 and wrapping ramps.
+namespace
+{
+void ReferenceMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+  u16& volume = pvol[0];
+  const u16 volume_delta = ramp ? pvol[1] : 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    sample = MathUtil::Clamp((s32)sample, -32767, 32767);
+
+    out[i] += (s16)sample;
+    volume += volume_delta;
+
+    *dpop = (s16)sample;
+  }
+}
+
+void ReferenceApplyVolumeEnvelope(s16* samples, u32 count, DSP::HLE::PBVolumeEnvelope& env)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    samples[i] = MathUtil::Clamp(((s32)samples[i] * env.cur_volume) >> 15, -32767, 32767);
+    env.cur_volume += env.cur_volume_delta;
+  }
+}
+
+void CheckMixAdd(const std::vector<s16>& input, u16 volume, u16 volume_delta, bool ramp)
+{
+  const u32 count = static_cast<u32>(input.size());
+  std::vector<int> expected_out(count, 1000);
+  std::vector<int> out(count, 1000);
+  std::array<u16, 2> expected_vol{{volume, volume_delta}};
+  std::array<u16, 2> vol{{volume, volume_delta}};
+  s16 expected_dpop = 123;
+  s16 dpop = 123;
+
+  ReferenceMixAdd(expected_out.data(), input.data(), count, expected_vol.data(), &expected_dpop,
+                  ramp);
+  DSP::HLE::MixAdd(out.data(), input.data(), count, vol.data(), &dpop, ramp);
+
+  ASSERT_EQ(expected_out, out) << "volume " << volume << " delta " << volume_delta;
+  EXPECT_EQ(expected_vol, vol);
+  EXPECT_EQ(expected_dpop, dpop);
+}
+
+void CheckApplyVolumeEnvelope(const std::vector<s16>& input, u16 volume, s16 volume_delta)
+{
+  const u32 count = static_cast<u32>(input.size());
+  std::vector<s16> expected_samples = input;
+  std::vector<s16> samples = input;
+  DSP::HLE::PBVolumeEnvelope expected_env{volume, volume_delta};
+  DSP::HLE::PBVolumeEnvelope env{volume, volume_delta};
+
+  ReferenceApplyVolumeEnvelope(expected_samples.data(), count, expected_env);
+  DSP::HLE::ApplyVolumeEnvelope(samples.data(), count, env);
+
+  ASSERT_EQ(expected_samples, samples) << "volume " << volume << " delta " << volume_delta;
+  EXPECT_EQ(expected_env.cur_volume, env.cur_volume);
+}
+}
+
+TEST(AXVoice, MixAddExtremes)
+{
+  for (s16 value : {-32768, -32767, -1, 0, 1, 32767})
+  {
+    const std::vector<s16> input(35, value);
+    for (u16 volume : {0x0000, 0x0001, 0x7FFF, 0x8000, 0x8001, 0xFFFF})
+    {
+      CheckMixAdd(input, volume, 0, false);
+      // Ramps which wrap around within the buffer, in both directions.
+      CheckMixAdd(input, volume, 0x0800, true);
+      CheckMixAdd(input, volume, 0xF800, true);
+      CheckMixAdd(input, volume, 0x7FFF, true);
+    }
+  }
+}
+
+TEST(AXVoice, MixAddRandom)
+{
+  std::mt19937 rng(0x41585643);
+  std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+  std::uniform_int_distribution<int> u16_dist(0, 0xFFFF);
+  std::uniform_int_distribution<u32> count_dist(0, 100);
+
+  for (int iteration = 0; iteration < 2000; ++iteration)
+  {
+    std::vector<s16> input(count_dist(rng));
+    for (s16& sample : input)
+      sample = static_cast<s16>(sample_dist(rng));
+
+    CheckMixAdd(input, static_cast<u16>(u16_dist(rng)), static_cast<u16>(u16_dist(rng)),
+                iteration % 4 != 0);
+  }
+}
+
+TEST(AXVoice, ApplyVolumeEnvelopeExtremes)
+{
+  for (s16 value : {-32768, -32767, -1, 0, 1, 32767})
+  {
+    const std::vector<s16> input(35, value);
+    for (u16 volume : {0x0000, 0x0001, 0x7FFF, 0x8000, 0x8001, 0xFFFF})
+    {
+      for (s16 delta : {0, 1, -1, 0x0800, -0x0800, 0x7FFF, -0x8000})
+        CheckApplyVolumeEnvelope(input, volume, delta);
+    }
+  }
+}
+
+TEST(AXVoice, ApplyVolumeEnvelopeRandom)
+{
+  std::mt19937 rng(0x454E5645);
+  std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+  std::uniform_int_distribution<int> u16_dist(0, 0xFFFF);
+  std::uniform_int_distribution<u32> count_dist(0, 100);
+
+  for (int iteration = 0; iteration < 2000; ++iteration)
+  {
+    std::vector<s16> input(count_dist(rng));
+    for (s16& sample : input)
+      sample = static_cast<s16>(sample_dist(rng));
+
+    CheckApplyVolumeEnvelope(input, static_cast<u16>(u16_dist(rng)),
+                             static_cast<s16>(u16_dist(rng)));
+  }
+}
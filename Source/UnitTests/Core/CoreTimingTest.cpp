@@ -4,8 +4,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -345,3 +351,124 @@ TEST(CoreTiming, Overclocking)
   SConfig::GetInstance().m_OCFactor = 1.0;
   AdvanceAndCheck(4, MAX_SLICE_LENGTH);
 }
+
+namespace ManyEventsTest
+{
+static std::vector<u64> s_order;
+
+static void RecordCallback(u64 userdata, s64 lateness)
+{
+  s_order.push_back(userdata);
+}
+}
+
+TEST(CoreTiming, ManyEventsWithRemoval)
+{
+  using namespace ManyEventsTest;
+
+  ScopeInit guard;
+
+  std::array<CoreTiming::EventType*, 4> types;
+  for (size_t i = 0; i < types.size(); ++i)
+    types[i] = CoreTiming::RegisterEvent("callback" + std::to_string(i), RecordCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  // Lots of events sharing the same times, so that the FIFO order matters as well.
+  std::vector<std::pair<s64, u64>> expected;
+  for (u64 i = 0; i < 400; ++i)
+  {
+    const s64 time = static_cast<s64>((i * 7919) % 50) * 100;
+    const size_t type = i % types.size();
+    CoreTiming::ScheduleEvent(time, types[type], i);
+    if (type != 2)
+      expected.emplace_back(time, i);
+  }
+  CoreTiming::RemoveEvent(types[2]);
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  s_order.clear();
+  PowerPC::ppcState.downcount = -10000;
+  CoreTiming::Advance();
+
+  ASSERT_EQ(expected.size(), s_order.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    EXPECT_EQ(expected[i].second, s_order[i]);
+}
+
+// Not really tests, but these give an idea of how expensive the scheduler is for the patterns the
+// hardware emulation uses. They are disabled, run them with --gtest_also_run_disabled_tests.
+namespace BenchmarkTest
+{
+using Clock = std::chrono::steady_clock;
+
+static void NopCallback(u64 userdata, s64 lateness)
+{
+}
+
+static void PrintResult(const char* name, Clock::time_point start, size_t iterations)
+{
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  std::printf("[ BENCH    ] %s: %.1f ns/op\n", name, static_cast<double>(ns) / iterations);
+}
+}
+
+TEST(CoreTiming, DISABLED_BenchmarkScheduleAndRemove)
+{
+  using namespace BenchmarkTest;
+
+  ScopeInit guard;
+
+  std::array<CoreTiming::EventType*, 32> types;
+  for (size_t i = 0; i < types.size(); ++i)
+    types[i] = CoreTiming::RegisterEvent("bench" + std::to_string(i), NopCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  // Some long-lived events in the background, like the VI and audio timers.
+  for (size_t i = 0; i < types.size() / 2; ++i)
+    CoreTiming::ScheduleEvent(1000000 + i * 1000, types[i]);
+
+  // Reschedule an event over and over, the way SI and DSP interrupts are.
+  constexpr size_t ITERATIONS = 1000000;
+  const Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < ITERATIONS; ++i)
+  {
+    CoreTiming::EventType* type = types[types.size() / 2 + i % (types.size() / 2)];
+    CoreTiming::RemoveEvent(type);
+    CoreTiming::ScheduleEvent(500 + i % 1000, type);
+  }
+  PrintResult("RemoveEvent + ScheduleEvent", start, ITERATIONS);
+}
+
+TEST(CoreTiming, DISABLED_BenchmarkAdvance)
+{
+  using namespace BenchmarkTest;
+
+  ScopeInit guard;
+
+  std::array<CoreTiming::EventType*, 32> types;
+  for (size_t i = 0; i < types.size(); ++i)
+    types[i] = CoreTiming::RegisterEvent("bench" + std::to_string(i), NopCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  // Keep the queue at a constant size, running one event per slice.
+  for (size_t i = 0; i < types.size(); ++i)
+    CoreTiming::ScheduleEvent(100 * (i + 1), types[i]);
+
+  constexpr size_t ITERATIONS = 1000000;
+  const Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < ITERATIONS; ++i)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+    CoreTiming::ScheduleEvent(100 * types.size(), types[i % types.size()]);
+  }
+  PrintResult("Advance + ScheduleEvent", start, ITERATIONS);
+}
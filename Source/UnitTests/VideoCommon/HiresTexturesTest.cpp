@@ -0,0 +1,281 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTextures.h"
+#include "png.h"
+
+// Packs a few PNG textures into a .dtp archive and loads them back, then checks that archives
+// with offsets or sizes pointing out of the file are rejected.
+class HiresTextureTest : public ::testing::Test
+{
+protected:
+  static constexpr const char* GAME_ID = "GTEST1";
+  static constexpr const char* TEXTURE_NAME = "tex1_8x4_0123456789abcdef_5";
+  static constexpr const char* OTHER_TEXTURE_NAME = "tex1_16x16_fedcba9876543210_0";
+
+  // Offsets into the archive format, as written by HiresTexture::PackArchive.
+  static constexpr size_t HEADER_NUM_ENTRIES = 8;
+  static constexpr size_t HEADER_NAMES_SIZE = 12;
+  static constexpr size_t HEADER_ENTRIES_OFFSET = 16;
+  static constexpr size_t HEADER_NAMES_OFFSET = 24;
+  static constexpr size_t HEADER_SIZE = 32;
+  static constexpr size_t ENTRY_SIZE = 24;
+  static constexpr size_t ENTRY_NAME_OFFSET = 8;
+  static constexpr size_t ENTRY_TEXTURE_OFFSET = 16;
+  static constexpr size_t TEXTURE_NUM_LEVELS = 4;
+  static constexpr size_t TEXTURE_SIZE = 8;
+  static constexpr size_t LEVEL_DATA_OFFSET = 16;
+  static constexpr size_t LEVEL_DATA_SIZE = 24;
+
+  void SetUp() override
+  {
+    m_old_path = File::GetUserPath(D_HIRESTEXTURES_IDX);
+    m_user_path = File::CreateTempDir();
+    ASSERT_FALSE(m_user_path.empty());
+    File::SetUserPath(D_HIRESTEXTURES_IDX, m_user_path + DIR_SEP);
+
+    const std::string texture_directory = m_user_path + DIR_SEP + GAME_ID + DIR_SEP;
+    ASSERT_TRUE(File::CreateFullPath(texture_directory));
+    m_level0 = WritePNG(texture_directory + TEXTURE_NAME + ".png", 8, 4, 1);
+    m_level1 = WritePNG(texture_directory + TEXTURE_NAME + "_mip1.png", 4, 2, 2);
+    m_other = WritePNG(texture_directory + OTHER_TEXTURE_NAME + ".png", 16, 16, 3);
+
+    ASSERT_TRUE(HiresTexture::PackArchive(GAME_ID));
+    m_archive_path = m_user_path + DIR_SEP + GAME_ID + ".dtp";
+    ASSERT_TRUE(File::ReadFileToString(m_archive_path, m_archive));
+  }
+
+  void TearDown() override
+  {
+    Close();
+    File::DeleteDirRecursively(m_user_path);
+    File::SetUserPath(D_HIRESTEXTURES_IDX, m_old_path);
+  }
+
+  static std::vector<u8> WritePNG(const std::string& path, u32 width, u32 height, u8 seed)
+  {
+    std::vector<u8> pixels(width * height * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+      pixels[i] = static_cast<u8>(i * 7 + seed * 31);
+
+    png_image image = {};
+    image.version = PNG_IMAGE_VERSION;
+    image.width = width;
+    image.height = height;
+    image.format = PNG_FORMAT_RGBA;
+    EXPECT_TRUE(png_image_write_to_file(&image, path.c_str(), 0, pixels.data(), 0, nullptr));
+    return pixels;
+  }
+
+  template <typename T>
+  T Read(size_t offset) const
+  {
+    T value;
+    std::memcpy(&value, &m_archive[offset], sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  void Write(size_t offset, T value)
+  {
+    std::memcpy(&m_archive[offset], &value, sizeof(T));
+  }
+
+  // Offset of the texture data of the first archive entry.
+  size_t FirstTextureOffset() const
+  {
+    const u64 entries_offset = Read<u64>(HEADER_ENTRIES_OFFSET);
+    return static_cast<size_t>(Read<u64>(entries_offset + ENTRY_TEXTURE_OFFSET));
+  }
+
+  bool Open() const { return HiresTexture::OpenArchive(m_archive_path); }
+  static void Close() { HiresTexture::CloseArchive(); }
+
+  // Writes the modified archive back and opens it.
+  bool Reopen()
+  {
+    Close();
+    return File::WriteStringToFile(m_archive, m_archive_path) && Open();
+  }
+
+  // Loads whichever texture the first archive entry holds.
+  std::unique_ptr<HiresTexture> LoadFirst() const
+  {
+    const u64 entries_offset = Read<u64>(HEADER_ENTRIES_OFFSET);
+    const u64 names_offset = Read<u64>(HEADER_NAMES_OFFSET);
+    const u32 name_offset = Read<u32>(entries_offset + ENTRY_NAME_OFFSET);
+    const u32 name_size = Read<u32>(entries_offset + ENTRY_NAME_OFFSET + 4);
+    return HiresTexture::LoadFromArchive(m_archive.substr(names_offset + name_offset, name_size));
+  }
+
+  static std::unique_ptr<HiresTexture> Load(const std::string& name)
+  {
+    return HiresTexture::LoadFromArchive(name);
+  }
+
+  std::string m_old_path;
+  std::string m_user_path;
+  std::string m_archive_path;
+  std::string m_archive;
+  std::vector<u8> m_level0;
+  std::vector<u8> m_level1;
+  std::vector<u8> m_other;
+};
+
+static void CheckLevel(const HiresTexture::Level& level, u32 width, u32 height,
+                       const std::vector<u8>& pixels)
+{
+  EXPECT_EQ(HostTextureFormat::RGBA8, level.format);
+  EXPECT_EQ(width, level.width);
+  EXPECT_EQ(height, level.height);
+  EXPECT_EQ(width, level.row_length);
+  ASSERT_EQ(pixels.size(), level.data_size);
+  EXPECT_EQ(0, std::memcmp(pixels.data(), level.data.get(), pixels.size()));
+  // Levels are used straight from the mapping, which keeps them aligned.
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(level.data.get()) % 64);
+}
+
+TEST_F(HiresTextureTest, RoundTrip)
+{
+  ASSERT_TRUE(Open());
+  EXPECT_EQ(2u, Read<u32>(HEADER_NUM_ENTRIES));
+
+  std::unique_ptr<HiresTexture> texture = Load(TEXTURE_NAME);
+  ASSERT_NE(nullptr, texture);
+  ASSERT_EQ(2u, texture->m_levels.size());
+  CheckLevel(texture->m_levels[0], 8, 4, m_level0);
+  CheckLevel(texture->m_levels[1], 4, 2, m_level1);
+
+  std::unique_ptr<HiresTexture> other = Load(OTHER_TEXTURE_NAME);
+  ASSERT_NE(nullptr, other);
+  ASSERT_EQ(1u, other->m_levels.size());
+  CheckLevel(other->m_levels[0], 16, 16, m_other);
+
+  // Mip levels are part of their texture, not entries of their own.
+  EXPECT_EQ(nullptr, Load(std::string(TEXTURE_NAME) + "_mip1"));
+  EXPECT_EQ(nullptr, Load("tex1_8x4_0123456789abcdef_6"));
+
+  // The levels keep the archive mapped.
+  Close();
+  CheckLevel(texture->m_levels[0], 8, 4, m_level0);
+}
+
+TEST_F(HiresTextureTest, RejectsInvalidHeader)
+{
+  const std::string archive = m_archive;
+
+  m_archive.resize(HEADER_SIZE - 1);
+  EXPECT_FALSE(Reopen());
+
+  m_archive = archive;
+  Write<u32>(0, 0);
+  EXPECT_FALSE(Reopen()) << "magic";
+
+  m_archive = archive;
+  Write<u32>(4, 2);
+  EXPECT_FALSE(Reopen()) << "version";
+
+  m_archive = archive;
+  Write<u64>(HEADER_ENTRIES_OFFSET, m_archive.size() + ENTRY_SIZE);
+  EXPECT_FALSE(Reopen()) << "entries offset";
+
+  m_archive = archive;
+  Write<u64>(HEADER_ENTRIES_OFFSET, Read<u64>(HEADER_ENTRIES_OFFSET) + 1);
+  EXPECT_FALSE(Reopen()) << "misaligned entries";
+
+  m_archive = archive;
+  Write<u32>(HEADER_NUM_ENTRIES, 3);
+  EXPECT_FALSE(Reopen()) << "entries past the end";
+
+  m_archive = archive;
+  Write<u32>(HEADER_NAMES_SIZE, static_cast<u32>(m_archive.size()));
+  EXPECT_FALSE(Reopen()) << "names past the end";
+
+  m_archive = archive;
+  const u64 entries_offset = Read<u64>(HEADER_ENTRIES_OFFSET);
+  Write<u32>(entries_offset + ENTRY_NAME_OFFSET, Read<u32>(HEADER_NAMES_SIZE));
+  EXPECT_FALSE(Reopen()) << "name past the names";
+
+  m_archive = archive;
+  EXPECT_TRUE(Reopen());
+}
+
+TEST_F(HiresTextureTest, RejectsTextureOutOfBounds)
+{
+  const std::string archive = m_archive;
+  const u64 entries_offset = Read<u64>(HEADER_ENTRIES_OFFSET);
+  const size_t texture_offset = FirstTextureOffset();
+
+  Write<u64>(entries_offset + ENTRY_TEXTURE_OFFSET, m_archive.size() - TEXTURE_SIZE + 1);
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "texture offset";
+
+  m_archive = archive;
+  Write<u64>(entries_offset + ENTRY_TEXTURE_OFFSET, ~u64{0});
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "wrapping texture offset";
+
+  m_archive = archive;
+  Write<u32>(texture_offset, 0xFFFF);
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "format";
+
+  m_archive = archive;
+  Write<u32>(texture_offset + TEXTURE_NUM_LEVELS, 0);
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "no levels";
+
+  m_archive = archive;
+  Write<u32>(texture_offset + TEXTURE_NUM_LEVELS, static_cast<u32>(m_archive.size()));
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "levels past the end";
+
+  m_archive = archive;
+  Write<u64>(texture_offset + TEXTURE_SIZE + LEVEL_DATA_OFFSET, m_archive.size() + 1);
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "level data offset";
+
+  m_archive = archive;
+  const u64 data_offset = Read<u64>(texture_offset + TEXTURE_SIZE + LEVEL_DATA_OFFSET);
+  Write<u64>(texture_offset + TEXTURE_SIZE + LEVEL_DATA_SIZE, m_archive.size() - data_offset + 1);
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "level data size";
+
+  m_archive = archive;
+  Write<u64>(texture_offset + TEXTURE_SIZE + LEVEL_DATA_SIZE, ~u64{0});
+  ASSERT_TRUE(Reopen());
+  EXPECT_EQ(nullptr, LoadFirst()) << "wrapping level data size";
+
+  m_archive = archive;
+  ASSERT_TRUE(Reopen());
+  EXPECT_NE(nullptr, LoadFirst());
+}
+
+TEST_F(HiresTextureTest, RepackWhileMapped)
+{
+  ASSERT_TRUE(Open());
+  std::unique_ptr<HiresTexture> texture = Load(TEXTURE_NAME);
+  ASSERT_NE(nullptr, texture);
+
+  // The new archive replaces the old file instead of truncating the mapped one.
+  ASSERT_TRUE(HiresTexture::PackArchive(GAME_ID));
+  EXPECT_FALSE(File::Exists(m_archive_path + ".tmp"));
+  CheckLevel(texture->m_levels[0], 8, 4, m_level0);
+
+  ASSERT_TRUE(Open());
+  std::unique_ptr<HiresTexture> repacked = Load(TEXTURE_NAME);
+  ASSERT_NE(nullptr, repacked);
+  CheckLevel(repacked->m_levels[0], 8, 4, m_level0);
+}
@@ -0,0 +1,365 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+
+// The TEV combiners and EFB blending have SIMD paths, which must give the same results as the
+// scalar code for every input and combiner setting.
+class TevTest : public ::testing::Test
+{
+protected:
+  using InputRegType = Tev::InputRegType;
+
+  static void DrawRegular(Tev& tev, TevStageCombiner::ColorCombiner& cc,
+                          TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+  {
+    tev.DrawRegular(cc, ac, inputs);
+  }
+
+  static void DrawScalar(Tev& tev, TevStageCombiner::ColorCombiner& cc,
+                         TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+  {
+    tev.DrawColorRegular(cc, inputs);
+    tev.ClampColor(cc);
+    tev.DrawAlphaRegular(ac, inputs);
+    tev.ClampAlpha(ac);
+  }
+
+  static void CheckRegular(TevStageCombiner::ColorCombiner cc, TevStageCombiner::AlphaCombiner ac,
+                           const InputRegType inputs[4])
+  {
+    Tev expected;
+    Tev actual;
+    expected.Init();
+    actual.Init();
+    std::memset(expected.Reg, 0x55, sizeof(expected.Reg));
+    std::memset(actual.Reg, 0x55, sizeof(actual.Reg));
+
+    DrawScalar(expected, cc, ac, inputs);
+    DrawRegular(actual, cc, ac, inputs);
+
+    for (int reg = 0; reg < 4; ++reg)
+    {
+      for (int comp = 0; comp < 4; ++comp)
+      {
+        ASSERT_EQ(expected.Reg[reg][comp], actual.Reg[reg][comp])
+            << "color combiner " << std::hex << cc.hex << " alpha combiner " << ac.hex
+            << " reg " << reg << " component " << comp;
+      }
+    }
+  }
+};
+
+TEST_F(TevTest, RegularExtremes)
+{
+  InputRegType inputs[4];
+  for (u32 mode = 0; mode < 64; ++mode)
+  {
+    TevStageCombiner::ColorCombiner cc;
+    TevStageCombiner::AlphaCombiner ac;
+    cc.hex = 0;
+    ac.hex = 0;
+    cc.shift = ac.shift = mode & 3;
+    cc.op = ac.op = (mode >> 2) & 1;
+    cc.clamp = ac.clamp = (mode >> 3) & 1;
+    // Compare mode (bias 3) never reaches the regular combiners.
+    cc.bias = ac.bias = (mode >> 4) % 3;
+    cc.dest = 1;
+    ac.dest = 2;
+
+    for (u32 a : {0, 1, 127, 128, 255})
+    {
+      for (u32 c : {0, 1, 127, 128, 255})
+      {
+        for (s32 d : {-1024, -1, 0, 1, 255, 1023})
+        {
+          for (InputRegType& input : inputs)
+          {
+            input.a = a;
+            input.b = 255 - a;
+            input.c = c;
+            input.d = d;
+          }
+          CheckRegular(cc, ac, inputs);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TevTest, RegularRandom)
+{
+  std::mt19937 rng(0x54455653);
+  std::uniform_int_distribution<u32> u8_dist(0, 255);
+  std::uniform_int_distribution<s32> d_dist(-1024, 1023);
+  std::uniform_int_distribution<u32> hex_dist;
+
+  for (int iteration = 0; iteration < 100000; ++iteration)
+  {
+    TevStageCombiner::ColorCombiner cc;
+    TevStageCombiner::AlphaCombiner ac;
+    cc.hex = hex_dist(rng);
+    ac.hex = hex_dist(rng);
+    if (cc.bias == 3)
+      cc.bias = 0;
+    if (ac.bias == 3)
+      ac.bias = 0;
+
+    InputRegType inputs[4];
+    for (InputRegType& input : inputs)
+    {
+      input.a = u8_dist(rng);
+      input.b = u8_dist(rng);
+      input.c = u8_dist(rng);
+      input.d = d_dist(rng);
+    }
+    CheckRegular(cc, ac, inputs);
+  }
+}
+
+namespace
+{
+u8 ReferenceFactor(const u8* src, const u8* dst, int comp, BlendMode::BlendFactor mode,
+                   bool source)
+{
+  switch (mode)
+  {
+  case BlendMode::ZERO:
+    return 0;
+  case BlendMode::ONE:
+    return 0xff;
+  case BlendMode::SRCCLR:
+    return source ? dst[comp] : src[comp];
+  case BlendMode::INVSRCCLR:
+    return 0xff - (source ? dst[comp] : src[comp]);
+  case BlendMode::SRCALPHA:
+    return src[EfbInterface::ALP_C];
+  case BlendMode::INVSRCALPHA:
+    return 0xff - src[EfbInterface::ALP_C];
+  case BlendMode::DSTALPHA:
+    return dst[EfbInterface::ALP_C];
+  case BlendMode::INVDSTALPHA:
+    return 0xff - dst[EfbInterface::ALP_C];
+  }
+  return 0;
+}
+
+void ReferenceBlend(const u8* src, u8* dst)
+{
+  u8 result[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    if (bpmem.blendmode.subtract)
+    {
+      const int c = dst[i] - src[i];
+      result[i] = c < 0 ? 0 : c;
+      continue;
+    }
+
+    // add MSB of factors to make their range 0 -> 256
+    u32 sf = ReferenceFactor(src, dst, i, bpmem.blendmode.srcfactor, true);
+    sf += sf >> 7;
+    u32 df = ReferenceFactor(src, dst, i, bpmem.blendmode.dstfactor, false);
+    df += df >> 7;
+
+    const u32 color = (src[i] * sf + dst[i] * df) >> 8;
+    result[i] = color > 255 ? 255 : color;
+  }
+  std::memcpy(dst, result, sizeof(result));
+}
+
+// Blends into pixel (0, 0), and stores the reference result through (1, 0) so that both go
+// through the same conversion to the pixel format.
+void CheckBlend(u8 src[4], u8 dst[4])
+{
+  EfbInterface::SetColor(0, 0, dst);
+  u32 stored = EfbInterface::GetColor(0, 0);
+  u8 expected[4];
+  std::memcpy(expected, &stored, sizeof(expected));
+  ReferenceBlend(src, expected);
+  EfbInterface::SetColor(1, 0, expected);
+
+  EfbInterface::BlendTev(0, 0, src);
+  ASSERT_EQ(EfbInterface::GetColor(1, 0), EfbInterface::GetColor(0, 0))
+      << "blend mode " << std::hex << bpmem.blendmode.hex << " source " << *(u32*)src
+      << " destination " << *(u32*)dst;
+}
+}
+
+TEST(EfbInterface, BlendRandom)
+{
+  std::mt19937 rng(0x45464249);
+  std::uniform_int_distribution<u32> u8_dist(0, 255);
+
+  bpmem.dstalpha.hex = 0;
+  bpmem.blendmode.hex = 0;
+  bpmem.blendmode.blendenable = 1;
+  bpmem.blendmode.colorupdate = 1;
+  bpmem.blendmode.alphaupdate = 1;
+
+  for (auto format : {PEControl::RGB8_Z24, PEControl::RGBA6_Z24})
+  {
+    bpmem.zcontrol.pixel_format = format;
+    for (u32 mode = 0; mode < 128; ++mode)
+    {
+      bpmem.blendmode.srcfactor = static_cast<BlendMode::BlendFactor>(mode & 7);
+      bpmem.blendmode.dstfactor = static_cast<BlendMode::BlendFactor>((mode >> 3) & 7);
+      bpmem.blendmode.subtract = mode >> 6;
+
+      for (int iteration = 0; iteration < 1000; ++iteration)
+      {
+        u8 src[4];
+        u8 dst[4];
+        for (int i = 0; i < 4; ++i)
+        {
+          // Mostly random, with the extremes mixed in.
+          const u32 kind = u8_dist(rng) & 7;
+          src[i] = kind == 0 ? 0 : kind == 1 ? 255 : u8_dist(rng);
+          dst[i] = kind == 2 ? 0 : kind == 3 ? 255 : u8_dist(rng);
+        }
+        CheckBlend(src, dst);
+      }
+    }
+  }
+}
+
+namespace
+{
+using Triangle = std::array<OutputVertexData, 3>;
+
+// Writes the rasterized color and depth straight to the EFB, with a depth test so that the order
+// the triangles are drawn in matters.
+void SetUpFlatShading()
+{
+  bpmem.genMode.hex = 0;
+  bpmem.genMode.numcolchans = 1;
+  bpmem.tevorders[0].hex = 0;
+  bpmem.tevksel[0].hex = 0;
+  bpmem.tevksel[0].swap1 = 0;
+  bpmem.tevksel[0].swap2 = 1;
+  bpmem.tevksel[1].hex = 0;
+  bpmem.tevksel[1].swap1 = 2;
+  bpmem.tevksel[1].swap2 = 3;
+
+  TevStageCombiner::ColorCombiner& cc = bpmem.combiners[0].colorC;
+  cc.hex = 0;
+  cc.a = cc.b = cc.c = TEVCOLORARG_ZERO;
+  cc.d = TEVCOLORARG_RASC;
+  cc.clamp = 1;
+  TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[0].alphaC;
+  ac.hex = 0;
+  ac.a = ac.b = ac.c = TEVALPHAARG_ZERO;
+  ac.d = TEVALPHAARG_RASA;
+  ac.clamp = 1;
+
+  bpmem.alpha_test.hex = 0;
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+  bpmem.ztex2.hex = 0;
+  bpmem.fog.c_proj_fsel.hex = 0;
+  bpmem.zmode.hex = 0;
+  bpmem.zmode.testenable = 1;
+  bpmem.zmode.func = ZMode::LEQUAL;
+  bpmem.zmode.updateenable = 1;
+  bpmem.zcontrol.early_ztest = 0;
+  bpmem.dstalpha.hex = 0;
+  bpmem.blendmode.hex = 0;
+  bpmem.blendmode.colorupdate = 1;
+  bpmem.blendmode.alphaupdate = 1;
+
+  // Scissor to the whole EFB.
+  bpmem.scissorOffset.hex = 0;
+  bpmem.scissorTL.hex = 0;
+  bpmem.scissorBR.hex = 0;
+  bpmem.scissorBR.x = EFB_WIDTH - 1;
+  bpmem.scissorBR.y = EFB_HEIGHT - 1;
+}
+
+std::vector<Triangle> RandomTriangles(std::mt19937& rng, size_t count)
+{
+  std::uniform_real_distribution<float> x_dist(-16.0f, EFB_WIDTH + 16.0f);
+  std::uniform_real_distribution<float> y_dist(-16.0f, EFB_HEIGHT + 16.0f);
+  std::uniform_real_distribution<float> z_dist(0.0f, 16777215.0f);
+  std::uniform_int_distribution<u32> u8_dist(0, 255);
+
+  std::vector<Triangle> triangles(count);
+  for (Triangle& triangle : triangles)
+  {
+    for (OutputVertexData& vertex : triangle)
+    {
+      vertex.screenPosition = Vec3(x_dist(rng), y_dist(rng), z_dist(rng));
+      vertex.projectedPosition.w = 1.0f;
+      for (u8& component : vertex.color[0])
+        component = static_cast<u8>(u8_dist(rng));
+    }
+  }
+  return triangles;
+}
+
+// Returns the color and depth of every pixel.
+std::vector<u32> Render(const std::vector<Triangle>& triangles, u32 num_threads)
+{
+  u8 clear_color[4] = {0x12, 0x34, 0x56, 0x78};
+  for (u16 y = 0; y < EFB_HEIGHT; ++y)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; ++x)
+    {
+      EfbInterface::SetColor(x, y, clear_color);
+      EfbInterface::SetDepth(x, y, 0xffffff);
+    }
+  }
+
+  Rasterizer::Init(num_threads);
+  for (const Triangle& triangle : triangles)
+    Rasterizer::DrawTriangleFrontFace(&triangle[0], &triangle[1], &triangle[2]);
+  Rasterizer::Flush();
+  Rasterizer::Shutdown();
+
+  std::vector<u32> pixels;
+  pixels.reserve(EFB_WIDTH * EFB_HEIGHT * 2);
+  for (u16 y = 0; y < EFB_HEIGHT; ++y)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; ++x)
+    {
+      pixels.push_back(EfbInterface::GetColor(x, y));
+      pixels.push_back(EfbInterface::GetDepth(x, y));
+    }
+  }
+  return pixels;
+}
+}
+
+// Binning triangles into tiles that are rasterized on several threads must give the same EFB as
+// drawing every triangle right away, including along the tile seams.
+TEST(Rasterizer, TilesMatchImmediate)
+{
+  std::mt19937 rng(0x54494c45);
+  const std::vector<Triangle> triangles = RandomTriangles(rng, 300);
+  SetUpFlatShading();
+
+  for (auto format : {PEControl::RGB8_Z24, PEControl::RGBA6_Z24})
+  {
+    bpmem.zcontrol.pixel_format = format;
+    const std::vector<u32> expected = Render(triangles, 1);
+    const std::vector<u32> actual = Render(triangles, 4);
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      ASSERT_EQ(expected[i], actual[i])
+          << "pixel format " << static_cast<int>(format) << " x " << (i / 2) % EFB_WIDTH << " y "
+          << (i / 2) / EFB_WIDTH << (i % 2 ? " depth" : " color");
+    }
+  }
+}
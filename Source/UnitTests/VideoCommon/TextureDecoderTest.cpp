@@ -0,0 +1,154 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+const int s_formats[] = {GX_TF_I4,     GX_TF_I8,    GX_TF_IA4, GX_TF_IA8,
+                         GX_TF_RGB565, GX_TF_RGB5A3, GX_TF_RGBA8, GX_TF_C4,
+                         GX_TF_C8,     GX_TF_C14X2,  GX_TF_CMPR};
+
+const TlutFormat s_tlut_formats[] = {GX_TL_IA8, GX_TL_RGB565, GX_TL_RGB5A3};
+
+// Large enough for the 16K entries of C14X2.
+const size_t TLUT_SIZE = 0x8000;
+
+bool IsPaletted(int format)
+{
+  return format == GX_TF_C4 || format == GX_TF_C8 || format == GX_TF_C14X2;
+}
+
+std::vector<u8> RandomBytes(size_t size, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+    byte = static_cast<u8>(dist(rng));
+  return data;
+}
+
+// Temporarily hides CPU features, so that the fallback decoders get tested as well.
+class ScopedCPUFeatures
+{
+public:
+  ScopedCPUFeatures(bool avx2, bool sse4_1, bool ssse3) : m_saved(cpu_info)
+  {
+    cpu_info.bAVX2 &= avx2;
+    cpu_info.bSSE4_1 &= sse4_1;
+    cpu_info.bSSSE3 &= ssse3;
+  }
+  ~ScopedCPUFeatures() { cpu_info = m_saved; }
+private:
+  CPUInfo m_saved;
+};
+
+void CheckAgainstGeneric(int format, int width, int height, TlutFormat tlutfmt, std::mt19937& rng)
+{
+  const std::vector<u8> src =
+      RandomBytes(TexDecoder_GetTextureSizeInBytes(width, height, format), rng);
+  const std::vector<u8> tlut = RandomBytes(TLUT_SIZE, rng);
+
+  std::vector<u32> expected(width * height, 0xDEADBEEF);
+  std::vector<u32> actual(width * height, 0xDEADBEEF);
+  _TexDecoder_DecodeImplGeneric(expected.data(), src.data(), width, height, format, tlut.data(),
+                                tlutfmt);
+  _TexDecoder_DecodeImpl(actual.data(), src.data(), width, height, format, tlut.data(), tlutfmt);
+
+  for (int i = 0; i < width * height; ++i)
+  {
+    ASSERT_EQ(expected[i], actual[i]) << "format " << format << ", tlut format " << tlutfmt
+                                      << ", " << width << "x" << height << ", texel " << i;
+  }
+}
+
+void CheckAllFormats()
+{
+  std::mt19937 rng(1234);
+  for (int format : s_formats)
+  {
+    const int block_width = TexDecoder_GetBlockWidthInTexels(format);
+    const int block_height = TexDecoder_GetBlockHeightInTexels(format);
+    // An odd number of blocks covers the decoders which handle two blocks at a time.
+    const int sizes[][2] = {{1, 1}, {2, 1}, {3, 5}, {16, 4}, {33, 9}};
+
+    for (const auto& size : sizes)
+    {
+      const int width = size[0] * block_width;
+      const int height = size[1] * block_height;
+      if (IsPaletted(format))
+      {
+        for (TlutFormat tlutfmt : s_tlut_formats)
+          CheckAgainstGeneric(format, width, height, tlutfmt, rng);
+      }
+      else
+      {
+        CheckAgainstGeneric(format, width, height, GX_TL_IA8, rng);
+      }
+    }
+  }
+}
+}
+
+TEST(TextureDecoder, MatchesGenericDecoder)
+{
+  CheckAllFormats();
+}
+
+TEST(TextureDecoder, MatchesGenericDecoderWithoutAVX2)
+{
+  ScopedCPUFeatures features(false, true, true);
+  CheckAllFormats();
+}
+
+TEST(TextureDecoder, MatchesGenericDecoderWithoutSSSE3)
+{
+  ScopedCPUFeatures features(false, false, false);
+  CheckAllFormats();
+}
+
+// Throughput per format, not a test. Run it with --gtest_also_run_disabled_tests.
+TEST(TextureDecoder, DISABLED_Benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const int width = 1024;
+  const int height = 1024;
+  const int iterations = 20;
+
+  std::mt19937 rng(1234);
+  const std::vector<u8> tlut = RandomBytes(TLUT_SIZE, rng);
+  std::vector<u32> dst(width * height);
+
+  for (int format : s_formats)
+  {
+    const std::vector<u8> src =
+        RandomBytes(TexDecoder_GetTextureSizeInBytes(width, height, format), rng);
+    const TlutFormat tlutfmt = GX_TL_RGB5A3;
+
+    const auto measure = [&](void (*decode)(u32*, const u8*, int, int, int, const u8*,
+                                            TlutFormat)) {
+      const Clock::time_point start = Clock::now();
+      for (int i = 0; i < iterations; ++i)
+        decode(dst.data(), src.data(), width, height, format, tlut.data(), tlutfmt);
+      const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      return static_cast<double>(width) * height * iterations / seconds / 1e6;
+    };
+
+    const double generic = measure(_TexDecoder_DecodeImplGeneric);
+    const double optimized = measure(_TexDecoder_DecodeImpl);
+    std::printf("[ BENCH    ] format 0x%x: generic %.1f Mtexels/s, optimized %.1f Mtexels/s\n",
+                format, generic, optimized);
+  }
+}